@@ -0,0 +1,290 @@
+// ======================================================================
+/*!
+ * \brief Regression tests for AggregationCache
+ */
+// ======================================================================
+
+#include "AggregationCache.h"
+#include "RequestArena.h"
+#include "TestTimes.h"
+#include "TimeSeriesInclude.h"
+#include <regression/tframe.h>
+#include <sstream>
+
+// Protection against namespace tests
+namespace AggregationCacheTest
+{
+using TestTimes::make_time;
+
+TS::TimeSeries make_timeseries(int offset)
+{
+  TS::TimeSeries ts;
+  for (int hour = 0; hour < 24; hour++)
+    ts.emplace_back(make_time(hour), 0.5 * (hour + offset));
+  return ts;
+}
+
+TS::DataFunctions make_functions(TS::FunctionId id)
+{
+  TS::DataFunction inner(id, TS::FunctionType::TimeFunction);
+  inner.setAggregationIntervalBehind(120);
+  inner.setAggregationIntervalAhead(0);
+  return TS::DataFunctions(inner, TS::DataFunction());
+}
+
+TS::TimeSeriesGenerator::LocalTimeList make_timesteps(int step)
+{
+  TS::TimeSeriesGenerator::LocalTimeList timesteps;
+  for (int hour = 0; hour < 24; hour += step)
+    timesteps.push_back(make_time(hour));
+  return timesteps;
+}
+
+std::string tostr(const TS::TimeSeries& ts)
+{
+  std::ostringstream out;
+  out << ts;
+  return out.str();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Equal requests share the cached result
+ */
+// ----------------------------------------------------------------------
+
+void hits_and_misses()
+{
+  TS::AggregationCache cache(1024 * 1024);
+
+  const auto ts = make_timeseries(0);
+  const auto mean = make_functions(TS::FunctionId::Mean);
+  const auto max = make_functions(TS::FunctionId::Maximum);
+  const auto timesteps = make_timesteps(3);
+  const auto timeline = TS::AggregationCache::timeline_key(timesteps);
+  const std::string series = "observations/100971/t2m";
+
+  auto result1 = cache.aggregate(ts, series, 1, mean, timesteps, timeline);
+  auto result2 = cache.aggregate(ts, series, 1, mean, timesteps, timeline);
+  if (result1 != result2)
+    TEST_FAILED("Equal requests must share the cached result");
+
+  const auto expected = TS::Aggregator::aggregate(ts, mean, timesteps);
+  if (tostr(*result1) != tostr(*expected))
+    TEST_FAILED("Expected\n" + tostr(*expected) + "got\n" + tostr(*result1));
+
+  // Different functions, timelines, versions or series must not match
+  auto result3 = cache.aggregate(ts, series, 1, max, timesteps, timeline);
+  const auto timesteps6 = make_timesteps(6);
+  auto result4 = cache.aggregate(
+      ts, series, 1, mean, timesteps6, TS::AggregationCache::timeline_key(timesteps6));
+  const auto ts2 = make_timeseries(1);
+  auto result5 = cache.aggregate(ts2, series, 2, mean, timesteps, timeline);
+  auto result6 = cache.aggregate(ts2, "observations/101004/t2m", 1, mean, timesteps, timeline);
+  if (result3 == result1 || result4 == result1 || result5 == result1 || result6 == result1)
+    TEST_FAILED("Different requests must not share results");
+
+  const auto expected2 = tostr(*TS::Aggregator::aggregate(ts2, mean, timesteps));
+  if (tostr(*result5) != expected2 || tostr(*result6) != expected2)
+    TEST_FAILED("Incorrect result for a modified input");
+
+  const auto stats = cache.statistics();
+  if (stats.hits != 1 || stats.misses != 5 || stats.inserts != 5 || stats.size != 5)
+    TEST_FAILED("Incorrect statistics: hits=" + std::to_string(stats.hits) +
+                " misses=" + std::to_string(stats.misses) +
+                " size=" + std::to_string(stats.size));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Inputs without a series identity are fingerprinted
+ */
+// ----------------------------------------------------------------------
+
+void fingerprints()
+{
+  TS::AggregationCache cache(1024 * 1024);
+
+  const auto mean = make_functions(TS::FunctionId::Mean);
+  const auto timesteps = make_timesteps(3);
+  const auto timeline = TS::AggregationCache::timeline_key(timesteps);
+  const auto ts = make_timeseries(0);
+  const auto ts2 = make_timeseries(1);
+
+  // The version is ignored, equal data matches and modified data does not
+  auto result1 = cache.aggregate(ts, "", 1, mean, timesteps, timeline);
+  auto result2 = cache.aggregate(make_timeseries(0), "", 2, mean, timesteps, timeline);
+  auto result3 = cache.aggregate(ts2, "", 1, mean, timesteps, timeline);
+  if (result1 != result2)
+    TEST_FAILED("Equal inputs must share the cached result");
+  if (result3 == result1)
+    TEST_FAILED("Different inputs must not share results");
+  if (tostr(*result3) != tostr(*TS::Aggregator::aggregate(ts2, mean, timesteps)))
+    TEST_FAILED("Incorrect result for a modified input");
+
+  const auto key =
+      TS::AggregationCache::makeKey("", TS::AggregationCache::fingerprint(ts), mean, timeline);
+  if (cache.find(key) != result1)
+    TEST_FAILED("The result should be keyed by the fingerprint");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief All members of the functions contribute to the keys
+ */
+// ----------------------------------------------------------------------
+
+void function_keys()
+{
+  const auto mean = make_functions(TS::FunctionId::Mean);
+  auto copy = mean;
+  if (copy != mean || copy.hash_value() != mean.hash_value())
+    TEST_FAILED("Equal functions must have equal hashes");
+
+  std::vector<TS::DataFunctions> modified(6, mean);
+  modified[0].innerFunction.setId(TS::FunctionId::Maximum);
+  modified[1].innerFunction.setLimits(0, 10);
+  modified[2].innerFunction.setAggregationIntervalAhead(60);
+  modified[3].innerFunction.setIsDirFunction(true);
+  modified[4].innerFunction.setIsNaNFunction(true);
+  modified[5].outerFunction =
+      TS::DataFunction(TS::FunctionId::Mean, TS::FunctionType::AreaFunction);
+
+  for (std::size_t i = 0; i < modified.size(); i++)
+  {
+    if (modified[i] == mean || modified[i].hash_value() == mean.hash_value())
+      TEST_FAILED("Modification " + std::to_string(i) + " must change the function key");
+  }
+
+  // The string hash ignores the flags, the keys must not
+  if (modified[3].innerFunction.hash() != mean.innerFunction.hash())
+    TEST_FAILED("The string hash was not expected to change");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief The least recently used results are evicted first
+ */
+// ----------------------------------------------------------------------
+
+void eviction()
+{
+  const auto mean = make_functions(TS::FunctionId::Mean);
+  const auto timesteps = make_timesteps(1);
+  const auto timeline = TS::AggregationCache::timeline_key(timesteps);
+
+  // Room for two results
+  TS::AggregationCache probe(1024 * 1024);
+  probe.aggregate(make_timeseries(0), "s", 0, mean, timesteps, timeline);
+  const auto bytes = probe.statistics().bytes;
+
+  TS::AggregationCache cache(2 * bytes + bytes / 2);
+  for (std::size_t version = 1; version <= 2; version++)
+    cache.aggregate(make_timeseries(version), "s", version, mean, timesteps, timeline);
+
+  // Use the first result so that the second one is evicted
+  if (!cache.find(TS::AggregationCache::makeKey("s", 1, mean, timeline)))
+    TEST_FAILED("The first result should be cached");
+  cache.aggregate(make_timeseries(3), "s", 3, mean, timesteps, timeline);
+
+  if (!cache.find(TS::AggregationCache::makeKey("s", 1, mean, timeline)) ||
+      cache.find(TS::AggregationCache::makeKey("s", 2, mean, timeline)) ||
+      !cache.find(TS::AggregationCache::makeKey("s", 3, mean, timeline)))
+    TEST_FAILED("The least recently used result should have been evicted");
+
+  const auto stats = cache.statistics();
+  if (stats.evictions != 1 || stats.size != 2 || stats.bytes > stats.maxbytes)
+    TEST_FAILED("Incorrect statistics: evictions=" + std::to_string(stats.evictions) +
+                " bytes=" + std::to_string(stats.bytes));
+
+  // Results larger than the cache are not stored
+  TS::AggregationCache tiny(bytes / 2);
+  tiny.aggregate(make_timeseries(0), "s", 0, mean, timesteps, timeline);
+  if (tiny.statistics().size != 0)
+    TEST_FAILED("Too large results must not be cached");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Cached results outlive the request arena and groups are cached too
+ */
+// ----------------------------------------------------------------------
+
+void arena_and_groups()
+{
+  TS::AggregationCache cache(1024 * 1024);
+  const auto mean = make_functions(TS::FunctionId::Mean);
+  const auto timesteps = make_timesteps(3);
+  const auto timeline = TS::AggregationCache::timeline_key(timesteps);
+
+  TS::TimeSeriesSnapshot result;
+  TS::TimeSeriesGroupSnapshot group_result;
+  {
+    // Arena results are copied to the heap before they are cached
+    TS::RequestArena arena;
+    TS::pmr::TimeSeries ts(make_timeseries(0), &arena);
+    result = TS::make_snapshot(TS::to_heap(*TS::Aggregator::aggregate(ts, mean, timesteps)));
+    cache.insert(TS::AggregationCache::makeKey("s", 1, mean, timeline), result);
+
+    TS::TimeSeriesGroup group;
+    group.emplace_back(TS::LonLat(25, 60), make_timeseries(0));
+    group.emplace_back(TS::LonLat(26, 61), make_timeseries(1));
+    group_result = cache.aggregate(group, "", 0, mean, timesteps, timeline);
+  }
+
+  const auto expected = TS::Aggregator::aggregate(make_timeseries(0), mean, timesteps);
+  if (tostr(*result) != tostr(*expected))
+    TEST_FAILED("Expected\n" + tostr(*expected) + "got\n" + tostr(*result));
+
+  if (group_result->size() != 2 || tostr((*group_result)[0].timeseries) != tostr(*expected))
+    TEST_FAILED("Incorrect group result");
+
+  if (cache.find(TS::AggregationCache::makeKey("s", 1, mean, timeline)) != result)
+    TEST_FAILED("Expected a cached result");
+
+  cache.clear();
+  if (cache.statistics().size != 0 || cache.statistics().bytes != 0)
+    TEST_FAILED("Cache should be empty");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test()
+  {
+    TEST(hits_and_misses);
+    TEST(fingerprints);
+    TEST(function_keys);
+    TEST(eviction);
+    TEST(arena_and_groups);
+  }
+};
+
+}  // namespace AggregationCacheTest
+
+//! The main program
+int main()
+{
+  using namespace std;
+  cout << endl << "AggregationCache tester" << endl << "=======================" << endl;
+  AggregationCacheTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
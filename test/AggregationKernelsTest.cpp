@@ -0,0 +1,377 @@
+// ======================================================================
+/*!
+ * \brief Regression tests for the aggregation kernels
+ */
+// ======================================================================
+
+#include "AggregationKernels.h"
+#include <macgyver/DateTime.h>
+#include <newbase/NFmiGlobals.h>
+#include <regression/tframe.h>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+
+using namespace SmartMet::TimeSeries;
+
+// Protection against namespace tests
+namespace AggregationKernelsTest
+{
+const double missing = kFloatMissing;
+
+const std::vector<FunctionId> functions{FunctionId::Mean,
+                                        FunctionId::Amean,
+                                        FunctionId::CircleMean,
+                                        FunctionId::Maximum,
+                                        FunctionId::Minimum,
+                                        FunctionId::Median,
+                                        FunctionId::Sum,
+                                        FunctionId::Integ,
+                                        FunctionId::StandardDeviation,
+                                        FunctionId::Percentage,
+                                        FunctionId::Count,
+                                        FunctionId::Change,
+                                        FunctionId::Trend};
+
+// Irregular timesteps, odd seconds and directions crossing north
+Stat::DataVector make_data(std::size_t n, unsigned int seed)
+{
+  Stat::DataVector data;
+  Fmi::DateTime t(Fmi::Date(2024, 1, 1));
+  for (std::size_t i = 0; i < n; i++)
+  {
+    seed = seed * 1103515245U + 12345U;
+    const double value = (seed >> 8) % 36000 / 100.0;
+    data.emplace_back(t, value);
+    t += Fmi::Seconds(600 + 37 * ((seed >> 4) % 7));
+  }
+  return data;
+}
+
+// The reference implementation used by the aggregator for functions without kernels
+double reference(const Stat::DataVector& data, const DataFunction& func, bool useWeights)
+{
+  Stat::Stat stat(data, missing);
+  stat.useWeights(useWeights);
+  stat.useDegrees(func.isDirFunction());
+
+  switch (func.id())
+  {
+    case FunctionId::Mean:
+      return stat.mean();
+    case FunctionId::Amean:
+      stat.useWeights(false);
+      return stat.mean();
+    case FunctionId::CircleMean:
+      return stat.circlemean();
+    case FunctionId::Maximum:
+      return stat.max();
+    case FunctionId::Minimum:
+      return stat.min();
+    case FunctionId::Median:
+      return stat.median();
+    case FunctionId::Sum:
+      stat.useWeights(false);
+      return stat.sum();
+    case FunctionId::Integ:
+      return stat.integ();
+    case FunctionId::StandardDeviation:
+      return stat.stddev();
+    case FunctionId::Percentage:
+      return stat.percentage(func.lowerLimit(), func.upperLimit());
+    case FunctionId::Count:
+      return stat.count(func.lowerLimit(), func.upperLimit());
+    case FunctionId::Change:
+      return stat.change();
+    case FunctionId::Trend:
+      return stat.trend();
+    default:
+      return missing;
+  }
+}
+
+std::string describe(const DataFunction& func, bool useWeights, std::size_t n)
+{
+  std::ostringstream out;
+  out << func.hash() << (useWeights ? " weighted" : " unweighted")
+      << (func.isDirFunction() ? " degrees" : "") << " n=" << n;
+  return out.str();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Kernels produce the same results as Stat
+ */
+// ----------------------------------------------------------------------
+
+void same_as_reference()
+{
+  std::size_t kernels = 0;
+  for (const auto id : functions)
+    for (const bool degrees : {false, true})
+      for (const bool useWeights : {false, true})
+      {
+        DataFunction func(id, FunctionType::TimeFunction);
+        if (id == FunctionId::Percentage || id == FunctionId::Count)
+          func.setLimits(90, 270);
+        func.setIsDirFunction(degrees);
+
+        const auto kernel = Aggregator::select_kernel(func, useWeights);
+        if (kernel == nullptr)
+          continue;
+        ++kernels;
+
+        for (std::size_t n : {1, 2, 3, 10, 97})
+        {
+          const auto data = make_data(n, n + 7);
+          double result = -1;
+          if (!kernel(data, func, missing, result))
+            TEST_FAILED("Kernel rejected ordered data: " + describe(func, useWeights, n));
+
+          // Circular means use their own sines and cosines
+          const double expected = reference(data, func, useWeights);
+          const double tolerance = (id == FunctionId::CircleMean ? 1e-9 : 0.0);
+          if (std::abs(result - expected) > tolerance)
+            TEST_FAILED("Expected " + std::to_string(expected) + ", got " +
+                        std::to_string(result) + ": " + describe(func, useWeights, n));
+        }
+      }
+
+  // Median and the plain standard deviation use the reference implementation
+  if (kernels != 44)
+    TEST_FAILED("Expected 44 kernels, got " + std::to_string(kernels));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Data the kernels cannot reproduce is left to the reference implementation
+ */
+// ----------------------------------------------------------------------
+
+void fallback()
+{
+  DataFunction mean(FunctionId::Mean, FunctionType::TimeFunction);
+  DataFunction change(FunctionId::Change, FunctionType::TimeFunction);
+  double result = 0;
+
+  // Unordered times change the weights and the order of the values
+  auto data = make_data(10, 1);
+  std::swap(data[2], data[5]);
+  if (Aggregator::select_kernel(mean, true)(data, mean, missing, result))
+    TEST_FAILED("Weighted kernels must reject unordered data");
+  if (Aggregator::select_kernel(change, false)(data, change, missing, result))
+    TEST_FAILED("Order dependent kernels must reject unordered data");
+  if (!Aggregator::select_kernel(mean, false)(data, mean, missing, result) ||
+      result != reference(data, mean, false))
+    TEST_FAILED("Unweighted means must accept unordered data");
+
+  // Missing values make the result missing
+  data = make_data(10, 3);
+  data[4].value = missing;
+  if (!Aggregator::select_kernel(mean, true)(data, mean, missing, result) || result != missing)
+    TEST_FAILED("Missing values must produce a missing result");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Sums over equal times are accumulated in the order of Stat
+ *
+ * Stat sorts the data with std::sort, which is not stable and may
+ * reorder equal times in longer windows.
+ */
+// ----------------------------------------------------------------------
+
+void equal_times()
+{
+  for (const auto id : {FunctionId::Mean, FunctionId::Amean, FunctionId::Sum})
+  {
+    const DataFunction func(id, FunctionType::TimeFunction);
+    const auto kernel = Aggregator::select_kernel(func, false);
+
+    for (std::size_t n : {10, 17, 33, 97, 1000})
+    {
+      // Equal times as in area aggregation, and partially equal times
+      auto area = make_data(n, n + 3);
+      auto blocks = area;
+      for (std::size_t i = 0; i < n; i++)
+      {
+        area[i].time = area[0].time;
+        blocks[i].time = blocks[i / 4 * 4].time;
+      }
+      std::reverse(blocks.begin(), blocks.end());
+
+      for (const auto& data : {area, blocks})
+      {
+        double result = -1;
+        if (!kernel(data, func, missing, result))
+          TEST_FAILED("Unweighted kernels must accept equal times: " +
+                      describe(func, false, n));
+
+        const double expected = reference(data, func, false);
+        if (result != expected)
+          TEST_FAILED("Expected " + std::to_string(expected) + ", got " +
+                      std::to_string(result) + ": " + describe(func, false, n));
+      }
+    }
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Float32 kernels agree with the double precision path
+ */
+// ----------------------------------------------------------------------
+
+void float_kernels()
+{
+  const std::vector<FunctionId> float_functions{FunctionId::Mean,
+                                                FunctionId::Amean,
+                                                FunctionId::CircleMean,
+                                                FunctionId::Maximum,
+                                                FunctionId::Minimum,
+                                                FunctionId::Sum,
+                                                FunctionId::Count};
+
+  for (const auto id : float_functions)
+    for (const bool degrees : {false, true})
+    {
+      DataFunction func(id, FunctionType::AreaFunction);
+      if (id == FunctionId::Count)
+        func.setLimits(90, 270);
+      func.setIsDirFunction(degrees);
+
+      const auto kernel = Aggregator::select_float_kernel(func);
+      if (kernel == nullptr)
+      {
+        if (degrees && (id == FunctionId::Mean || id == FunctionId::Amean))
+          continue;
+        TEST_FAILED("Missing float kernel: " + describe(func, false, 0));
+      }
+
+      for (std::size_t n : {1, 7, 8, 9, 100, 1001})
+      {
+        // Area data has no times, values are exactly representable as floats
+        std::vector<float> values;
+        Stat::DataVector data;
+        for (const auto& item : make_data(n, n + 3))
+        {
+          values.push_back(static_cast<float>(item.value));
+          data.emplace_back(Fmi::DateTime::NOT_A_DATE_TIME, values.back());
+        }
+
+        const double result = kernel(values.data(), n, func, missing);
+        const double expected = reference(data, func, false);
+        if (std::abs(result - expected) > 1e-9 * std::max(1.0, std::abs(expected)))
+          TEST_FAILED("Expected " + std::to_string(expected) + ", got " +
+                      std::to_string(result) + ": " + describe(func, false, n));
+
+        values[n / 2] = kFloatMissing;
+        if (kernel(values.data(), n, func, missing) != missing)
+          TEST_FAILED("Missing values must produce a missing result: " +
+                      describe(func, false, n));
+      }
+    }
+
+  if (Aggregator::select_float_kernel(DataFunction(FunctionId::Median,
+                                                   FunctionType::AreaFunction)) != nullptr)
+    TEST_FAILED("Median has no float kernel");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Batched circular means agree with Stat::circlemean
+ */
+// ----------------------------------------------------------------------
+
+void circular_statistics()
+{
+  for (std::size_t n : {1, 2, 7, 8, 9, 100, 1001})
+  {
+    // Negative and large angles exactly representable as floats, north in the middle
+    std::vector<double> directions;
+    std::vector<float> float_directions;
+    std::vector<double> weights;
+    Stat::DataVector data;
+    unsigned int seed = n;
+    for (std::size_t i = 0; i < n; i++)
+    {
+      seed = seed * 1103515245U + 12345U;
+      const double direction = (seed >> 8) % 360 / 4.0 - 45 + 360.0 * (i % 5) - 720;
+      directions.push_back(direction);
+      float_directions.push_back(static_cast<float>(direction));
+      weights.push_back(1 + (seed >> 4) % 5);
+      data.emplace_back(Fmi::DateTime::NOT_A_DATE_TIME, direction);
+    }
+
+    const double expected = Stat::Stat(data, missing).circlemean();
+    const double result1 = Aggregator::circular_mean(directions.data(), n, missing);
+    const double result2 = Aggregator::circular_mean(float_directions.data(), n, missing);
+    if (std::abs(result1 - expected) > 1e-9 || std::abs(result2 - expected) > 1e-9)
+      TEST_FAILED("Expected " + std::to_string(expected) + ", got " + std::to_string(result1) +
+                  " and " + std::to_string(result2) + " for n=" + std::to_string(n));
+
+    // Integer weights are equivalent to repeated directions
+    Stat::DataVector repeated;
+    for (std::size_t i = 0; i < n; i++)
+      for (int j = 0; j < weights[i]; j++)
+        repeated.push_back(data[i]);
+    const double weighted_expected = Stat::Stat(repeated, missing).circlemean();
+    const double weighted =
+        Aggregator::circular_mean(directions.data(), weights.data(), n, missing);
+    if (std::abs(weighted - weighted_expected) > 1e-9)
+      TEST_FAILED("Expected weighted mean " + std::to_string(weighted_expected) + ", got " +
+                  std::to_string(weighted) + " for n=" + std::to_string(n));
+
+    directions[n / 2] = missing;
+    if (Aggregator::circular_mean(directions.data(), n, missing) != missing)
+      TEST_FAILED("Missing directions must produce a missing result");
+  }
+
+  // Opposite directions have no mean
+  const std::vector<double> opposite{0, 180, 90, 270};
+  if (Aggregator::circular_mean(opposite.data(), opposite.size(), missing) != missing)
+    TEST_FAILED("Opposite directions must produce a missing result");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test()
+  {
+    TEST(same_as_reference);
+    TEST(fallback);
+    TEST(equal_times);
+    TEST(float_kernels);
+    TEST(circular_statistics);
+  }
+};
+
+}  // namespace AggregationKernelsTest
+
+//! The main program
+int main()
+{
+  using namespace std;
+  cout << endl << "AggregationKernels tester" << endl << "=========================" << endl;
+  AggregationKernelsTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,183 @@
+// ======================================================================
+/*!
+ * \brief Measure aggregation throughput per function
+ *
+ * Usage: AggregatorBenchmark [hours] [points]
+ */
+// ======================================================================
+
+#include "AggregationKernels.h"
+#include "TimeSeriesAggregator.h"
+#include "TimeSeriesOutput.h"
+#include <newbase/NFmiGlobals.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace TS = SmartMet::TimeSeries;
+
+namespace
+{
+TS::TimeSeries make_timeseries(std::size_t hours)
+{
+  TS::TimeSeries ts;
+  ts.reserve(hours * 6);
+  const Fmi::DateTime start(Fmi::Date(2024, 1, 1));
+  for (std::size_t i = 0; i < hours * 6; i++)
+    ts.emplace_back(Fmi::LocalDateTime(start + Fmi::Minutes(10 * i), Fmi::TimeZonePtr::utc),
+                    static_cast<double>((i * 37) % 360));
+  return ts;
+}
+
+void run(const std::string& name,
+         TS::FunctionId id,
+         bool degrees,
+         const TS::TimeSeries& ts,
+         const TS::TimeSeriesGenerator::LocalTimeList& timesteps)
+{
+  TS::DataFunction inner(id, TS::FunctionType::TimeFunction);
+  inner.setAggregationIntervalBehind(180);
+  inner.setAggregationIntervalAhead(0);
+  inner.setIsDirFunction(degrees);
+  const TS::DataFunctions funcs(inner, TS::DataFunction());
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto result = TS::Aggregator::aggregate(ts, funcs, timesteps);
+  const auto end = std::chrono::steady_clock::now();
+  const double seconds = std::chrono::duration<double>(end - start).count();
+  std::cout << std::left << std::setw(20) << name << std::right << std::fixed
+            << std::setprecision(3) << std::setw(8) << seconds << " s" << std::setw(10)
+            << std::setprecision(1) << (timesteps.size() / seconds / 1e3) << " kwindows/s"
+            << "  (" << result->size() << " values)" << std::endl;
+}
+
+// Area statistics of one timestep using double and float32 columns
+void run_column(const std::string& name, TS::FunctionId id, std::size_t npoints)
+{
+  const TS::DataFunction func(id, TS::FunctionType::AreaFunction);
+
+  TS::Stat::DataVector data;
+  std::vector<float> values;
+  data.reserve(npoints);
+  values.reserve(npoints);
+  for (std::size_t i = 0; i < npoints; i++)
+  {
+    values.push_back(static_cast<float>((i * 37) % 1000) / 10);
+    data.emplace_back(Fmi::DateTime::NOT_A_DATE_TIME, values.back());
+  }
+
+  const int repeats = 20;
+  double result1 = 0;
+  double result2 = 0;
+  const auto kernel = TS::Aggregator::select_kernel(func, false);
+  const auto float_kernel = TS::Aggregator::select_float_kernel(func);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeats; i++)
+    kernel(data, func, kFloatMissing, result1);
+  const auto middle = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeats; i++)
+    result2 = float_kernel(values.data(), values.size(), func, kFloatMissing);
+  const auto end = std::chrono::steady_clock::now();
+
+  const double seconds1 = std::chrono::duration<double>(middle - start).count();
+  const double seconds2 = std::chrono::duration<double>(end - middle).count();
+  std::cout << std::left << std::setw(20) << name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(10) << (repeats * npoints / seconds1 / 1e6)
+            << " Mvalues/s double" << std::setw(10) << (repeats * npoints / seconds2 / 1e6)
+            << " Mvalues/s float32  (" << std::setprecision(3) << result1 << " / " << result2
+            << ")" << std::endl;
+}
+
+// Area aggregation of hourly columns through the Aggregator, as double values of a group
+// of locations and as float32 columns
+void run_area(const std::string& name, TS::FunctionId id, std::size_t npoints, std::size_t hours)
+{
+  const TS::DataFunction func(id, TS::FunctionType::AreaFunction);
+  const TS::DataFunctions funcs(func, TS::DataFunction());
+  const Fmi::DateTime start(Fmi::Date(2024, 1, 1));
+
+  TS::Aggregator::FloatColumns columns;
+  std::vector<TS::TimeSeries> series(npoints);
+  TS::TimeSeriesGenerator::LocalTimeList timesteps;
+  for (std::size_t h = 0; h < hours; h++)
+  {
+    const Fmi::LocalDateTime t(start + Fmi::Hours(h), Fmi::TimeZonePtr::utc);
+    timesteps.push_back(t);
+    TS::Aggregator::FloatColumn column{t, {}};
+    column.values.reserve(npoints);
+    for (std::size_t i = 0; i < npoints; i++)
+    {
+      column.values.push_back(static_cast<float>((i * 37 + h) % 1000) / 10);
+      series[i].emplace_back(t, static_cast<double>(column.values.back()));
+    }
+    columns.push_back(std::move(column));
+  }
+
+  TS::TimeSeriesGroup group;
+  for (std::size_t i = 0; i < npoints; i++)
+    group.emplace_back(TS::LonLat(25 + i * 0.001, 60), std::move(series[i]));
+
+  const auto start1 = std::chrono::steady_clock::now();
+  const auto result1 = TS::Aggregator::aggregate(group, funcs, timesteps);
+  const auto middle = std::chrono::steady_clock::now();
+  const auto result2 = TS::Aggregator::area_aggregate(columns, func);
+  const auto end = std::chrono::steady_clock::now();
+
+  const double values = static_cast<double>(npoints) * hours;
+  const double seconds1 = std::chrono::duration<double>(middle - start1).count();
+  const double seconds2 = std::chrono::duration<double>(end - middle).count();
+  std::cout << std::left << std::setw(20) << name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(10) << (values / seconds1 / 1e6)
+            << " Mvalues/s group" << std::setw(10) << (values / seconds2 / 1e6)
+            << " Mvalues/s float32 columns  (" << std::setprecision(3)
+            << (*result1)[0].timeseries.back().value << " / " << result2->back().value << ")"
+            << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  const std::size_t hours = (argc > 1 ? std::atol(argv[1]) : 100000);
+  const std::size_t npoints = (argc > 2 ? std::atol(argv[2]) : 1000000);
+
+  std::cout << "Time aggregation of 10 minute data over 3 hours, " << hours << " hourly windows"
+            << std::endl;
+
+  const auto ts = make_timeseries(hours);
+  TS::TimeSeriesGenerator::LocalTimeList timesteps;
+  for (std::size_t i = 0; i < ts.size(); i += 6)
+    timesteps.push_back(ts[i].time);
+
+  run("mean", TS::FunctionId::Mean, false, ts, timesteps);
+  run("max", TS::FunctionId::Maximum, false, ts, timesteps);
+  run("sum", TS::FunctionId::Sum, false, ts, timesteps);
+  run("integ", TS::FunctionId::Integ, false, ts, timesteps);
+  run("circlemean", TS::FunctionId::CircleMean, false, ts, timesteps);
+  run("mean direction", TS::FunctionId::Mean, true, ts, timesteps);
+  run("stddev direction", TS::FunctionId::StandardDeviation, true, ts, timesteps);
+
+  std::cout << "Area statistics of " << npoints << " points" << std::endl;
+  run_column("mean", TS::FunctionId::Mean, npoints);
+  run_column("max", TS::FunctionId::Maximum, npoints);
+  run_column("sum", TS::FunctionId::Sum, npoints);
+  run_column("count", TS::FunctionId::Count, npoints);
+  run_column("circlemean", TS::FunctionId::CircleMean, npoints);
+
+  const std::size_t area_hours = 24;
+  const std::size_t area_points = std::max<std::size_t>(npoints / area_hours, 1);
+  std::cout << "Area aggregation of " << area_hours << " hourly columns of " << area_points
+            << " points" << std::endl;
+  run_area("mean", TS::FunctionId::Mean, area_points, area_hours);
+  run_area("max", TS::FunctionId::Maximum, area_points, area_hours);
+  run_area("sum", TS::FunctionId::Sum, area_points, area_hours);
+  run_area("median", TS::FunctionId::Median, area_points, area_hours);
+
+  return 0;
+}
+
+// ======================================================================
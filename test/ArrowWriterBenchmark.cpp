@@ -0,0 +1,116 @@
+// ======================================================================
+/*!
+ * \brief Compare the Arrow export with the CSV and JSON serializers
+ *
+ * Usage: ArrowWriterBenchmark [locations] [timesteps] [parameters]
+ */
+// ======================================================================
+
+#include "ArrowWriter.h"
+#include "OutputSerializer.h"
+#include "TimeSeriesInclude.h"
+#include <macgyver/ValueFormatter.h>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+TS::OutputData make_data(int nlocations, int ntimes, int nparams)
+{
+  Fmi::TimeZonePtr zone("UTC");
+  const Fmi::DateTime start(Fmi::Date(2024, 1, 1));
+
+  TS::OutputData data;
+  for (int loc = 0; loc < nlocations; loc++)
+  {
+    auto tsv = std::make_shared<TS::TimeSeriesVector>(nparams);
+    for (int param = 0; param < nparams; param++)
+    {
+      auto& ts = (*tsv)[param];
+      ts.reserve(ntimes);
+      for (int t = 0; t < ntimes; t++)
+      {
+        const Fmi::LocalDateTime ldt(start + Fmi::Minutes(10 * t), zone);
+        if (param == 0)
+          ts.push_back(TS::TimedValue(ldt, loc));
+        else if ((t + param) % 50 == 0)
+          ts.push_back(TS::TimedValue(ldt, TS::None()));
+        else
+          ts.push_back(TS::TimedValue(ldt, 0.1 * ((loc + t * param) % 400) - 20));
+      }
+    }
+    data.emplace_back("location" + std::to_string(loc), std::vector<TS::TimeSeriesData>{tsv});
+  }
+  return data;
+}
+
+template <typename F>
+void run(const std::string& name, std::size_t ncells, F&& f)
+{
+  const auto start = std::chrono::steady_clock::now();
+  const std::size_t bytes = f();
+  const auto end = std::chrono::steady_clock::now();
+  const double seconds = std::chrono::duration<double>(end - start).count();
+  std::cout << std::left << std::setw(12) << name << std::right << std::fixed
+            << std::setprecision(3) << std::setw(8) << seconds << " s" << std::setw(10)
+            << std::setprecision(1) << (ncells / seconds / 1e6) << " Mcells/s" << std::setw(10)
+            << (bytes / 1e6) << " MB" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  const int nlocations = (argc > 1 ? std::atoi(argv[1]) : 100);
+  const int ntimes = (argc > 2 ? std::atoi(argv[2]) : 5000);
+  const int nparams = (argc > 3 ? std::atoi(argv[3]) : 10);
+  const std::size_t ncells = std::size_t(nlocations) * ntimes * nparams;
+
+  std::cout << "Arrow export vs CSV and JSON, " << nlocations << " locations, " << ntimes
+            << " timesteps, " << nparams << " parameters" << std::endl;
+
+  const auto data = make_data(nlocations, ntimes, nparams);
+
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  const std::vector<int> precisions(nparams, 1);
+
+  run("csv",
+      ncells,
+      [&]()
+      {
+        std::size_t bytes = 0;
+        TS::ChunkedWriter writer([&bytes](const char* /* ptr */, std::size_t size)
+                                 { bytes += size; });
+        TS::write_csv(writer, data, {}, formatter, precisions, TS::NumberFormatting::ToChars);
+        return bytes;
+      });
+
+  run("json",
+      ncells,
+      [&]()
+      {
+        std::size_t bytes = 0;
+        TS::ChunkedWriter writer([&bytes](const char* /* ptr */, std::size_t size)
+                                 { bytes += size; });
+        TS::write_json(writer, data, {}, formatter, precisions, TS::NumberFormatting::ToChars);
+        return bytes;
+      });
+
+  run("arrow",
+      ncells,
+      [&]()
+      {
+        std::size_t bytes = 0;
+        TS::ChunkedWriter writer([&bytes](const char* /* ptr */, std::size_t size)
+                                 { bytes += size; });
+        TS::write_arrow_stream(writer, data);
+        return bytes;
+      });
+
+  return 0;
+}
+
+// ======================================================================
@@ -0,0 +1,237 @@
+// ======================================================================
+/*!
+ * \brief Regression tests for ArrowWriter
+ */
+// ======================================================================
+
+#include "ArrowWriter.h"
+#include "TestData.h"
+#include "TestTimes.h"
+#include "TimeSeriesInclude.h"
+#include <macgyver/StringConversion.h>
+#include <regression/tframe.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+// Protection against namespace tests
+namespace ArrowWriterTest
+{
+using TestTimes::make_time;
+
+template <typename T>
+T read(const std::string& buffer, std::size_t pos)
+{
+  if (pos + sizeof(T) > buffer.size())
+    throw std::runtime_error("Read past the end of the stream at " + Fmi::to_string(pos));
+  T value;
+  std::memcpy(&value, buffer.data() + pos, sizeof(T));
+  return value;
+}
+
+// Read a scalar field of a flatbuffer table, or the default if it is absent
+template <typename T>
+T read_field(const std::string& fb, std::size_t table, int id, T defaultvalue)
+{
+  const std::size_t vtable = table - read<std::int32_t>(fb, table);
+  const auto vtsize = read<std::uint16_t>(fb, vtable);
+  if (4 + 2 * id >= vtsize)
+    return defaultvalue;
+  const auto offset = read<std::uint16_t>(fb, vtable + 4 + 2 * id);
+  return (offset == 0 ? defaultvalue : read<T>(fb, table + offset));
+}
+
+struct Message
+{
+  std::uint8_t header_type;
+  std::int64_t body_length;
+  std::string body;
+};
+
+// Split the stream into messages
+std::vector<Message> read_messages(const std::string& stream)
+{
+  std::vector<Message> messages;
+  std::size_t pos = 0;
+  while (true)
+  {
+    if (read<std::uint32_t>(stream, pos) != 0xFFFFFFFF)
+      throw std::runtime_error("Missing continuation marker at " + Fmi::to_string(pos));
+    const auto size = read<std::int32_t>(stream, pos + 4);
+    pos += 8;
+    if (size == 0)
+      break;
+    if (size % 8 != 0)
+      throw std::runtime_error("Metadata is not padded to 8 bytes");
+
+    const std::string fb = stream.substr(pos, size);
+    const std::size_t root = read<std::uint32_t>(fb, 0);
+    Message message;
+    message.header_type = read_field<std::uint8_t>(fb, root, 1, 0);
+    message.body_length = read_field<std::int64_t>(fb, root, 3, 0);
+    pos += size;
+    message.body = stream.substr(pos, message.body_length);
+    pos += message.body_length;
+    messages.push_back(message);
+  }
+  if (pos != stream.size())
+    throw std::runtime_error("Extra data after the end-of-stream marker");
+  return messages;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief The stream consists of a schema, one batch per element and an end marker
+ */
+// ----------------------------------------------------------------------
+
+void arrow_stream()
+{
+  const auto data = TestData::make_output_data();
+  const auto stream = TS::arrow_stream(data, {"t2m"});
+
+  std::vector<Message> messages;
+  try
+  {
+    messages = read_messages(stream);
+  }
+  catch (const std::exception& e)
+  {
+    TEST_FAILED(e.what());
+  }
+
+  if (messages.size() != 3)
+    TEST_FAILED("Expected 3 messages, got " + Fmi::to_string(messages.size()));
+  if (messages[0].header_type != 1 || messages[1].header_type != 3 || messages[2].header_type != 3)
+    TEST_FAILED("Expected a schema followed by record batches");
+  if (messages[0].body_length != 0)
+    TEST_FAILED("Schema message should have no body");
+
+  // Buffers are 8-byte aligned, hence the double 1.25 and the int 42 are found at aligned
+  // positions in the first batch
+  bool found_double = false;
+  bool found_int = false;
+  const auto& body = messages[1].body;
+  if (body.size() % 8 != 0)
+    TEST_FAILED("Record batch body is not padded to 8 bytes");
+  for (std::size_t pos = 0; pos + 8 <= body.size(); pos += 8)
+  {
+    found_double |= (read<double>(body, pos) == 1.25);
+    found_int |= (read<std::int32_t>(body, pos) == 42);
+  }
+  if (!found_double || !found_int)
+    TEST_FAILED("Typed values not found in the record batch body");
+  if (body.find("abc") == std::string::npos || body.find("first") == std::string::npos)
+    TEST_FAILED("String values not found in the record batch body");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Writing to a file descriptor produces the same stream
+ */
+// ----------------------------------------------------------------------
+
+void arrow_stream_fd()
+{
+  const auto data = TestData::make_output_data();
+  const auto expected = TS::arrow_stream(data);
+
+  std::FILE* tmp = std::tmpfile();
+  if (tmp == nullptr)
+    TEST_FAILED("Failed to create a temporary file");
+
+  TS::write_arrow_stream(fileno(tmp), data);
+
+  std::string result(expected.size() + 1, '\0');
+  std::rewind(tmp);
+  result.resize(std::fread(&result[0], 1, result.size(), tmp));
+  std::fclose(tmp);
+
+  if (result != expected)
+    TEST_FAILED("File output differs from the memory buffer output");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Missing values in group cells are written as the missing text
+ */
+// ----------------------------------------------------------------------
+
+void group_cells()
+{
+  auto tsg = std::make_shared<TS::TimeSeriesGroup>();
+  TS::TimeSeries ts1;
+  ts1.emplace_back(TS::TimedValue(make_time(0), 1.5));
+  TS::TimeSeries ts2;
+  ts2.emplace_back(TS::TimedValue(make_time(0), TS::None()));
+  tsg->emplace_back(TS::LonLat(25, 60), ts1);
+  tsg->emplace_back(TS::LonLat(26, 61), ts2);
+
+  TS::OutputData data;
+  data.emplace_back("group", std::vector<TS::TimeSeriesData>{tsg});
+
+  if (TS::arrow_stream(data).find("[1.5 nan]") == std::string::npos)
+    TEST_FAILED("Expected the default missing text in the group cell");
+  if (TS::arrow_stream(data, {}, "-").find("[1.5 -]") == std::string::npos)
+    TEST_FAILED("Expected the given missing text in the group cell");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Data allocated from an arena produces the same stream
+ */
+// ----------------------------------------------------------------------
+
+void arrow_stream_pmr()
+{
+  auto tsg = std::make_shared<TS::TimeSeriesGroup>();
+  tsg->emplace_back(TS::LonLat(25, 60), *TestData::make_series());
+  tsg->emplace_back(TS::LonLat(26, 61), TestData::make_vector()->back());
+
+  const auto data = TestData::make_output_data({tsg});
+  TS::RequestArena arena;
+  const auto arena_data = TestData::to_arena(arena, data);
+
+  if (TS::arrow_stream(arena_data, {"t2m"}) != TS::arrow_stream(data, {"t2m"}))
+    TEST_FAILED("Arena data produced a different stream");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test()
+  {
+    TEST(arrow_stream);
+    TEST(arrow_stream_fd);
+    TEST(group_cells);
+    TEST(arrow_stream_pmr);
+  }
+};
+
+}  // namespace ArrowWriterTest
+
+//! The main program
+int main()
+{
+  using namespace std;
+  cout << endl << "ArrowWriter tester" << endl << "==================" << endl;
+  ArrowWriterTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,160 @@
+// ======================================================================
+/*!
+ * \brief Regression tests for CompactValue
+ */
+// ======================================================================
+
+#include "CompactValue.h"
+#include "TestTimes.h"
+#include "TimeSeriesInclude.h"
+#include <regression/tframe.h>
+#include <sstream>
+
+// Protection against namespace tests
+namespace CompactValueTest
+{
+Fmi::TimeZonePtr zone("Europe/Helsinki");
+
+Fmi::LocalDateTime make_time(int hour)
+{
+  return TestTimes::make_time(hour, zone);
+}
+
+std::string tostr(const TS::Value& value)
+{
+  std::ostringstream out;
+  out << value;
+  return out.str();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief All value types survive the conversion
+ */
+// ----------------------------------------------------------------------
+
+void round_trip()
+{
+  TS::ValuePool pool;
+
+  const std::vector<TS::Value> values{TS::None(),
+                                      std::string("Helsinki"),
+                                      -0.5,
+                                      -42,
+                                      TS::LonLat(24.9384, 60.1699),
+                                      make_time(12),
+                                      Fmi::LocalDateTime(Fmi::DateTime(Fmi::Date(1950, 6, 1)),
+                                                         Fmi::TimeZonePtr::utc)};
+
+  for (const auto& value : values)
+  {
+    const auto compact = pool.compact(value);
+    if (static_cast<std::size_t>(compact.type()) != value.index())
+      TEST_FAILED("Wrong type for " + tostr(value));
+
+    const auto result = pool.expand(compact);
+    if (result != value || tostr(result) != tostr(value))
+      TEST_FAILED("Expected " + tostr(value) + ", got " + tostr(result));
+  }
+
+  if (TS::CompactValue(1.5).getDouble() != 1.5 || TS::CompactValue(-7).getInt() != -7)
+    TEST_FAILED("Numbers must be usable without the pool");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Strings and zones are stored once
+ */
+// ----------------------------------------------------------------------
+
+void interning()
+{
+  TS::ValuePool pool;
+  const auto a = pool.compact(std::string("Helsinki"));
+  const auto b = pool.compact(std::string("Espoo"));
+  const auto c = pool.compact(std::string("Helsinki"));
+
+  if (pool.strings() != 2)
+    TEST_FAILED("Expected 2 interned strings, got " + std::to_string(pool.strings()));
+
+  if (pool.expand(a) != pool.expand(c) || pool.expand(a) == pool.expand(b))
+    TEST_FAILED("Interned strings do not match");
+
+  for (int hour = 0; hour < 10; hour++)
+    pool.compact(make_time(hour));
+  pool.compact(Fmi::LocalDateTime(Fmi::DateTime(Fmi::Date(2024, 1, 1)), Fmi::TimeZonePtr::utc));
+  if (pool.zones() != 2)
+    TEST_FAILED("Expected 2 zones, got " + std::to_string(pool.zones()));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief A compact time series expands to the original one
+ */
+// ----------------------------------------------------------------------
+
+void compact_timeseries()
+{
+  TS::TimeSeries ts;
+  for (int hour = 0; hour < 24; hour++)
+  {
+    if (hour % 5 == 0)
+      ts.emplace_back(make_time(hour), TS::None());
+    else if (hour % 3 == 0)
+      ts.emplace_back(make_time(hour), std::string("station"));
+    else
+      ts.emplace_back(make_time(hour), 0.25 * hour);
+  }
+
+  auto pool = std::make_shared<TS::ValuePool>();
+  TS::CompactTimeSeries cts(ts, pool);
+
+  if (cts.size() != ts.size() || pool->strings() != 1)
+    TEST_FAILED("Incorrect compact time series size");
+
+  std::ostringstream expected;
+  expected << ts;
+  std::ostringstream result;
+  result << cts.expand();
+  if (result.str() != expected.str())
+    TEST_FAILED("Expected\n" + expected.str() + "got\n" + result.str());
+
+  if (cts.time(3) != ts[3].time || cts.value(3) != ts[3].value || cts[4].value != ts[4].value)
+    TEST_FAILED("Incorrect value access");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test()
+  {
+    TEST(round_trip);
+    TEST(interning);
+    TEST(compact_timeseries);
+  }
+};
+
+}  // namespace CompactValueTest
+
+//! The main program
+int main()
+{
+  using namespace std;
+  cout << endl << "CompactValue tester" << endl << "===================" << endl;
+  CompactValueTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
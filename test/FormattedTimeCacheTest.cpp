@@ -0,0 +1,111 @@
+// ======================================================================
+/*!
+ * \brief Regression tests for FormattedTimeCache
+ */
+// ======================================================================
+
+#include "FormattedTimeCache.h"
+#include "TestTimes.h"
+#include "TimeSeriesInclude.h"
+#include <macgyver/StringConversion.h>
+#include <regression/tframe.h>
+#include <memory>
+
+// Protection against namespace tests
+namespace FormattedTimeCacheTest
+{
+using TestTimes::make_time;
+
+TS::FormattedTimeCache::TimeList make_timeline(int n)
+{
+  auto timeline = std::make_shared<TS::LocalTimeList>();
+  for (int hour = 0; hour < n; hour++)
+    timeline->push_back(make_time(hour));
+  return timeline;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Each timeline is formatted once per formatter and zone
+ */
+// ----------------------------------------------------------------------
+
+void format()
+{
+  std::unique_ptr<Fmi::TimeFormatter> iso(Fmi::TimeFormatter::create("iso"));
+  std::unique_ptr<Fmi::TimeFormatter> xml(Fmi::TimeFormatter::create("xml"));
+
+  auto timeline1 = make_timeline(24);
+  auto timeline2 = make_timeline(12);
+
+  TS::FormattedTimeCache cache;
+
+  // All locations share the same strings
+  const auto& times = cache.format(timeline1, *iso);
+  for (int location = 0; location < 10; location++)
+    if (&cache.format(timeline1, *iso) != &times)
+      TEST_FAILED("Timeline was formatted again for location " + Fmi::to_string(location));
+
+  if (times.size() != timeline1->size())
+    TEST_FAILED("Expected " + Fmi::to_string(timeline1->size()) + " formatted times");
+
+  auto ldt = timeline1->begin();
+  for (std::size_t i = 0; i < times.size(); ++i, ++ldt)
+  {
+    if (times[i] != iso->format(*ldt))
+      TEST_FAILED("Incorrect formatted time " + times[i] + " at " + Fmi::to_string(i));
+    if (cache.get(timeline1, i, *iso) != times[i])
+      TEST_FAILED("Incorrect single formatted time at " + Fmi::to_string(i));
+  }
+
+  // Different timelines, formatters, zones and format strings are cached separately
+  const auto& times2 = cache.format(timeline2, *iso);
+  const auto& times3 = cache.format(timeline1, *xml);
+  const auto& times4 = cache.format(timeline1, *iso, Fmi::TimeZonePtr("Europe/Helsinki"));
+  const auto& times5 = cache.format(timeline1, "%Y%m%d%H%M", std::locale::classic());
+  const auto& times6 = cache.format(timeline1, "%H", std::locale::classic());
+
+  if (times2.size() != timeline2->size() || &times3 == &times || &times4 == &times ||
+      &times5 == &times6)
+    TEST_FAILED("Different formatting requests should not share the results");
+
+  if (times4[0] != iso->format(Fmi::LocalDateTime(timeline1->front().utc_time(),
+                                                  Fmi::TimeZonePtr("Europe/Helsinki"))))
+    TEST_FAILED("Time was not converted to the requested zone: " + times4[0]);
+
+  if (times5[0] != Fmi::format_time(std::locale::classic(), "%Y%m%d%H%M", timeline1->front()))
+    TEST_FAILED("Incorrect time formatted with a format string: " + times5[0]);
+
+  if (cache.misses() != 6)
+    TEST_FAILED("Expected 6 misses, got " + Fmi::to_string(cache.misses()));
+  if (cache.hits() != 10 + times.size())
+    TEST_FAILED("Expected " + Fmi::to_string(10 + times.size()) + " hits, got " +
+                Fmi::to_string(cache.hits()));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test() { TEST(format); }
+};
+
+}  // namespace FormattedTimeCacheTest
+
+//! The main program
+int main()
+{
+  using namespace std;
+  cout << endl << "FormattedTimeCache tester" << endl << "=========================" << endl;
+  FormattedTimeCacheTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,227 @@
+// ======================================================================
+/*!
+ * \brief Regression tests for OutputSerializer
+ */
+// ======================================================================
+
+#include "OutputSerializer.h"
+#include "RowSink.h"
+#include "TestData.h"
+#include "TestTimes.h"
+#include "TimeSeriesInclude.h"
+#include <macgyver/ValueFormatter.h>
+#include <regression/tframe.h>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+// Protection against namespace tests
+namespace OutputSerializerTest
+{
+using TestTimes::make_time;
+
+// Text needing quoting or escaping and a NaN as the extra column of the shared data
+TS::OutputData make_data()
+{
+  auto names = std::make_shared<TS::TimeSeries>();
+  names->emplace_back(TS::TimedValue(make_time(0), "Helsinki, \"Kaisaniemi\""));
+  names->emplace_back(TS::TimedValue(make_time(1), "two\nlines\\\t"));
+  names->emplace_back(TS::TimedValue(make_time(2), std::numeric_limits<double>::quiet_NaN()));
+
+  return TestData::make_output_data({names});
+}
+
+std::string serialize(bool json,
+                      const std::vector<std::string>& columnnames,
+                      TS::NumberFormatting formatting = TS::NumberFormatting::ValueFormatter,
+                      bool use_arena = false)
+{
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  formatter.setMissingText("-");
+  const std::vector<int> precisions{2, 0, 0, 0};
+
+  std::string output;
+  TS::ChunkedWriter writer([&output](const char* ptr, std::size_t size)
+                           { output.append(ptr, size); });
+
+  if (use_arena)
+  {
+    TS::RequestArena arena;
+    const auto data = TestData::to_arena(arena, make_data());
+    if (json)
+      TS::write_json(writer, data, columnnames, formatter, precisions, formatting);
+    else
+      TS::write_csv(writer, data, columnnames, formatter, precisions, formatting);
+  }
+  else if (json)
+    TS::write_json(writer, make_data(), columnnames, formatter, precisions, formatting);
+  else
+    TS::write_csv(writer, make_data(), columnnames, formatter, precisions, formatting);
+  return output;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Cells are quoted only when necessary
+ */
+// ----------------------------------------------------------------------
+
+void csv()
+{
+  const std::vector<std::string> names{"t2m", "s", "n", "name,place"};
+  const auto result = serialize(false, names);
+  const std::string expected =
+      "t2m,s,n,\"name,place\"\n"
+      "1.25,abc,42,\"Helsinki, \"\"Kaisaniemi\"\"\"\n"
+      "-,,-,\"two\nlines\\\t\"\n"
+      "3,,,-\n"
+      "1.25\n"
+      "-\n"
+      "3\n";
+
+  if (result != expected)
+    TEST_FAILED("Expected\n" + expected + "got\n" + result);
+
+  // std::to_chars is an explicit option, identical for the default formatter settings
+  const auto fast = serialize(false, names, TS::NumberFormatting::ToChars);
+  if (fast != expected)
+    TEST_FAILED("Expected\n" + expected + "got\n" + fast);
+
+  // Data allocated from an arena is serialized the same way
+  const auto arena = serialize(false, names, TS::NumberFormatting::ValueFormatter, true);
+  if (arena != expected)
+    TEST_FAILED("Expected\n" + expected + "got\n" + arena);
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Rows are objects with escaped strings, plain numbers and nulls
+ */
+// ----------------------------------------------------------------------
+
+void json()
+{
+  auto result = serialize(true, {"t2m", "s", "n", "na\"me"});
+  std::string expected =
+      "[{\"t2m\":1.25,\"s\":\"abc\",\"n\":42,\"na\\\"me\":\"Helsinki, \\\"Kaisaniemi\\\"\"},"
+      "{\"t2m\":null,\"s\":null,\"n\":null,\"na\\\"me\":\"two\\nlines\\\\\\t\"},"
+      "{\"t2m\":3,\"s\":null,\"n\":null,\"na\\\"me\":null},"
+      "{\"t2m\":1.25},{\"t2m\":null},{\"t2m\":3}]";
+
+  if (result != expected)
+    TEST_FAILED("Expected\n" + expected + "\ngot\n" + result);
+
+  result = serialize(true, {"t2m", "s", "n", "na\"me"}, TS::NumberFormatting::ValueFormatter, true);
+  if (result != expected)
+    TEST_FAILED("Expected\n" + expected + "\ngot\n" + result);
+
+  // Without column names the rows are arrays
+  result = serialize(true, {});
+  expected =
+      "[[1.25,\"abc\",42,\"Helsinki, \\\"Kaisaniemi\\\"\"],"
+      "[null,null,null,\"two\\nlines\\\\\\t\"],"
+      "[3,null,null,null],"
+      "[1.25],[null],[3]]";
+
+  if (result != expected)
+    TEST_FAILED("Expected\n" + expected + "\ngot\n" + result);
+
+  // Control characters are escaped
+  std::string escaped;
+  TS::append_json_string(escaped, std::string("a\x01\x1f\bz", 5));
+  if (escaped != "\"a\\u0001\\u001f\\bz\"")
+    TEST_FAILED("Incorrect escaping of control characters: " + escaped);
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Numbers of non-default formatter settings remain valid output
+ */
+// ----------------------------------------------------------------------
+
+// Format like a ValueFormatter with the showpos, width and fill options
+std::string format_number(double value, int width, char fill)
+{
+  std::ostringstream out;
+  out << std::showpos << std::fixed << std::setprecision(1) << std::setw(width)
+      << std::setfill(fill) << value;
+  return out.str();
+}
+
+void formatted_numbers()
+{
+  const std::vector<std::string> numbers{
+      format_number(1.5, 0, ' '), format_number(-1.5, 6, ' '), format_number(2.5, 6, '0')};
+
+  if (numbers != std::vector<std::string>{"+1.5", "  -1.5", "00+2.5"})
+    TEST_FAILED("Unexpected formatted numbers");
+
+  std::string output;
+  TS::ChunkedWriter writer([&output](const char* ptr, std::size_t size)
+                           { output.append(ptr, size); });
+
+  // Invalid JSON numbers are written as strings
+  TS::JsonRowSink json(writer);
+  json.beginRow();
+  for (const auto& number : numbers)
+    json.addNumber(number);
+  json.addNumber("-0.25e+3");
+  json.addNumber("1,5");
+  json.addNumber("01");
+  json.endRow();
+  json.endTable();
+
+  std::string expected = "[[\"+1.5\",\"  -1.5\",\"00+2.5\",-0.25e+3,\"1,5\",\"01\"]]";
+  if (output != expected)
+    TEST_FAILED("Expected\n" + expected + "\ngot\n" + output);
+
+  // CSV numbers containing the separator are quoted
+  output.clear();
+  TS::CsvRowSink csv(writer);
+  csv.beginRow();
+  csv.addNumber(numbers[1]);
+  csv.addNumber("1,5");
+  csv.endRow();
+  csv.endTable();
+
+  expected = "  -1.5,\"1,5\"\n";
+  if (output != expected)
+    TEST_FAILED("Expected\n" + expected + "got\n" + output);
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test()
+  {
+    TEST(csv);
+    TEST(json);
+    TEST(formatted_numbers);
+  }
+};
+
+}  // namespace OutputSerializerTest
+
+//! The main program
+int main()
+{
+  using namespace std;
+  cout << endl << "OutputSerializer tester" << endl << "=======================" << endl;
+  OutputSerializerTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,143 @@
+// ======================================================================
+/*!
+ * \brief Regression tests for RequestArena
+ */
+// ======================================================================
+
+#include "RequestArena.h"
+#include "TestTimes.h"
+#include "TimeSeriesInclude.h"
+#include <regression/tframe.h>
+#include <sstream>
+
+// Protection against namespace tests
+namespace RequestArenaTest
+{
+using TestTimes::make_time;
+
+TS::pmr::TimeSeries make_timeseries(std::pmr::memory_resource* resource, int offset)
+{
+  TS::pmr::TimeSeries ts(resource);
+  for (int hour = 0; hour < 24; hour++)
+    ts.emplace_back(make_time(hour), 0.5 * (hour + offset));
+  return ts;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Nested series use the arena of their container
+ */
+// ----------------------------------------------------------------------
+
+void nested_containers()
+{
+  TS::RequestArena arena;
+  auto* heap = std::pmr::get_default_resource();
+
+  auto tsv = arena.make_shared<TS::pmr::TimeSeriesVector>(3);
+  for (auto& ts : *tsv)
+    if (ts.get_allocator().resource() != &arena)
+      TEST_FAILED("Series of a vector must use the arena");
+
+  (*tsv)[0] = make_timeseries(heap, 0);
+  if ((*tsv)[0].get_allocator().resource() != &arena || (*tsv)[0].size() != 24)
+    TEST_FAILED("Assigned series must stay in the arena");
+
+  auto tsg = arena.make_shared<TS::pmr::TimeSeriesGroup>();
+  tsg->emplace_back(TS::LonLat(25, 60), make_timeseries(heap, 0));
+  tsg->push_back(TS::pmr::LonLatTimeSeries(TS::LonLat(26, 61), make_timeseries(heap, 1)));
+  for (const auto& llts : *tsg)
+    if (llts.timeseries.get_allocator().resource() != &arena)
+      TEST_FAILED("Series of a group must use the arena");
+
+  if (arena.allocated() < 2 * 24 * sizeof(TS::TimedValue))
+    TEST_FAILED("Expected the values to be allocated from the arena");
+
+  // Copies outside the arena use the default resource
+  TS::pmr::TimeSeries copy((*tsv)[0]);
+  if (copy.get_allocator().resource() != heap)
+    TEST_FAILED("Copies must not use the arena");
+
+  // Heap copies of the arena containers
+  const TS::TimeSeriesGroup group = TS::to_heap(*tsg);
+  if (group.size() != 2 || group[1].timeseries.size() != 24 ||
+      group[1].timeseries.back().value != (*tsg)[1].timeseries.back().value)
+    TEST_FAILED("Incorrect heap copy of a group");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Aggregation results use the arena of the input
+ */
+// ----------------------------------------------------------------------
+
+void aggregation()
+{
+  TS::RequestArena arena;
+  auto* heap = std::pmr::get_default_resource();
+
+  TS::DataFunction inner(TS::FunctionId::Mean, TS::FunctionType::TimeFunction);
+  inner.setAggregationIntervalBehind(120);
+  inner.setAggregationIntervalAhead(0);
+  TS::DataFunctions funcs(inner, TS::DataFunction());
+
+  TS::TimeSeriesGenerator::LocalTimeList timesteps;
+  for (int hour = 0; hour < 24; hour += 3)
+    timesteps.push_back(make_time(hour));
+
+  const auto arena_ts = make_timeseries(&arena, 0);
+  const auto heap_ts = TS::to_heap(arena_ts);
+
+  auto result = TS::Aggregator::aggregate(arena_ts, funcs, timesteps);
+  auto expected = TS::Aggregator::aggregate(heap_ts, funcs, timesteps);
+  if (result->get_allocator().resource() != &arena)
+    TEST_FAILED("Aggregation result must use the arena of the input");
+
+  std::ostringstream out1;
+  out1 << *expected;
+  std::ostringstream out2;
+  out2 << TS::to_heap(*result);
+  if (out1.str() != out2.str())
+    TEST_FAILED("Expected\n" + out1.str() + "got\n" + out2.str());
+
+  TS::pmr::TimeSeriesGroup group(&arena);
+  group.emplace_back(TS::LonLat(25, 60), arena_ts);
+  group.emplace_back(TS::LonLat(26, 61), make_timeseries(heap, 1));
+  auto group_result = TS::Aggregator::aggregate(group, funcs, timesteps);
+  if (group_result->get_allocator().resource() != &arena ||
+      (*group_result)[1].timeseries.get_allocator().resource() != &arena)
+    TEST_FAILED("Group aggregation result must use the arena of the input");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test()
+  {
+    TEST(nested_containers);
+    TEST(aggregation);
+  }
+};
+
+}  // namespace RequestArenaTest
+
+//! The main program
+int main()
+{
+  using namespace std;
+  cout << endl << "RequestArena tester" << endl << "===================" << endl;
+  RequestArenaTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,180 @@
+// ======================================================================
+/*!
+ * \brief Regression tests for RequestEstimator
+ */
+// ======================================================================
+
+#include "RequestEstimator.h"
+#include "TimeSeries.h"
+#include <macgyver/Exception.h>
+#include <regression/tframe.h>
+#include <limits>
+#include <string>
+
+using namespace SmartMet::TimeSeries;
+using SmartMet::Spine::Parameter;
+
+// Protection against namespace tests
+namespace RequestEstimatorTest
+{
+DataFunctions time_functions(unsigned int behind, unsigned int ahead)
+{
+  DataFunction func(FunctionId::Mean, FunctionType::TimeFunction);
+  func.setAggregationIntervalBehind(behind);
+  func.setAggregationIntervalAhead(ahead);
+  return DataFunctions(func, DataFunction());
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Elements and bytes grow with locations, timesteps and levels
+ */
+// ----------------------------------------------------------------------
+
+void size_estimate()
+{
+  OptionParsers::ParameterOptions options;
+  options.add(Parameter("temperature", Parameter::Type::Data));
+  options.add(Parameter("name", Parameter::Type::DataIndependent));
+
+  RequestDimensions dimensions;
+  dimensions.locations = 10;
+  dimensions.timesteps = 24;
+  dimensions.levels = 2;
+
+  auto estimate = estimate_request(options, dimensions);
+
+  if (estimate.elements != 2 * 10 * 24 * 2)
+    TEST_FAILED("Expected 960 elements, got " + std::to_string(estimate.elements));
+
+  if (estimate.bytes <= estimate.elements * sizeof(TimedValue))
+    TEST_FAILED("String values should need more memory than the values themselves");
+
+  if (estimate.cost != estimate.elements)
+    TEST_FAILED("Cost without aggregation should equal the number of elements, got " +
+                std::to_string(estimate.cost));
+
+  dimensions.timesteps = 0;
+  estimate = estimate_request(options, dimensions);
+  if (estimate.elements != 0 || estimate.bytes != 0 || estimate.cost != 0)
+    TEST_FAILED("Empty timeline should produce an empty estimate");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Time aggregation multiplies the cost by the values in the interval
+ */
+// ----------------------------------------------------------------------
+
+void aggregation_cost()
+{
+  RequestDimensions dimensions;
+  dimensions.timesteps = 24;
+  dimensions.datatimestep = 60;
+
+  OptionParsers::ParameterOptions options;
+  options.add(Parameter("temperature", Parameter::Type::Data), time_functions(120, 60));
+  auto estimate = estimate_request(options, dimensions);
+
+  if (estimate.cost != 24 * 4)
+    TEST_FAILED("Expected cost 96 for a 3 hour mean, got " + std::to_string(estimate.cost));
+
+  // Unlimited intervals are capped to the maximum aggregation interval
+  OptionParsers::ParameterOptions unlimited;
+  unlimited.add(Parameter("temperature", Parameter::Type::Data),
+                time_functions(std::numeric_limits<unsigned int>::max(), 0));
+  estimate = estimate_request(unlimited, dimensions);
+
+  const std::size_t expected = 24 * (1 + MAX_AGGREGATION_INTERVAL / 60);
+  if (estimate.cost != expected)
+    TEST_FAILED("Expected cost " + std::to_string(expected) + ", got " +
+                std::to_string(estimate.cost));
+
+  // Huge requests saturate instead of wrapping around
+  dimensions.locations = std::numeric_limits<std::size_t>::max() / 2;
+  estimate = estimate_request(unlimited, dimensions);
+  if (estimate.cost != std::numeric_limits<std::size_t>::max())
+    TEST_FAILED("Expected the cost estimate to saturate");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief The limits are checked against the estimate
+ */
+// ----------------------------------------------------------------------
+
+void limits()
+{
+  OptionParsers::ParameterOptions options;
+  options.add(Parameter("temperature", Parameter::Type::Data), time_functions(120, 60));
+
+  RequestDimensions dimensions;
+  dimensions.locations = 100;
+  dimensions.timesteps = 100;
+  const auto estimate = estimate_request(options, dimensions);
+
+  // Zero means unlimited
+  RequestLimits limits;
+  check_request_limits(limits, estimate);
+
+  limits.maxbytes = estimate.bytes;
+  limits.maxcost = estimate.cost;
+  check_request_limits(limits, estimate);
+
+  try
+  {
+    limits.maxbytes = estimate.bytes - 1;
+    check_request_limits(limits, estimate);
+    TEST_FAILED("Byte limit was not enforced");
+  }
+  catch (const Fmi::Exception&)
+  {
+  }
+
+  try
+  {
+    limits.maxbytes = 0;
+    limits.maxcost = estimate.cost - 1;
+    check_request_limits(limits, estimate);
+    TEST_FAILED("Cost limit was not enforced");
+  }
+  catch (const Fmi::Exception&)
+  {
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test()
+  {
+    TEST(size_estimate);
+    TEST(aggregation_cost);
+    TEST(limits);
+  }
+};
+
+}  // namespace RequestEstimatorTest
+
+//! The main program
+int main()
+{
+  using namespace std;
+  cout << endl << "RequestEstimator tester" << endl << "=======================" << endl;
+  RequestEstimatorTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,427 @@
+// ======================================================================
+/*!
+ * \brief Regression tests for RowFeeder
+ */
+// ======================================================================
+
+#include "RowFeeder.h"
+#include "TestData.h"
+#include "TestTimes.h"
+#include "TimeSeriesInclude.h"
+#include <macgyver/StringConversion.h>
+#include <macgyver/ValueFormatter.h>
+#include <regression/tframe.h>
+#include <algorithm>
+
+// Protection against namespace tests
+namespace RowFeederTest
+{
+using TestTimes::make_time;
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Columns are written row by row in the TableFeeder layout
+ */
+// ----------------------------------------------------------------------
+
+void output_data()
+{
+  TS::TimeSeries ts1;
+  TS::TimeSeries ts2;
+  ts1.emplace_back(TS::TimedValue(make_time(0), 1));
+  ts2.emplace_back(TS::TimedValue(make_time(0), TS::LonLat(24.5, 60.5)));
+  auto tsg = std::make_shared<TS::TimeSeriesGroup>();
+  tsg->emplace_back(TS::LonLat(1, 1), ts1);
+  tsg->emplace_back(TS::LonLat(2, 2), ts2);
+
+  const auto data = TestData::make_output_data({tsg});
+
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  std::vector<int> precisions{2, 0, 0, 1};
+
+  std::string output;
+  std::size_t nchunks = 0;
+  TS::ChunkedWriter writer(
+      [&](const char* ptr, std::size_t size)
+      {
+        output.append(ptr, size);
+        ++nchunks;
+      },
+      1024);
+
+  TS::DelimitedRowSink sink(writer, ';');
+  TS::RowFeeder feeder(sink, formatter, precisions);
+
+  sink.beginTable({"t", "s", "n", "g"});
+  feeder << data;
+  sink.endTable();
+
+  const auto& m = formatter.missing();
+  const std::string expected = "t;s;n;g\n"
+                               "1.25;abc;42;[1 24.5, 60.5]\n" +
+                               m + ";;" + m + ";\n" +
+                               "3;;;\n"
+                               "1.25\n" +
+                               m + "\n" + "3\n";
+
+  if (output != expected)
+    TEST_FAILED("Expected\n" + expected + "got\n" + output);
+  if (nchunks != 1)
+    TEST_FAILED("Expected a single chunk, got " + Fmi::to_string(nchunks));
+  if (feeder.getRowCount() != 6)
+    TEST_FAILED("Expected 6 rows, got " + Fmi::to_string(feeder.getRowCount()));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Output is flushed in chunks while the rows are being fed
+ */
+// ----------------------------------------------------------------------
+
+void chunked_output()
+{
+  const int nrows = 10000;
+  auto ts = std::make_shared<TS::TimeSeries>();
+  for (int i = 0; i < nrows; i++)
+    ts->emplace_back(TS::TimedValue(make_time(i % 24), i));
+
+  TS::OutputData data;
+  data.emplace_back("data", std::vector<TS::TimeSeriesData>{ts});
+
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  std::vector<int> precisions{0};
+
+  const std::size_t chunksize = 100;
+  std::string output;
+  std::size_t maxchunk = 0;
+  std::size_t nchunks = 0;
+  TS::ChunkedWriter writer(
+      [&](const char* ptr, std::size_t size)
+      {
+        output.append(ptr, size);
+        maxchunk = std::max(maxchunk, size);
+        ++nchunks;
+      },
+      chunksize);
+
+  TS::DelimitedRowSink sink(writer);
+  TS::RowFeeder feeder(sink, formatter, precisions);
+  feeder << data;
+
+  // Only the tail may remain buffered before the end of the table
+  if (writer.buffer().size() >= chunksize)
+    TEST_FAILED("Too much data buffered: " + Fmi::to_string(writer.buffer().size()));
+
+  sink.endTable();
+
+  std::string expected;
+  for (int i = 0; i < nrows; i++)
+    expected += Fmi::to_string(i) + "\n";
+
+  if (output != expected)
+    TEST_FAILED("Chunked output differs from the expected output");
+  if (writer.bytesWritten() != expected.size())
+    TEST_FAILED("Incorrect number of bytes written: " + Fmi::to_string(writer.bytesWritten()));
+  if (nchunks < expected.size() / chunksize)
+    TEST_FAILED("Too few chunks written: " + Fmi::to_string(nchunks));
+  if (maxchunk > chunksize + 6)
+    TEST_FAILED("Too large chunk written: " + Fmi::to_string(maxchunk));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Repeated values are formatted once but output like any other value
+ */
+// ----------------------------------------------------------------------
+
+void repeated_values()
+{
+  const std::vector<TS::Value> values{1.5,
+                                      1.5,
+                                      0.0,
+                                      -0.0,
+                                      -0.0,
+                                      TS::LonLat(24.5, 60.5),
+                                      TS::LonLat(24.5, 60.5),
+                                      2,
+                                      2,
+                                      TS::None(),
+                                      "x",
+                                      "x"};
+
+  auto ts = std::make_shared<TS::TimeSeries>();
+  for (std::size_t i = 0; i < values.size(); i++)
+    ts->emplace_back(TS::TimedValue(make_time(i), values[i]));
+
+  TS::OutputData data;
+  data.emplace_back("data", std::vector<TS::TimeSeriesData>{ts});
+
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  std::vector<int> precisions{1};
+
+  std::string output;
+  TS::ChunkedWriter writer([&output](const char* ptr, std::size_t size)
+                           { output.append(ptr, size); });
+  TS::DelimitedRowSink sink(writer);
+  TS::RowFeeder feeder(sink, formatter, precisions);
+  feeder << data;
+
+  // A changed format applies to the next data even if it repeats the earlier values
+  feeder << SmartMet::Spine::LonLatFormat::LATLON;
+  feeder << data;
+  sink.endTable();
+
+  std::string expected;
+  TS::StringVisitor visitor(formatter, 1);
+  using SmartMet::Spine::LonLatFormat;
+  for (auto format : {LonLatFormat::LONLAT, LonLatFormat::LATLON})
+  {
+    visitor.setLonLatFormat(format);
+    for (const auto& value : values)
+      expected += std::visit(visitor, static_cast<const TS::Value_&>(value)) + "\n";
+  }
+
+  if (output != expected)
+    TEST_FAILED("Expected\n" + expected + "got\n" + output);
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Run-length encoded series are output like the full time series
+ */
+// ----------------------------------------------------------------------
+
+void run_length_timeseries()
+{
+  auto times = std::make_shared<TS::LocalTimeList>();
+  for (int hour = 0; hour < 5; hour++)
+    times->push_back(make_time(hour));
+
+  auto rts = std::make_shared<TS::RunLengthTimeSeries>(times);
+  rts->append("Helsinki", 2);
+  rts->append(TS::None());
+  rts->append(2.5, 2);
+  auto ts = std::make_shared<TS::TimeSeries>(rts->expand());
+
+  TS::OutputData data;
+  data.emplace_back("data", std::vector<TS::TimeSeriesData>{rts, ts});
+  data.emplace_back("constant",
+                    std::vector<TS::TimeSeriesData>{
+                        std::make_shared<TS::RunLengthTimeSeries>(TS::Value(7), times), ts});
+
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  std::vector<int> precisions{1, 1};
+
+  std::string output;
+  TS::ChunkedWriter writer([&output](const char* ptr, std::size_t size)
+                           { output.append(ptr, size); });
+  TS::DelimitedRowSink sink(writer, ';');
+  TS::RowFeeder feeder(sink, formatter, precisions);
+  feeder << data;
+  sink.endTable();
+
+  const std::string missing = formatter.missing();
+  const std::string expected = "Helsinki;Helsinki\nHelsinki;Helsinki\n" + missing + ";" +
+                               missing + "\n2.5;2.5\n2.5;2.5\n" +
+                               "7;Helsinki\n7;Helsinki\n7;" + missing + "\n7;2.5\n7;2.5\n";
+
+  if (output != expected)
+    TEST_FAILED("Expected\n" + expected + "got\n" + output);
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Timesteps are formatted once for all locations and time columns
+ */
+// ----------------------------------------------------------------------
+
+void cached_times()
+{
+  auto times = std::make_shared<TS::LocalTimeList>();
+  for (int hour = 0; hour < 5; hour++)
+    times->push_back(make_time(hour));
+
+  // Two time columns per location, the last time of the second one differs from the timeline
+  TS::OutputData data;
+  for (int location = 0; location < 3; location++)
+  {
+    auto ts1 = std::make_shared<TS::TimeSeries>();
+    for (const auto& t : *times)
+      ts1->emplace_back(TS::TimedValue(t, t));
+    auto ts2 = std::make_shared<TS::TimeSeries>(*ts1);
+    ts2->back().value = make_time(24 + location);
+    data.emplace_back("time", std::vector<TS::TimeSeriesData>{ts1, ts2});
+  }
+
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  std::vector<int> precisions{0, 0};
+
+  auto write = [&](TS::FormattedTimeCache* cache)
+  {
+    std::string output;
+    TS::ChunkedWriter writer([&output](const char* ptr, std::size_t size)
+                             { output.append(ptr, size); });
+    TS::DelimitedRowSink sink(writer, ';');
+    TS::RowFeeder feeder(sink, formatter, precisions);
+    if (cache != nullptr)
+      feeder.setTimeCache(*cache, times);
+    feeder << data;
+    sink.endTable();
+    return output;
+  };
+
+  TS::FormattedTimeCache cache;
+  const std::string expected = write(nullptr);
+  const std::string output = write(&cache);
+
+  if (output != expected)
+    TEST_FAILED("Expected\n" + expected + "got\n" + output);
+  if (cache.misses() != 1 || cache.hits() != 2)
+    TEST_FAILED("Expected the timeline to be formatted once, got " +
+                Fmi::to_string(cache.misses()) + " misses and " + Fmi::to_string(cache.hits()) +
+                " hits");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Data allocated from an arena is output like heap allocated data
+ */
+// ----------------------------------------------------------------------
+
+void pmr_output_data()
+{
+  auto rts = std::make_shared<TS::RunLengthTimeSeries>(*TestData::make_series());
+  auto tsg = std::make_shared<TS::TimeSeriesGroup>();
+  tsg->emplace_back(TS::LonLat(1, 1), *TestData::make_series());
+  tsg->emplace_back(TS::LonLat(2, 2), TestData::make_vector()->back());
+
+  const auto data = TestData::make_output_data({tsg, rts});
+  TS::RequestArena arena;
+  const auto arena_data = TestData::to_arena(arena, data);
+
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  std::vector<int> precisions{2, 0, 0, 1, 1};
+
+  auto write = [&](const auto& output_data)
+  {
+    std::string output;
+    TS::ChunkedWriter writer([&output](const char* ptr, std::size_t size)
+                             { output.append(ptr, size); });
+    TS::DelimitedRowSink sink(writer, ';');
+    TS::RowFeeder feeder(sink, formatter, precisions);
+    feeder << output_data;
+    sink.endTable();
+    return output;
+  };
+
+  const auto expected = write(data);
+  const auto output = write(arena_data);
+
+  if (output != expected)
+    TEST_FAILED("Expected\n" + expected + "got\n" + output);
+  if (arena.allocated() == 0)
+    TEST_FAILED("Nothing was allocated from the arena");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Snapshots are output like modifiable data
+ */
+// ----------------------------------------------------------------------
+
+void snapshot_output_data()
+{
+  TS::TimeSeriesGroup tsg;
+  tsg.emplace_back(TS::LonLat(1, 1), *TestData::make_series());
+  tsg.emplace_back(TS::LonLat(2, 2), TestData::make_vector()->back());
+
+  const auto data = TestData::make_output_data({std::make_shared<TS::TimeSeriesGroup>(tsg)});
+
+  TS::OutputData snapshots;
+  snapshots.emplace_back("first",
+                         std::vector<TS::TimeSeriesData>{TS::make_snapshot(*TestData::make_series()),
+                                                         TS::make_snapshot(*TestData::make_vector()),
+                                                         TS::make_snapshot(tsg)});
+  snapshots.emplace_back("second",
+                         std::vector<TS::TimeSeriesData>{TS::make_snapshot(*TestData::make_series())});
+
+  if (TS::number_of_elements(snapshots) != TS::number_of_elements(data))
+    TEST_FAILED("Expected " + Fmi::to_string(TS::number_of_elements(data)) + " elements, got " +
+                Fmi::to_string(TS::number_of_elements(snapshots)));
+
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  std::vector<int> precisions{2, 0, 0, 1};
+
+  auto write = [&](const TS::OutputData& output_data)
+  {
+    std::string output;
+    TS::ChunkedWriter writer([&output](const char* ptr, std::size_t size)
+                             { output.append(ptr, size); });
+    TS::DelimitedRowSink sink(writer, ';');
+    TS::RowFeeder feeder(sink, formatter, precisions);
+    feeder << output_data;
+    sink.endTable();
+    return output;
+  };
+
+  const auto expected = write(data);
+  const auto output = write(snapshots);
+
+  if (output != expected)
+    TEST_FAILED("Expected\n" + expected + "got\n" + output);
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test()
+  {
+    TEST(output_data);
+    TEST(chunked_output);
+    TEST(repeated_values);
+    TEST(run_length_timeseries);
+    TEST(cached_times);
+    TEST(pmr_output_data);
+    TEST(snapshot_output_data);
+  }
+};
+
+}  // namespace RowFeederTest
+
+//! The main program
+int main()
+{
+  using namespace std;
+  cout << endl << "RowFeeder tester" << endl << "================" << endl;
+  RowFeederTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
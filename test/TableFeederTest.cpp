@@ -0,0 +1,347 @@
+// ======================================================================
+/*!
+ * \brief Regression tests for TableFeeder
+ */
+// ======================================================================
+
+#include "TableFeeder.h"
+#include "TestTimes.h"
+#include "TimeSeriesInclude.h"
+#include <macgyver/StringConversion.h>
+#include <macgyver/TimeFormatter.h>
+#include <macgyver/ValueFormatter.h>
+#include <regression/tframe.h>
+#include <memory>
+#include <optional>
+
+// Protection against namespace tests
+namespace TableFeederTest
+{
+using TestTimes::make_time;
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Area values of a timestep are concatenated into one cell
+ */
+// ----------------------------------------------------------------------
+
+void timeseries_group()
+{
+  TS::TimeSeries ts1;
+  TS::TimeSeries ts2;
+  TS::TimeSeries ts3;
+
+  ts1.emplace_back(TS::TimedValue(make_time(0), 1.25));
+  ts2.emplace_back(TS::TimedValue(make_time(0), 2));
+  ts3.emplace_back(TS::TimedValue(make_time(0), TS::None()));
+
+  // Empty strings leave extra spaces which are trimmed at both ends only
+  ts1.emplace_back(TS::TimedValue(make_time(1), ""));
+  ts2.emplace_back(TS::TimedValue(make_time(1), "a"));
+  ts3.emplace_back(TS::TimedValue(make_time(1), ""));
+
+  ts1.emplace_back(TS::TimedValue(make_time(2), "b"));
+  ts2.emplace_back(TS::TimedValue(make_time(2), ""));
+  ts3.emplace_back(TS::TimedValue(make_time(2), "c"));
+
+  ts1.emplace_back(TS::TimedValue(make_time(3), ""));
+  ts2.emplace_back(TS::TimedValue(make_time(3), ""));
+  ts3.emplace_back(TS::TimedValue(make_time(3), ""));
+
+  ts1.emplace_back(TS::TimedValue(make_time(4), TS::LonLat(24.5, 60.25)));
+  ts2.emplace_back(TS::TimedValue(make_time(4), -7));
+  ts3.emplace_back(TS::TimedValue(make_time(4), " d "));
+
+  TS::TimeSeriesGroup group;
+  group.emplace_back(TS::LonLat(1, 1), ts1);
+  group.emplace_back(TS::LonLat(2, 2), ts2);
+  group.emplace_back(TS::LonLat(3, 3), ts3);
+
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  std::vector<int> precisions{2};
+
+  SmartMet::Spine::Table table;
+  TS::TableFeeder feeder(table, formatter, precisions);
+  feeder << group;
+
+  const std::vector<std::string> expected{"[1.25 2 " + formatter.missing() + "]",
+                                          "[a]",
+                                          "[b  c]",
+                                          "[]",
+                                          "[24.50, 60.25 -7  d]"};
+
+  for (std::size_t row = 0; row < expected.size(); row++)
+  {
+    auto value = table.get(0, row);
+    if (value != expected[row])
+      TEST_FAILED("Row " + std::to_string(row) + ": expected '" + expected[row] + "', got '" +
+                  value + "'");
+  }
+
+  if (feeder.getCurrentRow() != expected.size())
+    TEST_FAILED("Expected current row to be " + std::to_string(expected.size()));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Columns are fed cell by cell regardless of the value types
+ */
+// ----------------------------------------------------------------------
+
+void timeseries_vector()
+{
+  TS::TimeSeries ts1;
+  ts1.emplace_back(TS::TimedValue(make_time(0), 1.5));
+  ts1.emplace_back(TS::TimedValue(make_time(1), 2.5));
+  ts1.emplace_back(TS::TimedValue(make_time(2), 3));
+  ts1.emplace_back(TS::TimedValue(make_time(3), TS::None()));
+  ts1.emplace_back(TS::TimedValue(make_time(4), "x"));
+
+  TS::TimeSeries ts2;
+  ts2.emplace_back(TS::TimedValue(make_time(0), "a"));
+  ts2.emplace_back(TS::TimedValue(make_time(1), "b"));
+
+  TS::TimeSeriesVector tsv{ts1, ts2};
+
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  std::vector<int> precisions{1, 1, 0};
+
+  SmartMet::Spine::Table table;
+  TS::TableFeeder feeder(table, formatter, precisions);
+  feeder << tsv;
+
+  const std::vector<std::vector<std::string>> expected{
+      {"1.5", "2.5", "3", formatter.missing(), "x"}, {"a", "b"}};
+
+  for (std::size_t col = 0; col < expected.size(); col++)
+    for (std::size_t row = 0; row < expected[col].size(); row++)
+    {
+      auto value = table.get(col, row);
+      if (value != expected[col][row])
+        TEST_FAILED("Cell " + std::to_string(col) + "," + std::to_string(row) + ": expected '" +
+                    expected[col][row] + "', got '" + value + "'");
+    }
+
+  // Typed columns are appended to the next column
+  feeder.setCurrentRow(0);
+  feeder.appendColumn(std::vector<double>{0.25, 1.75});
+  if (table.get(2, 0) != "0" || table.get(2, 1) != "2" || feeder.getCurrentRow() != 2)
+    TEST_FAILED("Failed to append a typed column");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Repeated values are formatted once but output like any other value
+ */
+// ----------------------------------------------------------------------
+
+void repeated_values()
+{
+  const std::vector<TS::Value> values{1.5,
+                                      1.5,
+                                      1.5,
+                                      0.0,
+                                      -0.0,
+                                      -0.0,
+                                      TS::LonLat(24.5, 60.5),
+                                      TS::LonLat(24.5, 60.5),
+                                      2,
+                                      2,
+                                      TS::None(),
+                                      TS::None(),
+                                      "x",
+                                      "x",
+                                      1.5};
+
+  TS::TimeSeries ts;
+  for (std::size_t i = 0; i < values.size(); i++)
+    ts.emplace_back(TS::TimedValue(make_time(i), values[i]));
+
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  std::vector<int> precisions{1, 1};
+
+  SmartMet::Spine::Table table;
+  TS::TableFeeder feeder(table, formatter, precisions);
+  feeder << ts;
+
+  // Feeding the values one at a time into the next column formats every value
+  feeder.setCurrentColumn(1);
+  feeder.setCurrentRow(0);
+  for (const auto& value : values)
+  {
+    TS::TimeSeries single;
+    single.emplace_back(TS::TimedValue(make_time(0), value));
+    feeder << single;
+  }
+
+  for (std::size_t row = 0; row < values.size(); row++)
+  {
+    if (table.get(0, row) != table.get(1, row))
+      TEST_FAILED("Row " + std::to_string(row) + ": expected '" + table.get(1, row) + "', got '" +
+                  table.get(0, row) + "'");
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Run-length encoded series are output like the full time series
+ */
+// ----------------------------------------------------------------------
+
+void run_length_timeseries()
+{
+  auto times = std::make_shared<TS::LocalTimeList>();
+  for (int hour = 0; hour < 5; hour++)
+    times->push_back(make_time(hour));
+
+  TS::RunLengthTimeSeries rts(times);
+  rts.append("Helsinki", 2);
+  rts.append(TS::None());
+  rts.append(2.5, 2);
+
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  std::vector<int> precisions{1, 1};
+
+  SmartMet::Spine::Table table;
+  TS::TableFeeder feeder(table, formatter, precisions);
+  feeder << rts;
+  feeder.setCurrentColumn(1);
+  feeder.setCurrentRow(0);
+  feeder << rts.expand();
+
+  for (std::size_t row = 0; row < times->size(); row++)
+  {
+    if (table.get(0, row) != table.get(1, row))
+      TEST_FAILED("Row " + std::to_string(row) + ": expected '" + table.get(1, row) + "', got '" +
+                  table.get(0, row) + "'");
+  }
+
+  if (feeder.getCurrentRow() != times->size())
+    TEST_FAILED("Expected current row to be " + std::to_string(times->size()));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Timesteps are formatted once for all locations and time columns
+ */
+// ----------------------------------------------------------------------
+
+// Counts the formatted times
+class CountingTimeFormatter : public Fmi::TimeFormatter
+{
+ public:
+  std::string format(const Fmi::DateTime& t) const override
+  {
+    ++count;
+    return Fmi::to_iso_extended_string(t);
+  }
+  std::string format(const Fmi::LocalDateTime& t) const override
+  {
+    ++count;
+    return Fmi::to_iso_extended_string(t.local_time());
+  }
+
+  mutable std::size_t count = 0;
+};
+
+void cached_times()
+{
+  const int ntimes = 5;
+  const int nlocations = 3;
+
+  auto times = std::make_shared<TS::LocalTimeList>();
+  for (int hour = 0; hour < ntimes; hour++)
+    times->push_back(make_time(hour));
+
+  // Two time columns per location, the last timestep differs from the timeline
+  TS::TimeSeriesVector columns;
+  for (int i = 0; i < 2 * nlocations; i++)
+  {
+    TS::TimeSeries ts;
+    for (const auto& t : *times)
+      ts.emplace_back(TS::TimedValue(t, t));
+    ts.back().value = make_time(ntimes + i);
+    columns.push_back(ts);
+  }
+
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  std::vector<int> precisions(columns.size(), 0);
+  auto timeformatter = std::make_shared<CountingTimeFormatter>();
+
+  TS::FormattedTimeCache cache;
+  SmartMet::Spine::Table table;
+  for (int location = 0; location < nlocations; location++)
+  {
+    TS::TableFeeder feeder(table, formatter, precisions, timeformatter, std::nullopt, 2 * location);
+    feeder.setCurrentRow(0);
+    feeder.setTimeCache(cache, times);
+    feeder << TS::TimeSeriesVector(columns.begin() + 2 * location,
+                                   columns.begin() + 2 * location + 2);
+  }
+
+  // The timeline once and the differing times one by one
+  const std::size_t expected_count = ntimes + columns.size();
+  if (timeformatter->count != expected_count)
+    TEST_FAILED("Expected " + std::to_string(expected_count) + " formatted times, got " +
+                std::to_string(timeformatter->count));
+
+  if (cache.misses() != 1)
+    TEST_FAILED("Expected the timeline to be formatted once");
+
+  for (std::size_t col = 0; col < columns.size(); col++)
+    for (std::size_t row = 0; row < columns[col].size(); row++)
+    {
+      const auto& ldt = std::get<Fmi::LocalDateTime>(columns[col][row].value);
+      const std::string expected = Fmi::to_iso_extended_string(ldt.local_time());
+      if (table.get(col, row) != expected)
+        TEST_FAILED("Column " + std::to_string(col) + " row " + std::to_string(row) +
+                    ": expected '" + expected + "', got '" + table.get(col, row) + "'");
+    }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test()
+  {
+    TEST(timeseries_group);
+    TEST(timeseries_vector);
+    TEST(repeated_values);
+    TEST(run_length_timeseries);
+    TEST(cached_times);
+  }
+};
+
+}  // namespace TableFeederTest
+
+//! The main program
+int main()
+{
+  using namespace std;
+  cout << endl << "TableFeeder tester" << endl << "==================" << endl;
+  TableFeederTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,92 @@
+// ======================================================================
+/*!
+ * \brief Output data shared by the regression tests
+ */
+// ======================================================================
+
+#pragma once
+
+#include "RequestArena.h"
+#include "TestTimes.h"
+#include "TimeSeriesInclude.h"
+#include <memory>
+#include <variant>
+#include <vector>
+
+namespace TestData
+{
+// Numbers with a missing value in the middle: 1.25, missing, 3
+inline TS::TimeSeriesPtr make_series()
+{
+  using TestTimes::make_time;
+
+  auto ts = std::make_shared<TS::TimeSeries>();
+  ts->emplace_back(TS::TimedValue(make_time(0), 1.25));
+  ts->emplace_back(TS::TimedValue(make_time(1), TS::None()));
+  ts->emplace_back(TS::TimedValue(make_time(2), 3));
+  return ts;
+}
+
+// Two members shorter than the series: "abc" and 42, missing
+inline TS::TimeSeriesVectorPtr make_vector()
+{
+  using TestTimes::make_time;
+
+  auto tsv = std::make_shared<TS::TimeSeriesVector>(2);
+  (*tsv)[0].emplace_back(TS::TimedValue(make_time(0), "abc"));
+  (*tsv)[1].emplace_back(TS::TimedValue(make_time(0), 42));
+  (*tsv)[1].emplace_back(TS::TimedValue(make_time(1), TS::None()));
+  return tsv;
+}
+
+// Element "first" with the series, the vector and the extra columns, and element "second" with
+// the series only
+inline TS::OutputData make_output_data(const std::vector<TS::TimeSeriesData>& extra = {})
+{
+  const auto ts = make_series();
+
+  std::vector<TS::TimeSeriesData> first{ts, make_vector()};
+  first.insert(first.end(), extra.begin(), extra.end());
+
+  TS::OutputData data;
+  data.emplace_back("first", first);
+  data.emplace_back("second", std::vector<TS::TimeSeriesData>{ts});
+  return data;
+}
+
+// Copy of the data allocated from the arena. Run-length encoded series are shared.
+inline TS::pmr::OutputData to_arena(TS::RequestArena& arena, const TS::OutputData& data)
+{
+  TS::pmr::OutputData result;
+  for (const auto& item : data)
+  {
+    std::vector<TS::pmr::TimeSeriesData> columns;
+    for (const auto& tsdata : item.second)
+    {
+      if (const auto* ts = std::get_if<TS::TimeSeriesPtr>(&tsdata))
+        columns.push_back(arena.make_shared<TS::pmr::TimeSeries>(**ts));
+      else if (const auto* tsv = std::get_if<TS::TimeSeriesVectorPtr>(&tsdata))
+      {
+        auto copy = arena.make_shared<TS::pmr::TimeSeriesVector>();
+        for (const auto& ts : **tsv)
+          copy->emplace_back(ts);
+        columns.push_back(copy);
+      }
+      else if (const auto* tsg = std::get_if<TS::TimeSeriesGroupPtr>(&tsdata))
+      {
+        auto copy = arena.make_shared<TS::pmr::TimeSeriesGroup>();
+        for (const auto& lts : **tsg)
+          copy->emplace_back(lts.lonlat, TS::pmr::TimeSeries(lts.timeseries));
+        columns.push_back(copy);
+      }
+      else
+        columns.push_back(std::get<TS::RunLengthTimeSeriesPtr>(tsdata));
+    }
+    result.emplace_back(item.first, columns);
+  }
+  return result;
+}
+
+}  // namespace TestData
+
+// ======================================================================
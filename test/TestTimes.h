@@ -0,0 +1,23 @@
+// ======================================================================
+/*!
+ * \brief Times shared by the regression tests
+ */
+// ======================================================================
+
+#pragma once
+
+#include <macgyver/DateTime.h>
+#include <macgyver/LocalDateTime.h>
+
+namespace TestTimes
+{
+// The given hour of 2024-01-01, by default in UTC
+inline Fmi::LocalDateTime make_time(int hour,
+                                    const Fmi::TimeZonePtr& zone = Fmi::TimeZonePtr::utc)
+{
+  return Fmi::LocalDateTime(Fmi::DateTime(Fmi::Date(2024, 1, 1), Fmi::Hours(hour)), zone);
+}
+
+}  // namespace TestTimes
+
+// ======================================================================
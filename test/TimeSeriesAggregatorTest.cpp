@@ -7,7 +7,10 @@
 #include "TimeSeriesInclude.h"
 #include <memory>
 #include <boost/make_shared.hpp>
+#include <newbase/NFmiGlobals.h>
 #include <regression/tframe.h>
+#include <algorithm>
+#include <cmath>
 
 const char *tz_eet_name = "EET";
 
@@ -1609,6 +1612,217 @@ void time_aggregation_with_selected_times()
   TEST_PASSED();
 }
 
+void time_aggregation_with_lazy_times()
+{
+  using namespace SmartMet;
+  Fmi::TimeZonePtr zone(tz_eet_name);
+
+  Fmi::LocalDateTime ldt(Fmi::Date(2015, 3, 3), Fmi::Hours(0), zone);
+
+  TS::TimeSeries timeseries;
+  for (int minutes = 0; minutes < 1440; minutes += 5)
+    timeseries.emplace_back(TS::TimedValue(ldt + Fmi::Minutes(minutes), 0.1 * minutes));
+
+  TS::TimeSeriesGeneratorOptions opt;
+  opt.mode = TS::TimeSeriesGeneratorOptions::Mode::TimeSteps;
+  opt.startTime = Fmi::DateTime(Fmi::Date(2015, 3, 2), Fmi::Hours(18));
+  opt.startTimeUTC = false;
+  opt.endTime = Fmi::DateTime(Fmi::Date(2015, 3, 4), Fmi::Hours(6));
+  opt.endTimeUTC = false;
+  opt.timeStep = 180;
+
+  const auto timelist = TS::TimeSeriesGenerator::generate(opt, zone);
+  const TS::TimeSeriesGenerator::LocalTimeRange timerange(opt, zone);
+
+  TS::DataFunctions funcs;
+  funcs.innerFunction = TS::DataFunction(TS::FunctionId::Mean, TS::FunctionType::TimeFunction);
+  funcs.innerFunction.setAggregationIntervalBehind(60);
+  funcs.innerFunction.setAggregationIntervalAhead(60);
+
+  std::ostringstream expected_result;
+  expected_result << *TS::Aggregator::aggregate(timeseries, funcs, timelist);
+
+  std::ostringstream test_result;
+  test_result << *TS::Aggregator::aggregate(timeseries, funcs, timerange);
+
+  if (test_result.str() != expected_result.str())
+    TEST_FAILED("result='" + test_result.str() + "' =! '" + expected_result.str() + "'");
+
+  TEST_PASSED();
+}
+
+// Aggregate and print the result, or the fact that the aggregation failed
+template <typename T>
+std::string aggregate_to_string(const T& input,
+                                const TS::DataFunctions& funcs,
+                                const TS::TimeSeriesGenerator::LocalTimeList& timesteps)
+{
+  try
+  {
+    const auto result = TS::Aggregator::aggregate(input, funcs, timesteps);
+    if constexpr (std::is_same_v<T, TS::RunLengthTimeSeries>)
+      return to_string(result->expand());
+    else
+      return to_string(*result);
+  }
+  catch (...)
+  {
+    return "exception";
+  }
+}
+
+void run_length_aggregation()
+{
+  using namespace SmartMet;
+  Fmi::TimeZonePtr zone(tz_eet_name);
+
+  const Fmi::LocalDateTime start(Fmi::Date(2015, 3, 3), Fmi::Hours(0), zone);
+
+  // Data every 10 minutes with a gap, aggregation timesteps also outside the data
+  auto times = std::make_shared<TS::LocalTimeList>();
+  for (int minutes = 0; minutes <= 360; minutes += 10)
+    if (minutes < 120 || minutes > 200)
+      times->push_back(start + Fmi::Minutes(minutes));
+
+  TS::TimeSeriesGenerator::LocalTimeList timesteps;
+  for (int hour = -2; hour <= 8; hour++)
+    timesteps.push_back(start + Fmi::Hours(hour));
+
+  const std::vector<TS::Value> values{
+      1.5, 7, TS::None(), "abc", TS::LonLat(24.5, 60.5), start + Fmi::Hours(12)};
+
+  std::vector<TS::RunLengthTimeSeries> inputs;
+  for (const auto& value : values)
+    inputs.emplace_back(value, times);
+
+  // Two runs are aggregated via the full time series
+  TS::RunLengthTimeSeries two_runs(times);
+  two_runs.append(2.5, 10);
+  two_runs.append(3.5, times->size() - 10);
+  inputs.push_back(two_runs);
+
+  for (int id = int(TS::FunctionId::Mean); id < int(TS::FunctionId::NullFunction); id++)
+  {
+    const auto fid = static_cast<TS::FunctionId>(id);
+    TS::DataFunction time_function(fid, TS::FunctionType::TimeFunction);
+    time_function.setAggregationIntervalBehind(30);
+    time_function.setAggregationIntervalAhead(30);
+
+    TS::DataFunction limited_time_function = time_function;
+    limited_time_function.setLimits(2.0, 3.0);
+
+    const TS::DataFunction area_function(
+        TS::FunctionId::Maximum, TS::FunctionType::AreaFunction, 2.0, 3.0);
+
+    const std::vector<TS::DataFunctions> functions{
+        TS::DataFunctions(time_function, TS::DataFunction()),
+        TS::DataFunctions(limited_time_function, TS::DataFunction()),
+        TS::DataFunctions(area_function, time_function),
+        TS::DataFunctions(time_function, area_function),
+        TS::DataFunctions(area_function, TS::DataFunction()),
+        TS::DataFunctions()};
+
+    for (const auto& funcs : functions)
+      for (const auto& input : inputs)
+      {
+        const auto expected = aggregate_to_string(input.expand(), funcs, timesteps);
+        const auto result = aggregate_to_string(input, funcs, timesteps);
+        if (result != expected)
+        {
+          std::ostringstream out;
+          out << funcs;
+          TEST_FAILED("Run-length aggregation with " + out.str() + " of " +
+                      to_string(input.expand()) + "should be:\n" + expected + "\n not \n" +
+                      result);
+        }
+      }
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Float32 columns are area aggregated like the equivalent group
+ */
+// ----------------------------------------------------------------------
+
+void float_columns()
+{
+  using namespace SmartMet;
+  Fmi::TimeZonePtr zone(tz_eet_name);
+  const Fmi::LocalDateTime start(Fmi::Date(2015, 3, 3), Fmi::Hours(0), zone);
+
+  // Columns of different sizes, one with a missing value, and an empty column
+  TS::Aggregator::FloatColumns columns;
+  for (std::size_t n : {1, 7, 8, 9, 100, 1001, 0})
+  {
+    TS::Aggregator::FloatColumn column{start + Fmi::Hours(columns.size()), {}};
+    for (std::size_t i = 0; i < n; i++)
+      column.values.push_back(static_cast<float>((i * 37 + n) % 360) / 4);
+    if (n == 9)
+      column.values[4] = kFloatMissing;
+    columns.push_back(column);
+  }
+
+  // Functions with float kernels and ones aggregated like groups
+  std::vector<TS::DataFunction> functions;
+  for (const auto id : {TS::FunctionId::Mean,
+                        TS::FunctionId::Amean,
+                        TS::FunctionId::CircleMean,
+                        TS::FunctionId::Maximum,
+                        TS::FunctionId::Minimum,
+                        TS::FunctionId::Sum,
+                        TS::FunctionId::Median})
+    functions.emplace_back(id, TS::FunctionType::AreaFunction);
+  functions.emplace_back(TS::FunctionId::Count, TS::FunctionType::AreaFunction, 10.0, 50.0);
+  functions.emplace_back(TS::FunctionId::Mean, TS::FunctionType::AreaFunction, 10.0, 50.0);
+  functions.back().setIsNaNFunction(true);
+
+  for (const auto& func : functions)
+  {
+    const auto result = TS::Aggregator::area_aggregate(columns, func);
+    if (result->size() != columns.size())
+      TEST_FAILED("Expected one value per column for " + func.hash());
+
+    for (std::size_t j = 0; j < columns.size(); j++)
+    {
+      // The same values as a group of locations, empty groups have no result
+      TS::TimeSeriesGroup group;
+      for (const float value : columns[j].values)
+      {
+        TS::TimeSeries ts;
+        if (value == kFloatMissing)
+          ts.emplace_back(columns[j].time, TS::None());
+        else
+          ts.emplace_back(columns[j].time, static_cast<double>(value));
+        group.emplace_back(TS::LonLat(25 + group.size() * 0.01, 60), ts);
+      }
+
+      TS::Value expected_value = TS::None();
+      if (!group.empty())
+      {
+        const TS::TimeSeriesGenerator::LocalTimeList timesteps{columns[j].time};
+        const auto expected = TS::Aggregator::aggregate(
+            group, TS::DataFunctions(func, TS::DataFunction()), timesteps);
+        expected_value = (*expected)[0].timeseries[0].value;
+      }
+
+      const auto& value = (*result)[j].value;
+      const auto* x = std::get_if<double>(&value);
+      const auto* y = std::get_if<double>(&expected_value);
+      const bool ok = (x != nullptr && y != nullptr
+                           ? std::abs(*x - *y) <= 1e-9 * std::max(1.0, std::abs(*y))
+                           : value.index() == expected_value.index());
+      if (!ok || (*result)[j].time != columns[j].time)
+        TEST_FAILED("Float column aggregation of column " + std::to_string(j) + " with " +
+                    func.hash() + " differs from group aggregation");
+    }
+  }
+
+  TEST_PASSED();
+}
+
 // ----------------------------------------------------------------------
 /*!
  * The actual test suite
@@ -1670,6 +1884,9 @@ class tests : public tframe::tests
     TEST(mean_t_a_with_range);
 
     TEST(time_aggregation_with_selected_times);
+    TEST(time_aggregation_with_lazy_times);
+    TEST(run_length_aggregation);
+    TEST(float_columns);
   }
 };
 
@@ -6,6 +6,9 @@
 
 #include "TimeSeriesInclude.h"
 #include <boost/make_shared.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 #include <macgyver/StringConversion.h>
 #include <macgyver/TimeParser.h>
 #include <macgyver/TimeZones.h>
@@ -541,6 +544,267 @@ void offset()
   TEST_PASSED();
 }
 
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test the lazy range produces the same times as generate()
+ */
+// ----------------------------------------------------------------------
+
+void lazy_range()
+{
+  using namespace SmartMet::TimeSeries;
+
+  auto tlist = std::make_shared<TimeSeriesGeneratorOptions::TimeList::element_type>();
+  for (int i = 0; i < 100; i++)
+    tlist->push_back(Fmi::DateTime(Fmi::Date(2012, 10, 20), Fmi::Hours(3 * i)));
+
+  std::vector<TimeSeriesGeneratorOptions> options;
+
+  TimeSeriesGeneratorOptions opt;
+  opt.mode = TimeSeriesGeneratorOptions::Mode::TimeSteps;
+  opt.startTime = Fmi::DateTime(Fmi::Date(2012, 3, 20), Fmi::Minutes(5));
+  opt.startTimeUTC = false;
+  opt.endTime = Fmi::DateTime(Fmi::Date(2012, 11, 2), Fmi::Hours(0));
+  opt.endTimeUTC = false;
+  opt.timeStep = 30;
+  options.push_back(opt);
+
+  opt.timeSteps = 500;
+  options.push_back(opt);
+
+  opt.timeSteps = 0;
+  options.push_back(opt);
+
+  opt.timeSteps.reset();
+  opt.days.insert(25);
+  opt.days.insert(28);
+  options.push_back(opt);
+
+  opt.days.clear();
+  opt.timeStep = 0;
+  options.push_back(opt);
+
+  opt.mode = TimeSeriesGeneratorOptions::Mode::DataTimes;
+  opt.startTime = Fmi::DateTime(Fmi::Date(2012, 10, 25), Fmi::Hours(0));
+  opt.setDataTimes(tlist, false);
+  options.push_back(opt);
+
+  opt.timeSteps = 10;
+  options.push_back(opt);
+
+  opt.timeSteps.reset();
+  opt.mode = TimeSeriesGeneratorOptions::Mode::FixedTimes;
+  opt.timeList.insert(1200);
+  opt.timeList.insert(1800);
+  options.push_back(opt);
+
+  for (const char* zone : {"UTC", "Europe/Helsinki"})
+  {
+    auto tz = timezones.time_zone_from_string(zone);
+    for (std::size_t i = 0; i < options.size(); i++)
+    {
+      const auto expected = TimeSeriesGenerator::generate(options[i], tz);
+
+      TimeSeriesGenerator::LocalTimeRange range(options[i], tz);
+      const TimeSeriesGenerator::LocalTimeList times(range.begin(), range.end());
+
+      const std::string msg = std::string(zone) + " case " + Fmi::to_string(i);
+      if (tostr(times) != tostr(expected))
+        TEST_FAILED("Lazy range differs from generate() in " + msg);
+      if (range.max_size() < expected.size())
+        TEST_FAILED("Too small max_size " + Fmi::to_string(range.max_size()) + " in " + msg);
+      if (TimeSeriesGenerator::max_size(options[i], tz) != range.max_size())
+        TEST_FAILED("Inconsistent max_size in " + msg);
+      if (range.empty() != expected.empty())
+        TEST_FAILED("Inconsistent empty() in " + msg);
+    }
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test the cache extends times when data times are appended
+ */
+// ----------------------------------------------------------------------
+
+void cache_appended_datatimes()
+{
+  using namespace SmartMet::TimeSeries;
+
+  TimeSeriesGeneratorCache cache;
+  auto tz = timezones.time_zone_from_string("Europe/Helsinki");
+
+  for (auto mode : {TimeSeriesGeneratorOptions::Mode::DataTimes,
+                    TimeSeriesGeneratorOptions::Mode::GraphTimes})
+  {
+    for (bool enddata : {false, true})
+    {
+      TimeSeriesGeneratorOptions opt;
+      opt.mode = mode;
+      opt.startTime = Fmi::DateTime(Fmi::Date(2012, 10, 28), Fmi::Minutes(30));
+      opt.startTimeUTC = false;
+      opt.endTime = Fmi::DateTime(Fmi::Date(2012, 10, 29), Fmi::Hours(12));
+      opt.endTimeUTC = false;
+      opt.endTimeData = enddata;
+
+      auto tlist = std::make_shared<TimeSeriesGeneratorOptions::TimeList::element_type>();
+      for (int i = 0; i < 60; i++)
+      {
+        tlist->push_back(Fmi::DateTime(Fmi::Date(2012, 10, 27), Fmi::Minutes(40 * i)));
+        if (i % 10 != 9)
+          continue;
+
+        // A new list each time just like when data is updated
+        auto datatimes =
+            std::make_shared<TimeSeriesGeneratorOptions::TimeList::element_type>(*tlist);
+        opt.setDataTimes(datatimes, false);
+
+        const std::string expected = tostr(TimeSeriesGenerator::generate(opt, tz));
+        const std::string ret = tostr(*cache.generate(opt, tz));
+        if (ret != expected)
+          TEST_FAILED("Cached times differ after " + Fmi::to_string(i + 1) + " data times:\n" +
+                      ret + " <>\n" + expected);
+      }
+    }
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test extended times replace the superseded times in the cache
+ */
+// ----------------------------------------------------------------------
+
+void cache_superseded_datatimes()
+{
+  using namespace SmartMet::TimeSeries;
+
+  TimeSeriesGeneratorCache cache;
+
+  TimeSeriesGeneratorOptions opt;
+  opt.mode = TimeSeriesGeneratorOptions::Mode::DataTimes;
+  opt.startTime = Fmi::DateTime(Fmi::Date(2012, 10, 27), Fmi::Hours(0));
+  opt.endTime = Fmi::DateTime(Fmi::Date(2012, 10, 30), Fmi::Hours(0));
+
+  auto tlist = std::make_shared<TimeSeriesGeneratorOptions::TimeList::element_type>();
+  for (int i = 0; i < 24; i++)
+  {
+    tlist->push_back(Fmi::DateTime(Fmi::Date(2012, 10, 27), Fmi::Hours(i)));
+    if (i % 6 != 5)
+      continue;
+
+    // A new zone object each time, the cache must identify the zone by its name
+    auto tz = timezones.time_zone_from_string("UTC");
+    auto datatimes = std::make_shared<TimeSeriesGeneratorOptions::TimeList::element_type>(*tlist);
+    opt.setDataTimes(datatimes, false);
+
+    const std::string expected = tostr(TimeSeriesGenerator::generate(opt, tz));
+    const std::string ret = tostr(*cache.generate(opt, tz));
+    if (ret != expected)
+      TEST_FAILED("Cached times differ after " + Fmi::to_string(i + 1) + " data times:\n" + ret +
+                  " <>\n" + expected);
+
+    if (cache.getCacheStats().size != 1)
+      TEST_FAILED("Expected only the latest version to be cached after " +
+                  Fmi::to_string(i + 1) + " data times, the cache size is " +
+                  Fmi::to_string(cache.getCacheStats().size));
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test saving and loading a cache snapshot
+ */
+// ----------------------------------------------------------------------
+
+void cache_snapshot()
+{
+  using namespace SmartMet::TimeSeries;
+
+  const std::string filename = "/tmp/TimeSeriesGeneratorTest.snapshot";
+
+  TimeSeriesGeneratorOptions opt;
+  opt.mode = TimeSeriesGeneratorOptions::Mode::TimeSteps;
+  opt.startTime = Fmi::DateTime(Fmi::Date(2012, 3, 24), Fmi::Hours(0));
+  opt.startTimeUTC = false;
+  opt.endTime = opt.startTime + Fmi::Hours(72);
+  opt.endTimeUTC = false;
+
+  std::vector<TimeSeriesGeneratorOptions> options;
+  for (unsigned int timestep : {15, 30, 60, 180})
+  {
+    opt.timeStep = timestep;
+    options.push_back(opt);
+  }
+
+  auto tz = timezones.time_zone_from_string("Europe/Helsinki");
+
+  TimeSeriesGeneratorCache cache;
+  for (std::size_t i = 0; i < options.size(); i++)
+    for (std::size_t j = 0; j <= i; j++)
+      cache.generate(options[i], tz);
+
+  // The least used series should be dropped
+  cache.save(filename, options.size() - 1);
+
+  TimeSeriesGeneratorCache cache2;
+  auto n = cache2.load(filename);
+  std::remove(filename.c_str());
+
+  if (n != options.size() - 1)
+    TEST_FAILED("Expected to load " + Fmi::to_string(options.size() - 1) + " time series, got " +
+                Fmi::to_string(n));
+
+  for (const auto& o : options)
+  {
+    const std::string expected = tostr(TimeSeriesGenerator::generate(o, tz));
+    const std::string ret = tostr(*cache2.generate(o, tz));
+    if (ret != expected)
+      TEST_FAILED("Loaded time series differs:\n" + ret + " <>\n" + expected);
+  }
+
+  if (cache2.getCacheStats().hits != options.size() - 1)
+    TEST_FAILED("Expected " + Fmi::to_string(options.size() - 1) + " cache hits after loading");
+
+  if (cache2.load(filename) != 0)
+    TEST_FAILED("Loading a missing snapshot should load nothing");
+
+  // Damaged snapshots are ignored instead of failing the warm start
+  cache.save(filename, options.size());
+  std::string contents;
+  {
+    std::ifstream in(filename, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+
+  auto write_file = [&filename](const std::string& data)
+  {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out << data;
+  };
+
+  write_file(contents.substr(0, contents.size() - 4));
+  TimeSeriesGeneratorCache cache3;
+  if (cache3.load(filename) != 0)
+    TEST_FAILED("Loading a truncated snapshot should load nothing");
+  if (cache3.getCacheStats().size != 0)
+    TEST_FAILED("A truncated snapshot should not be loaded partially");
+
+  write_file("XXXX" + contents.substr(4));
+  if (cache3.load(filename) != 0)
+    TEST_FAILED("Loading a file which is not a snapshot should load nothing");
+
+  std::remove(filename.c_str());
+
+  TEST_PASSED();
+}
+
 // ----------------------------------------------------------------------
 /*!
  * The actual test suite
@@ -567,6 +831,10 @@ class tests : public tframe::tests
     TEST(offset);
     TEST(datatimes);
     TEST(datatimes_climatology);
+    TEST(lazy_range);
+    TEST(cache_appended_datatimes);
+    TEST(cache_superseded_datatimes);
+    TEST(cache_snapshot);
   }
 };
 
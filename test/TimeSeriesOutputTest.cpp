@@ -0,0 +1,143 @@
+// ======================================================================
+/*!
+ * \brief Regression tests for TimeSeriesOutput
+ */
+// ======================================================================
+
+#include "TimeSeriesInclude.h"
+#include <macgyver/StringConversion.h>
+#include <macgyver/ValueFormatter.h>
+#include <regression/tframe.h>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <sstream>
+
+// Protection against namespace tests
+namespace TimeSeriesOutputTest
+{
+// Values which are known to be hard to round correctly, and random values of all magnitudes
+std::vector<double> test_values()
+{
+  std::vector<double> values{0,
+                             -0.0,
+                             0.5,
+                             1.5,
+                             2.5,
+                             -2.5,
+                             0.125,
+                             0.375,
+                             1.005,
+                             2.675,
+                             0.1 + 0.2,
+                             -0.004,
+                             -0.5,
+                             1e-7,
+                             -1e-7,
+                             9.9999999,
+                             999999.5,
+                             1e15 + 0.3,
+                             123456.789,
+                             4.35,
+                             std::numeric_limits<double>::min(),
+                             std::numeric_limits<double>::denorm_min(),
+                             std::numeric_limits<double>::max(),
+                             std::numeric_limits<double>::lowest(),
+                             std::numeric_limits<double>::infinity(),
+                             -std::numeric_limits<double>::infinity(),
+                             std::numeric_limits<double>::quiet_NaN()};
+
+  std::mt19937 generator(12345);
+  std::uniform_real_distribution<double> mantissa(-10, 10);
+  std::uniform_int_distribution<int> exponent(-12, 20);
+  for (int i = 0; i < 20000; i++)
+    values.push_back(mantissa(generator) * std::pow(10.0, exponent(generator)));
+
+  // Typical observation values with one or two decimals
+  for (int i = -5000; i <= 5000; i++)
+    values.push_back(i / 100.0);
+
+  return values;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief The to_chars backend produces the same output as the ValueFormatter
+ */
+// ----------------------------------------------------------------------
+
+void number_formatting()
+{
+  Fmi::ValueFormatterParam param;
+  Fmi::ValueFormatter formatter(param);
+  formatter.setMissingText("-");
+
+  const auto values = test_values();
+
+  for (int precision = 0; precision <= 10; precision++)
+  {
+    TS::StringVisitor reference(formatter, precision);
+    TS::StringVisitor visitor(formatter, precision);
+    visitor.setNumberFormatting(TS::NumberFormatting::ToChars);
+
+    for (double value : values)
+    {
+      const auto expected = reference(value);
+      const auto result = visitor(value);
+      if (result != expected)
+        TEST_FAILED("StringVisitor formatted " + Fmi::to_string(value) + " with precision " +
+                    Fmi::to_string(precision) + " as '" + result + "' instead of '" + expected +
+                    "'");
+
+      std::ostringstream out1;
+      std::ostringstream out2;
+      TS::OStreamVisitor ostream_reference(out1, formatter, precision);
+      TS::OStreamVisitor ostream_visitor(out2, formatter, precision);
+      ostream_visitor.setNumberFormatting(TS::NumberFormatting::ToChars);
+      ostream_reference(value);
+      ostream_visitor(value);
+      if (out1.str() != out2.str())
+        TEST_FAILED("OStreamVisitor formatted " + Fmi::to_string(value) + " with precision " +
+                    Fmi::to_string(precision) + " as '" + out2.str() + "' instead of '" +
+                    out1.str() + "'");
+    }
+  }
+
+  // Coordinates are formatted with the same backend
+  TS::StringVisitor reference(formatter, 3);
+  TS::StringVisitor visitor(formatter, 3);
+  visitor.setNumberFormatting(TS::NumberFormatting::ToChars);
+  reference.setLonLatFormat(SmartMet::Spine::LonLatFormat::LATLON);
+  visitor.setLonLatFormat(SmartMet::Spine::LonLatFormat::LATLON);
+  const TS::LonLat lonlat(24.9375, -60.0625);
+  if (visitor(lonlat) != reference(lonlat))
+    TEST_FAILED("Coordinates formatted as '" + visitor(lonlat) + "' instead of '" +
+                reference(lonlat) + "'");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test() { TEST(number_formatting); }
+};
+
+}  // namespace TimeSeriesOutputTest
+
+//! The main program
+int main()
+{
+  using namespace std;
+  cout << endl << "TimeSeriesOutput tester" << endl << "=======================" << endl;
+  TimeSeriesOutputTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,383 @@
+// ======================================================================
+/*!
+ * \brief Regression tests for TimeSeriesUtility
+ */
+// ======================================================================
+
+#include "TestTimes.h"
+#include "TimeSeriesInclude.h"
+#include <macgyver/StringConversion.h>
+#include <regression/tframe.h>
+#include <atomic>
+#include <functional>
+#include <sstream>
+#include <thread>
+
+// Protection against namespace tests
+namespace TimeSeriesUtilityTest
+{
+using TestTimes::make_time;
+
+// Runs the tasks in a few threads like the thread pool of a server would
+void thread_executor(std::size_t n, const std::function<void(std::size_t)>& task)
+{
+  std::atomic<std::size_t> next{0};
+  auto worker = [&]()
+  {
+    for (std::size_t i = next++; i < n; i = next++)
+      task(i);
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 3; i++)
+    threads.emplace_back(worker);
+  worker();
+  for (auto& thread : threads)
+    thread.join();
+}
+
+std::string tostr(const TS::TimeSeriesByLocation& result)
+{
+  std::ostringstream out;
+  for (const auto& item : result)
+    out << "fmisid " << item.first << "\n" << *item.second;
+  return out.str();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Split observations by fmisid and add missing timesteps
+ */
+// ----------------------------------------------------------------------
+
+void get_timeseries_by_fmisid()
+{
+  auto obs = std::make_shared<TS::TimeSeriesVector>(3);
+  auto& fmisids = (*obs)[0];
+  auto& values = (*obs)[1];
+
+  // Station 100 is missing the 01:00 observation, station 200 the 00:00 and 02:00 observations
+  fmisids.emplace_back(TS::TimedValue(make_time(0), 100));
+  fmisids.emplace_back(TS::TimedValue(make_time(2), 100));
+  fmisids.emplace_back(TS::TimedValue(make_time(1), 200));
+  values.emplace_back(TS::TimedValue(make_time(0), 1.5));
+  values.emplace_back(TS::TimedValue(make_time(2), 2.5));
+  values.emplace_back(TS::TimedValue(make_time(1), 3.5));
+
+  auto tlist = std::make_shared<TS::TimeSeriesGenerator::LocalTimeList>();
+  for (int hour = 0; hour < 3; hour++)
+    tlist->push_back(make_time(hour));
+
+  auto result = TS::get_timeseries_by_fmisid("test", obs, tlist, 0);
+
+  if (result.size() != 2)
+    TEST_FAILED("Expected 2 stations, got " + Fmi::to_string(result.size()));
+  if (result[0].first != 100 || result[1].first != 200)
+    TEST_FAILED("Incorrect fmisids in result:\n" + tostr(result));
+
+  for (const auto& item : result)
+  {
+    const auto& tsv = *item.second;
+    if (tsv.size() != 3)
+      TEST_FAILED("Expected 3 parameters for each station:\n" + tostr(result));
+    if (tsv[0].size() != 3 || tsv[1].size() != 3)
+      TEST_FAILED("Missing timesteps were not added:\n" + tostr(result));
+    if (!tsv[2].empty())
+      TEST_FAILED("Empty input time series should stay empty:\n" + tostr(result));
+  }
+
+  const auto& station1 = (*result[0].second)[1];
+  const auto& station2 = (*result[1].second)[1];
+  if (station1[0].value != TS::Value(1.5) || station1[1].value != TS::Value(TS::None()) ||
+      station1[2].value != TS::Value(2.5))
+    TEST_FAILED("Incorrect values for station 100:\n" + tostr(result));
+  if (station2[0].value != TS::Value(TS::None()) || station2[1].value != TS::Value(3.5) ||
+      station2[2].value != TS::Value(TS::None()))
+    TEST_FAILED("Incorrect values for station 200:\n" + tostr(result));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Splitting large results with an executor preserves the station order
+ */
+// ----------------------------------------------------------------------
+
+void get_timeseries_by_fmisid_large()
+{
+  const int nstations = 2000;
+  const int nparams = 20;
+  const int nhours = 24;
+
+  auto obs = std::make_shared<TS::TimeSeriesVector>(nparams);
+  for (int station = 0; station < nstations; station++)
+    for (int hour = 0; hour < nhours; hour += 1 + station % 2)
+      for (int param = 0; param < nparams; param++)
+        (*obs)[param].emplace_back(TS::TimedValue(
+            make_time(hour), param == 0 ? TS::Value(station) : TS::Value(param + hour)));
+
+  auto tlist = std::make_shared<TS::TimeSeriesGenerator::LocalTimeList>();
+  for (int hour = 0; hour < nhours; hour++)
+    tlist->push_back(make_time(hour));
+
+  auto result = TS::get_timeseries_by_fmisid("test", obs, tlist, 0, thread_executor);
+  if (tostr(result) != tostr(TS::get_timeseries_by_fmisid("test", obs, tlist, 0)))
+    TEST_FAILED("The executor must not change the result");
+
+  if (result.size() != nstations)
+    TEST_FAILED("Expected " + Fmi::to_string(nstations) + " stations, got " +
+                Fmi::to_string(result.size()));
+
+  for (int station = 0; station < nstations; station++)
+  {
+    if (result[station].first != station)
+      TEST_FAILED("Station order changed at " + Fmi::to_string(station));
+    const auto& tsv = *result[station].second;
+    for (int param = 0; param < nparams; param++)
+    {
+      const auto& ts = tsv[param];
+      if (ts.size() != nhours)
+        TEST_FAILED("Expected " + Fmi::to_string(nhours) + " timesteps for station " +
+                    Fmi::to_string(station));
+      for (int hour = 0; hour < nhours; hour++)
+      {
+        const bool missing = (station % 2 == 1 && hour % 2 == 1);
+        if (ts[hour].time != make_time(hour) ||
+            (missing != (ts[hour].value == TS::Value(TS::None()))))
+          TEST_FAILED("Incorrect value for station " + Fmi::to_string(station) + " at hour " +
+                      Fmi::to_string(hour));
+      }
+    }
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Erase timesteps used for aggregation only
+ */
+// ----------------------------------------------------------------------
+
+void erase_redundant_timesteps()
+{
+  TS::TimeSeriesGenerator::LocalTimeList timesteps{make_time(1), make_time(3), make_time(4)};
+
+  auto make_series = [](int n, int offset)
+  {
+    TS::TimeSeries ts;
+    for (int hour = 0; hour < n; hour++)
+      ts.emplace_back(TS::TimedValue(make_time(hour), "value" + Fmi::to_string(hour + offset)));
+    return ts;
+  };
+
+  // Members with a shared timeline, one with a different timeline and an empty one
+  auto tsv = std::make_shared<TS::TimeSeriesVector>();
+  tsv->push_back(TS::TimeSeries());
+  tsv->push_back(make_series(6, 0));
+  tsv->push_back(make_series(6, 10));
+  tsv->push_back(make_series(4, 20));
+
+  TS::erase_redundant_timesteps(tsv, timesteps);
+
+  std::ostringstream out;
+  out << *tsv;
+
+  const auto& ts1 = (*tsv)[1];
+  const auto& ts3 = (*tsv)[3];
+  if (!(*tsv)[0].empty() || ts1.size() != 3 || (*tsv)[2].size() != 3 || ts3.size() != 2)
+    TEST_FAILED("Incorrect number of remaining timesteps:\n" + out.str());
+  if (ts1[0].time != make_time(1) || ts1[1].time != make_time(3) || ts1[2].time != make_time(4) ||
+      ts1[2].value != TS::Value("value4"))
+    TEST_FAILED("Incorrect remaining timesteps:\n" + out.str());
+  if (ts3[0].value != TS::Value("value21") || ts3[1].value != TS::Value("value23"))
+    TEST_FAILED("Incorrect remaining timesteps in the shorter time series:\n" + out.str());
+
+  // Groups are handled the same way, here by the tasks of an executor
+  const int n = 10000;
+  auto tsg = std::make_shared<TS::TimeSeriesGroup>();
+  for (int i = 0; i < n; i++)
+    tsg->emplace_back(TS::LonLat(i, i), make_series(i == 1 ? 3 : 24, i));
+
+  TS::erase_redundant_timesteps(tsg, timesteps, thread_executor);
+
+  for (int i = 0; i < n; i++)
+  {
+    const auto& ts = (*tsg)[i].timeseries;
+    const std::size_t expected_size = (i == 1 ? 1 : 3);
+    if (ts.size() != expected_size || ts[0].value != TS::Value("value" + Fmi::to_string(i + 1)))
+      TEST_FAILED("Incorrect remaining timesteps in group member " + Fmi::to_string(i));
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Run-length encoded series keep their runs when timesteps are erased
+ */
+// ----------------------------------------------------------------------
+
+void run_length_timeseries()
+{
+  auto times = std::make_shared<TS::LocalTimeList>();
+  for (int hour = 0; hour < 6; hour++)
+    times->push_back(make_time(hour));
+
+  // Encoding merges equal values
+  TS::TimeSeries ts;
+  for (int hour = 0; hour < 6; hour++)
+    ts.emplace_back(TS::TimedValue(make_time(hour), hour < 4 ? TS::Value("a") : TS::Value(1.5)));
+
+  auto rts = std::make_shared<TS::RunLengthTimeSeries>(ts);
+  if (rts->runs().size() != 2 || rts->size() != 6 || rts->value(3) != TS::Value("a") ||
+      rts->value(4) != TS::Value(1.5))
+    TEST_FAILED("Incorrect encoding of a time series");
+
+  std::ostringstream expected;
+  expected << ts;
+  std::ostringstream result;
+  result << rts->expand();
+  if (result.str() != expected.str())
+    TEST_FAILED("Expected\n" + expected.str() + "got\n" + result.str());
+
+  TS::TimeSeriesGenerator::LocalTimeList timesteps{make_time(1), make_time(3), make_time(4)};
+  TS::erase_redundant_timesteps(rts, timesteps);
+  if (rts->size() != 3 || rts->runs().size() != 2 || rts->getTimes() != timesteps ||
+      rts->value(1) != TS::Value("a") || rts->value(2) != TS::Value(1.5))
+    TEST_FAILED("Incorrect remaining timesteps in a run-length encoded series");
+
+  // A constant series shares the timeline and stays constant
+  auto constant = std::make_shared<TS::RunLengthTimeSeries>(TS::Value("Helsinki"), times);
+  TS::erase_redundant_timesteps(constant, timesteps);
+  if (!constant->isConstant() || constant->getTimes() != timesteps || times->size() != 6)
+    TEST_FAILED("Incorrect remaining timesteps in a constant series");
+
+  TS::OutputData data;
+  data.emplace_back("data", std::vector<TS::TimeSeriesData>{rts, constant});
+  if (TS::number_of_elements(data) != 6)
+    TEST_FAILED("Expected 6 elements, got " + Fmi::to_string(TS::number_of_elements(data)));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Values and series are moved, not copied, when given as rvalues
+ */
+// ----------------------------------------------------------------------
+
+void move_timeseries()
+{
+  const std::string name(100, 'x');
+
+  TS::TimeSeries ts;
+  ts.emplace_back(make_time(0), name);
+  TS::TimedValue tv(make_time(1), name);
+  const auto* data = std::get<std::string>(tv.value).data();
+  ts.push_back(std::move(tv));
+  if (std::get<std::string>(ts[1].value).data() != data)
+    TEST_FAILED("push_back did not move the string value");
+
+  data = std::get<std::string>(ts[0].value).data();
+  const auto* values = ts.data();
+  TS::TimeSeries moved(std::move(ts));
+  if (moved.data() != values || moved.size() != 2 || !ts.empty())
+    TEST_FAILED("TimeSeries move construction copied the values");
+
+  TS::TimeSeries assigned;
+  assigned = std::move(moved);
+  if (assigned.data() != values || !moved.empty())
+    TEST_FAILED("TimeSeries move assignment copied the values");
+
+  TS::TimeSeriesGroup group;
+  group.emplace_back(TS::LonLat(25, 60), std::move(assigned));
+  if (group[0].timeseries.data() != values ||
+      std::get<std::string>(group[0].timeseries[0].value).data() != data)
+    TEST_FAILED("LonLatTimeSeries copied the time series");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Snapshots are not modified when timesteps are erased
+ */
+// ----------------------------------------------------------------------
+
+void timeseries_snapshots()
+{
+  TS::TimeSeries ts;
+  for (int hour = 0; hour < 6; hour++)
+    ts.emplace_back(make_time(hour), 1.5 * hour);
+
+  const TS::TimeSeriesGenerator::LocalTimeList timesteps{make_time(1), make_time(3)};
+  const TS::TimeSeriesGenerator::LocalTimeList all_timesteps = ts.getTimes();
+
+  auto snapshot = TS::make_snapshot(ts);
+  auto result = TS::erase_redundant_timesteps(snapshot, timesteps);
+  if (snapshot->size() != 6 || result->size() != 2 || (*result)[1].value != TS::Value(4.5))
+    TEST_FAILED("Erasing timesteps from a snapshot must produce a new snapshot");
+
+  if (TS::erase_redundant_timesteps(snapshot, all_timesteps) != snapshot)
+    TEST_FAILED("The snapshot should be shared when nothing is erased");
+
+  auto tsv = std::make_shared<TS::TimeSeriesVector>();
+  tsv->push_back(ts);
+  tsv->push_back(TS::TimeSeries());
+  tsv->push_back(ts);
+  const auto tsv_snapshot = TS::freeze(std::move(tsv));
+  const auto tsv_result = TS::erase_redundant_timesteps(tsv_snapshot, timesteps);
+  if ((*tsv_snapshot)[0].size() != 6 || (*tsv_result)[0].size() != 2 ||
+      !(*tsv_result)[1].empty() || (*tsv_result)[2].getTimes() != timesteps)
+    TEST_FAILED("Incorrect result for a vector snapshot");
+
+  TS::TimeSeriesGroup tsg;
+  tsg.emplace_back(TS::LonLat(25, 60), ts);
+  const auto tsg_snapshot = TS::make_snapshot(tsg);
+  const auto tsg_result = TS::erase_redundant_timesteps(tsg_snapshot, timesteps);
+  if ((*tsg_snapshot)[0].timeseries.size() != 6 || (*tsg_result)[0].timeseries.size() != 2 ||
+      (*tsg_result)[0].lonlat.lon != 25)
+    TEST_FAILED("Incorrect result for a group snapshot");
+
+  // Copy on write
+  auto copy = TS::thaw(snapshot);
+  copy->clear();
+  if (snapshot->size() != 6)
+    TEST_FAILED("Modifying a thawed copy changed the snapshot");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * The actual test suite
+ */
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test()
+  {
+    TEST(get_timeseries_by_fmisid);
+    TEST(get_timeseries_by_fmisid_large);
+    TEST(erase_redundant_timesteps);
+    TEST(run_length_timeseries);
+    TEST(move_timeseries);
+    TEST(timeseries_snapshots);
+  }
+};
+
+}  // namespace TimeSeriesUtilityTest
+
+//! The main program
+int main()
+{
+  using namespace std;
+  cout << endl << "TimeSeriesUtility tester" << endl << "========================" << endl;
+  TimeSeriesUtilityTest::tests t;
+  return t.run();
+}
+
+// ======================================================================
@@ -0,0 +1,117 @@
+// ======================================================================
+/*!
+ * \brief Compare Value visitation and conversion alternatives
+ *
+ * Usage: ValueBenchmark [cells]
+ */
+// ======================================================================
+
+#include "TimeSeries.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+namespace TS = SmartMet::TimeSeries;
+
+namespace
+{
+std::vector<TS::Value> make_values(std::size_t ncells)
+{
+  std::vector<TS::Value> values;
+  values.reserve(ncells);
+  for (std::size_t i = 0; i < ncells; i++)
+  {
+    if (i % 50 == 0)
+      values.emplace_back(TS::None());
+    else if (i % 10 == 0)
+      values.emplace_back(static_cast<int>(i % 1000));
+    else
+      values.emplace_back(0.1 * (i % 400) - 20);
+  }
+  return values;
+}
+
+// Typical numeric visitor, returns NaN for non-numeric values
+struct NumberVisitor
+{
+  template <typename T>
+  double operator()(const T& /* value */) const
+  {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  double operator()(double value) const { return value; }
+  double operator()(int value) const { return value; }
+};
+
+template <typename F>
+void run(const std::string& name, std::size_t ncells, F&& f)
+{
+  const auto start = std::chrono::steady_clock::now();
+  const double sum = f();
+  const auto end = std::chrono::steady_clock::now();
+  const double seconds = std::chrono::duration<double>(end - start).count();
+  std::cout << std::left << std::setw(20) << name << std::right << std::fixed
+            << std::setprecision(3) << std::setw(8) << seconds << " s" << std::setw(10)
+            << std::setprecision(1) << (ncells / seconds / 1e6) << " Mcells/s"
+            << "  (checksum " << std::setprecision(0) << sum << ")" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  const std::size_t ncells = (argc > 1 ? std::atol(argv[1]) : 10000000);
+
+  std::cout << "Value visitation and conversion, " << ncells << " cells" << std::endl;
+
+  const auto values = make_values(ncells);
+
+  run("dynamic_cast visit",
+      ncells,
+      [&]()
+      {
+        double sum = 0;
+        for (const auto& value : values)
+        {
+          const double d = std::visit(NumberVisitor(), dynamic_cast<const TS::Value_&>(value));
+          if (!std::isnan(d))
+            sum += d;
+        }
+        return sum;
+      });
+
+  run("apply_visitor",
+      ncells,
+      [&]()
+      {
+        double sum = 0;
+        for (const auto& value : values)
+        {
+          const double d = value.apply_visitor(NumberVisitor());
+          if (!std::isnan(d))
+            sum += d;
+        }
+        return sum;
+      });
+
+  run("as_double",
+      ncells,
+      [&]()
+      {
+        double sum = 0;
+        for (const auto& value : values)
+        {
+          if (value.index() != 0)
+            sum += value.as_double();
+        }
+        return sum;
+      });
+
+  return 0;
+}
+
+// ======================================================================
@@ -0,0 +1,317 @@
+#include "AggregationCache.h"
+#include "TimeSeriesAggregator.h"
+#include <macgyver/Exception.h>
+#include <macgyver/Hash.h>
+#include <functional>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+namespace
+{
+// Hash of a single value, the type is included so that 1 and 1.0 differ
+class ValueHasher
+{
+ public:
+  std::size_t operator()(const None& /* none */) const { return 0; }
+  std::size_t operator()(const std::string& value) const { return Fmi::hash_value(value); }
+  std::size_t operator()(double value) const { return std::hash<double>{}(value); }
+  std::size_t operator()(int value) const { return std::hash<int>{}(value); }
+  std::size_t operator()(const LonLat& value) const
+  {
+    std::size_t hash = std::hash<double>{}(value.lon);
+    Fmi::hash_combine(hash, std::hash<double>{}(value.lat));
+    return hash;
+  }
+  std::size_t operator()(const Fmi::LocalDateTime& value) const
+  {
+    if (value.is_not_a_date_time())
+      return 0;
+    std::size_t hash = Fmi::hash_value(value.utc_time());
+    Fmi::hash_combine(hash, Fmi::hash_value(value.zone()));
+    return hash;
+  }
+};
+
+std::size_t fingerprint_into(std::size_t hash, const TimeSeries& ts)
+{
+  Fmi::hash_combine(hash, ts.size());
+  const ValueHasher hasher;
+  for (const auto& tv : ts)
+  {
+    Fmi::hash_combine(hash, hasher(tv.time));
+    Fmi::hash_combine(hash, tv.value.index());
+    Fmi::hash_combine(hash, tv.value.apply_visitor(hasher));
+  }
+  return hash;
+}
+
+// Approximate memory use of the cached data
+std::size_t estimate_bytes(const TimeSeries& ts)
+{
+  std::size_t bytes = sizeof(TimeSeries) + ts.capacity() * sizeof(TimedValue);
+  for (const auto& tv : ts)
+    if (const auto* str = std::get_if<std::string>(&tv.value))
+      bytes += str->capacity();
+  return bytes;
+}
+
+std::size_t estimate_bytes(const TimeSeriesGroup& tsg)
+{
+  std::size_t bytes = sizeof(TimeSeriesGroup) + tsg.capacity() * sizeof(LonLatTimeSeries);
+  for (const auto& llts : tsg)
+    bytes += estimate_bytes(llts.timeseries) - sizeof(TimeSeries);
+  return bytes;
+}
+
+}  // namespace
+
+AggregationCache::AggregationCache(std::size_t theMaxBytes)
+{
+  itsStatistics.maxbytes = theMaxBytes;
+}
+
+std::size_t AggregationCache::KeyHash::operator()(const Key& theKey) const
+{
+  std::size_t hash = Fmi::hash_value(theKey.series);
+  Fmi::hash_combine(hash, theKey.input);
+  Fmi::hash_combine(hash, theKey.timeline);
+  Fmi::hash_combine(hash, theKey.functions.hash_value());
+  return hash;
+}
+
+AggregationCache::Key AggregationCache::makeKey(const std::string& theSeries,
+                                                std::size_t theInput,
+                                                const DataFunctions& theFunctions,
+                                                std::size_t theTimeline)
+{
+  return Key{theSeries, theInput, theFunctions, theTimeline};
+}
+
+std::size_t AggregationCache::fingerprint(const TimeSeries& theSeries)
+{
+  try
+  {
+    return fingerprint_into(0, theSeries);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+std::size_t AggregationCache::fingerprint(const TimeSeriesGroup& theGroup)
+{
+  try
+  {
+    std::size_t hash = theGroup.size();
+    for (const auto& llts : theGroup)
+    {
+      Fmi::hash_combine(hash, std::hash<double>{}(llts.lonlat.lon));
+      Fmi::hash_combine(hash, std::hash<double>{}(llts.lonlat.lat));
+      hash = fingerprint_into(hash, llts.timeseries);
+    }
+    return hash;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+std::size_t AggregationCache::timeline_key(const TimeSeriesGenerator::LocalTimeList& theTimesteps)
+{
+  try
+  {
+    std::size_t hash = theTimesteps.size();
+    for (const auto& t : theTimesteps)
+      Fmi::hash_combine(hash, ValueHasher()(t));
+    return hash;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+const AggregationCache::Result* AggregationCache::lookup(const Key& theKey) const
+{
+  auto it = itsEntries.find(theKey);
+  if (it == itsEntries.end())
+  {
+    ++itsStatistics.misses;
+    return nullptr;
+  }
+  ++itsStatistics.hits;
+  itsLRU.splice(itsLRU.begin(), itsLRU, it->second.lru);
+  return &it->second.result;
+}
+
+TimeSeriesSnapshot AggregationCache::find(const Key& theKey) const
+{
+  try
+  {
+    std::lock_guard<std::mutex> lock(itsMutex);
+    const auto* result = lookup(theKey);
+    if (result == nullptr)
+      return {};
+    if (const auto* ts = std::get_if<TimeSeriesSnapshot>(result))
+      return *ts;
+    return {};
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+TimeSeriesGroupSnapshot AggregationCache::findGroup(const Key& theKey) const
+{
+  try
+  {
+    std::lock_guard<std::mutex> lock(itsMutex);
+    const auto* result = lookup(theKey);
+    if (result == nullptr)
+      return {};
+    if (const auto* tsg = std::get_if<TimeSeriesGroupSnapshot>(result))
+      return *tsg;
+    return {};
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void AggregationCache::store(const Key& theKey, Result theResult, std::size_t theBytes)
+{
+  std::lock_guard<std::mutex> lock(itsMutex);
+
+  auto& stats = itsStatistics;
+  if (theBytes > stats.maxbytes)
+    return;
+
+  auto it = itsEntries.find(theKey);
+  if (it != itsEntries.end())
+  {
+    // Replace the old result, for example a concurrent request aggregated it too
+    stats.bytes -= it->second.bytes;
+    it->second.result = std::move(theResult);
+    it->second.bytes = theBytes;
+    itsLRU.splice(itsLRU.begin(), itsLRU, it->second.lru);
+  }
+  else
+  {
+    itsLRU.push_front(theKey);
+    itsEntries.emplace(theKey, Entry{std::move(theResult), theBytes, itsLRU.begin()});
+  }
+  stats.bytes += theBytes;
+  ++stats.inserts;
+
+  while (stats.bytes > stats.maxbytes)
+  {
+    auto pos = itsEntries.find(itsLRU.back());
+    stats.bytes -= pos->second.bytes;
+    itsEntries.erase(pos);
+    itsLRU.pop_back();
+    ++stats.evictions;
+  }
+  stats.size = itsEntries.size();
+}
+
+void AggregationCache::insert(const Key& theKey, const TimeSeriesSnapshot& theResult)
+{
+  try
+  {
+    if (theResult)
+      store(theKey, theResult, estimate_bytes(*theResult));
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void AggregationCache::insert(const Key& theKey, const TimeSeriesGroupSnapshot& theResult)
+{
+  try
+  {
+    if (theResult)
+      store(theKey, theResult, estimate_bytes(*theResult));
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+TimeSeriesSnapshot AggregationCache::aggregate(
+    const TimeSeries& theSeries,
+    const std::string& theSeriesId,
+    std::size_t theVersion,
+    const DataFunctions& theFunctions,
+    const TimeSeriesGenerator::LocalTimeList& theTimesteps,
+    std::size_t theTimeline)
+{
+  try
+  {
+    const auto input = (theSeriesId.empty() ? fingerprint(theSeries) : theVersion);
+    const auto key = makeKey(theSeriesId, input, theFunctions, theTimeline);
+    if (auto result = find(key))
+      return result;
+
+    auto result = freeze(Aggregator::aggregate(theSeries, theFunctions, theTimesteps));
+    insert(key, result);
+    return result;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+TimeSeriesGroupSnapshot AggregationCache::aggregate(
+    const TimeSeriesGroup& theGroup,
+    const std::string& theSeriesId,
+    std::size_t theVersion,
+    const DataFunctions& theFunctions,
+    const TimeSeriesGenerator::LocalTimeList& theTimesteps,
+    std::size_t theTimeline)
+{
+  try
+  {
+    const auto input = (theSeriesId.empty() ? fingerprint(theGroup) : theVersion);
+    const auto key = makeKey(theSeriesId, input, theFunctions, theTimeline);
+    if (auto result = findGroup(key))
+      return result;
+
+    auto result = freeze(Aggregator::aggregate(theGroup, theFunctions, theTimesteps));
+    insert(key, result);
+    return result;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+AggregationCache::Statistics AggregationCache::statistics() const
+{
+  std::lock_guard<std::mutex> lock(itsMutex);
+  return itsStatistics;
+}
+
+void AggregationCache::clear()
+{
+  std::lock_guard<std::mutex> lock(itsMutex);
+  itsEntries.clear();
+  itsLRU.clear();
+  itsStatistics.size = 0;
+  itsStatistics.bytes = 0;
+}
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
@@ -0,0 +1,135 @@
+// ======================================================================
+/*!
+ * \brief Cache for aggregated time series
+ *
+ * Repeated queries such as dashboards polling the same stations
+ * aggregate the same input with the same functions to the same
+ * timeline. The cache stores the results as immutable snapshots
+ * which concurrent requests can share.
+ *
+ * Results are identified by the input, the aggregation functions and
+ * the timeline. The input is identified by the series, meaning the
+ * producer, the station or location and the parameter, and by a
+ * version number of the data provided by the data source. Versions
+ * alone are not unique since all series of a data source usually share
+ * them. Inputs without a series identity are identified by their
+ * fingerprint instead. The cache is bounded by the estimated memory
+ * use of the results and evicts the least recently used ones first.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "DataFunction.h"
+#include "TimeSeries.h"
+#include "TimeSeriesGenerator.h"
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <variant>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+class AggregationCache
+{
+ public:
+  struct Key
+  {
+    std::string series;        // producer, station or location and parameter
+    std::size_t input = 0;     // version of the series, or fingerprint if the series is empty
+    DataFunctions functions;
+    std::size_t timeline = 0;  // timeline_key() or an equivalent hash
+
+    bool operator==(const Key& other) const
+    {
+      return input == other.input && timeline == other.timeline && series == other.series &&
+             functions == other.functions;
+    }
+  };
+
+  struct Statistics
+  {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t inserts = 0;
+    std::size_t evictions = 0;
+    std::size_t size = 0;      // number of cached results
+    std::size_t bytes = 0;     // estimated memory use of the cached results
+    std::size_t maxbytes = 0;  // memory limit
+  };
+
+  explicit AggregationCache(std::size_t theMaxBytes);
+
+  AggregationCache(const AggregationCache&) = delete;
+  AggregationCache& operator=(const AggregationCache&) = delete;
+
+  static Key makeKey(const std::string& theSeries,
+                     std::size_t theInput,
+                     const DataFunctions& theFunctions,
+                     std::size_t theTimeline);
+
+  // Input fingerprints for data sources without versions. Both times and values count.
+  static std::size_t fingerprint(const TimeSeries& theSeries);
+  static std::size_t fingerprint(const TimeSeriesGroup& theGroup);
+
+  // The timeline key of the aggregation timesteps, compute once and reuse for all inputs
+  static std::size_t timeline_key(const TimeSeriesGenerator::LocalTimeList& theTimesteps);
+
+  // Empty pointers if the result is not cached
+  TimeSeriesSnapshot find(const Key& theKey) const;
+  TimeSeriesGroupSnapshot findGroup(const Key& theKey) const;
+
+  // Results larger than the memory limit are not cached
+  void insert(const Key& theKey, const TimeSeriesSnapshot& theResult);
+  void insert(const Key& theKey, const TimeSeriesGroupSnapshot& theResult);
+
+  // Aggregator::aggregate through the cache. The version is used only with a series identity,
+  // without one the input is fingerprinted.
+  TimeSeriesSnapshot aggregate(const TimeSeries& theSeries,
+                               const std::string& theSeriesId,
+                               std::size_t theVersion,
+                               const DataFunctions& theFunctions,
+                               const TimeSeriesGenerator::LocalTimeList& theTimesteps,
+                               std::size_t theTimeline);
+  TimeSeriesGroupSnapshot aggregate(const TimeSeriesGroup& theGroup,
+                                    const std::string& theSeriesId,
+                                    std::size_t theVersion,
+                                    const DataFunctions& theFunctions,
+                                    const TimeSeriesGenerator::LocalTimeList& theTimesteps,
+                                    std::size_t theTimeline);
+
+  Statistics statistics() const;
+  void clear();
+
+ private:
+  using Result = std::variant<TimeSeriesSnapshot, TimeSeriesGroupSnapshot>;
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& theKey) const;
+  };
+
+  struct Entry
+  {
+    Result result;
+    std::size_t bytes = 0;
+    std::list<Key>::iterator lru;
+  };
+
+  const Result* lookup(const Key& theKey) const;
+  void store(const Key& theKey, Result theResult, std::size_t theBytes);
+
+  mutable std::mutex itsMutex;
+  mutable std::list<Key> itsLRU;  // most recently used first
+  std::unordered_map<Key, Entry, KeyHash> itsEntries;
+  mutable Statistics itsStatistics;
+};
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
@@ -0,0 +1,774 @@
+#include "AggregationKernels.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+namespace Aggregator
+{
+namespace
+{
+constexpr double MODULO_VALUE_360 = 360.0;
+
+// Functions which always use unweighted data in Stat
+constexpr bool ignores_weights(FunctionId id)
+{
+  return (id == FunctionId::Amean || id == FunctionId::Sum || id == FunctionId::Count);
+}
+
+// Functions whose results depend on the order of the values
+constexpr bool order_dependent(FunctionId id, bool degrees)
+{
+  return (id == FunctionId::Change || id == FunctionId::Trend ||
+          (degrees && (id == FunctionId::Mean || id == FunctionId::Amean ||
+                       id == FunctionId::StandardDeviation)));
+}
+
+// Unweighted functions whose results depend on the summation order
+constexpr bool sums_values(FunctionId id)
+{
+  return (id == FunctionId::Mean || id == FunctionId::Amean || id == FunctionId::Sum);
+}
+
+// True if Stat would reorder the data before aggregating it. Stat sorts the data by time
+// unless some time is invalid, and std::sort may reorder equal times.
+bool reordered_by_stat(const Stat::DataVector& data)
+{
+  bool ordered = true;
+  for (std::size_t i = 0; i < data.size(); i++)
+  {
+    if (data[i].time.is_not_a_date_time())
+      return false;
+    if (i > 0 && !(data[i - 1].time < data[i].time))
+      ordered = false;
+  }
+  return !ordered;
+}
+
+// Number of independent lanes in the batched kernels
+constexpr std::size_t lanes = 8;
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Sine and cosine of an angle in degrees
+ *
+ * The angle is reduced exactly to [-45,45] degrees, the polynomials
+ * are accurate to a few ulps there and the quadrant is selected
+ * without branches so that loops calling this can be vectorized.
+ */
+// ----------------------------------------------------------------------
+
+inline void sincos_degrees(double degrees, double& s, double& c)
+{
+  // Round to the nearest quadrant without a call to a rounding function
+  const double magic = 6755399441055744.0;  // 1.5 * 2^52
+  const double q = (degrees * (1.0 / 90.0) + magic) - magic;
+  const double x = (degrees - q * 90.0) * (M_PI / 180.0);
+  const double x2 = x * x;
+
+  const double sp =
+      x + x * x2 *
+              (-1.0 / 6 +
+               x2 * (1.0 / 120 +
+                     x2 * (-1.0 / 5040 +
+                           x2 * (1.0 / 362880 +
+                                 x2 * (-1.0 / 39916800 +
+                                       x2 * (1.0 / 6227020800 +
+                                             x2 * (-1.0 / 1307674368000 +
+                                                   x2 * (1.0 / 355687428096000))))))));
+  const double cp =
+      1.0 + x2 * (-1.0 / 2 +
+                  x2 * (1.0 / 24 +
+                        x2 * (-1.0 / 720 +
+                              x2 * (1.0 / 40320 +
+                                    x2 * (-1.0 / 3628800 +
+                                          x2 * (1.0 / 479001600 +
+                                                x2 * (-1.0 / 87178291200 +
+                                                      x2 * (1.0 / 20922789888000))))))));
+
+  // Quadrants 0-3 rotate (sin,cos) to (s,c), (c,-s), (-s,-c) and (-c,s). The quadrant
+  // is kept in double since integer conversions would prevent vectorization.
+  const double m = q - 4 * ((q * 0.25 - 0.375 + magic) - magic);
+  const bool odd = (m == 1.0) | (m == 3.0);
+  const double a = (odd ? cp : sp);
+  const double b = (odd ? sp : cp);
+  s = (m >= 2.0 ? -a : a);
+  c = ((m == 1.0) | (m == 2.0) ? -b : b);
+}
+
+struct DirectionSums
+{
+  double x = 0;  // sum of cosines
+  double y = 0;  // sum of sines
+  double weights = 0;
+  bool missing = false;
+};
+
+// Weights may be nullptr for unweighted sums
+template <typename T>
+DirectionSums direction_sums(const T* directions,
+                             const double* weights,
+                             std::size_t n,
+                             double missingValue)
+{
+  std::array<double, lanes> xs{};
+  std::array<double, lanes> ys{};
+  std::array<double, lanes> ws{};
+  std::array<double, lanes> ss;
+  std::array<double, lanes> cs;
+  std::array<double, lanes> found{};
+
+  std::size_t i = 0;
+  for (; i + lanes <= n; i += lanes)
+  {
+    for (std::size_t j = 0; j < lanes; j++)
+    {
+      const double value = directions[i + j];
+      found[j] = (value == missingValue ? 1.0 : found[j]);
+      sincos_degrees(value, ss[j], cs[j]);
+    }
+    if (weights == nullptr)
+    {
+      for (std::size_t j = 0; j < lanes; j++)
+      {
+        xs[j] += cs[j];
+        ys[j] += ss[j];
+        ws[j] += 1.0;
+      }
+    }
+    else
+    {
+      for (std::size_t j = 0; j < lanes; j++)
+      {
+        const double w = weights[i + j];
+        xs[j] += w * cs[j];
+        ys[j] += w * ss[j];
+        ws[j] += w;
+      }
+    }
+  }
+
+  // The remainder goes to the first lane
+  for (; i < n; i++)
+  {
+    const double value = directions[i];
+    const double w = (weights != nullptr ? weights[i] : 1.0);
+    found[0] = (value == missingValue ? 1.0 : found[0]);
+    sincos_degrees(value, ss[0], cs[0]);
+    xs[0] += w * cs[0];
+    ys[0] += w * ss[0];
+    ws[0] += w;
+  }
+
+  DirectionSums sums;
+  for (std::size_t j = 0; j < lanes; j++)
+  {
+    sums.x += xs[j];
+    sums.y += ys[j];
+    sums.weights += ws[j];
+    sums.missing |= (found[j] != 0);
+  }
+  return sums;
+}
+
+// The circular mean as in Stat::circlemean
+double circle_mean(double xsum, double ysum, double count, double missingValue)
+{
+  // The mean is unreliable when the unit circle mean radius becomes small
+  const double bad_variance_radius_limit = 0.5;
+  const auto xmean = xsum / count;
+  const auto ymean = ysum / count;
+  const auto r = std::sqrt(xmean * xmean + ymean * ymean);
+  if (r < bad_variance_radius_limit)
+    return missingValue;
+  auto deg = atan2(ymean, xmean) * 180 / M_PI;
+  if (deg < 0)
+    deg += 360;
+  return deg;
+}
+
+template <typename T>
+double circular_mean_impl(const T* directions,
+                          const double* weights,
+                          std::size_t n,
+                          double missingValue)
+{
+  if (n == 0)
+    return missingValue;
+  const auto sums = direction_sums(directions, weights, n, missingValue);
+  if (sums.missing || sums.weights <= 0)
+    return missingValue;
+  return circle_mean(sums.x, sums.y, sums.weights, missingValue);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Accumulates the values Stat would extract from the window
+ *
+ * The values are passed in the same order and with the same weights as
+ * in the subvectors built by Stat so that the results match exactly.
+ */
+// ----------------------------------------------------------------------
+
+template <FunctionId Id, bool Degrees>
+class Accumulator
+{
+ public:
+  explicit Accumulator(const DataFunction& func)
+      : itsLowerLimit(func.lowerLimit()), itsUpperLimit(func.upperLimit())
+  {
+  }
+
+  void operator()(double value, double weight)
+  {
+    if constexpr (Id == FunctionId::Mean || Id == FunctionId::Amean)
+    {
+      if constexpr (Degrees)
+        unwrap(value);
+      else
+      {
+        itsSum += value * weight;
+        itsWeights += weight;
+      }
+    }
+    else if constexpr (Id == FunctionId::StandardDeviation)
+    {
+      // Mitsuta algorithm, see Stat::stddev_dir
+      double dir = value;
+      if (itsCount > 0)
+      {
+        const double diff = value - itsPrevious;
+        dir = itsPrevious + diff;
+        if (diff < -MODULO_VALUE_360 / 2.0)
+        {
+          while (dir < MODULO_VALUE_360 / 2.0)
+            dir += MODULO_VALUE_360;
+        }
+        else if (diff > MODULO_VALUE_360 / 2.0)
+        {
+          while (dir > MODULO_VALUE_360 / 2.0)
+            dir -= MODULO_VALUE_360;
+        }
+      }
+      itsSum += dir;
+      itsSquaredSum += dir * dir;
+      itsPrevious = dir;
+    }
+    else if constexpr (Id == FunctionId::Maximum)
+    {
+      if (itsCount == 0 || value > itsPrevious)
+        itsPrevious = value;
+    }
+    else if constexpr (Id == FunctionId::Minimum)
+    {
+      if (itsCount == 0 || value < itsPrevious)
+        itsPrevious = value;
+    }
+    else if constexpr (Id == FunctionId::Sum || Id == FunctionId::Integ)
+    {
+      itsSum += value * weight;
+    }
+    else if constexpr (Id == FunctionId::Count)
+    {
+      if (value >= itsLowerLimit && value <= itsUpperLimit)
+        ++itsOccurrences;
+    }
+    else if constexpr (Id == FunctionId::Percentage)
+    {
+      // Stat accumulates the weights as integers
+      if (value >= itsLowerLimit && value <= itsUpperLimit)
+        itsOccurrences += weight;
+      itsTotal += weight;
+    }
+    else if constexpr (Id == FunctionId::Change)
+    {
+      if constexpr (Degrees)
+      {
+        if (itsCount > 0)
+        {
+          const double diff = value - itsPrevious;
+          if (diff < -MODULO_VALUE_360 / 2.0)
+            itsSum += diff + MODULO_VALUE_360;
+          else if (diff > MODULO_VALUE_360 / 2.0)
+            itsSum += diff - MODULO_VALUE_360;
+          else
+            itsSum += diff;
+        }
+      }
+      else if (itsCount == 0)
+        itsFirst = value;
+      itsPrevious = value;
+    }
+    else if constexpr (Id == FunctionId::Trend)
+    {
+      if (itsCount > 0)
+      {
+        const double diff = value - itsPrevious;
+        if constexpr (Degrees)
+        {
+          if (diff < -MODULO_VALUE_360 / 2.0)
+            ++itsOccurrences;
+          else if (diff > MODULO_VALUE_360 / 2.0)
+            --itsOccurrences;
+          else if (diff < 0)
+            --itsOccurrences;
+          else if (diff > 0)
+            ++itsOccurrences;
+        }
+        else
+        {
+          if (diff > 0)
+            ++itsOccurrences;
+          else if (diff < 0)
+            --itsOccurrences;
+        }
+      }
+      itsPrevious = value;
+    }
+    ++itsCount;
+  }
+
+  double result(double missingValue) const
+  {
+    if constexpr (Id == FunctionId::Mean || Id == FunctionId::Amean)
+    {
+      if constexpr (Degrees)
+      {
+        double mean = itsSum / itsCount;
+        mean -= (MODULO_VALUE_360 * floor(mean / MODULO_VALUE_360));
+        return mean;
+      }
+      else
+        return itsSum / itsWeights;
+    }
+    else if constexpr (Id == FunctionId::StandardDeviation)
+    {
+      const double tmp = itsSquaredSum - itsSum * itsSum / itsCount;
+      if (tmp < 0 || itsCount < 2)
+        return 0.0;
+      return sqrt(tmp / (itsCount - 1));
+    }
+    else if constexpr (Id == FunctionId::Maximum || Id == FunctionId::Minimum)
+    {
+      return itsPrevious;
+    }
+    else if constexpr (Id == FunctionId::Sum)
+    {
+      if constexpr (Degrees)
+        return fmod(itsSum, MODULO_VALUE_360);
+      else
+        return itsSum;
+    }
+    else if constexpr (Id == FunctionId::Integ)
+    {
+      if constexpr (Degrees)
+        return fmod(itsSum, MODULO_VALUE_360) / 3600.0;
+      else
+        return itsSum / 3600.0;
+    }
+    else if constexpr (Id == FunctionId::Count)
+    {
+      return static_cast<unsigned int>(itsOccurrences);
+    }
+    else if constexpr (Id == FunctionId::Percentage)
+    {
+      if (itsTotal == 0)
+        return missingValue;
+      if (itsOccurrences == 0)
+        return 0.0;
+      return 100.0 * itsOccurrences / itsTotal;
+    }
+    else if constexpr (Id == FunctionId::Change)
+    {
+      if constexpr (Degrees)
+        return itsSum;
+      else
+        return itsPrevious - itsFirst;
+    }
+    else if constexpr (Id == FunctionId::Trend)
+    {
+      if (itsCount <= 1)
+        return missingValue;
+      return static_cast<double>(itsOccurrences) / static_cast<double>(itsCount - 1) * 100.0;
+    }
+  }
+
+ private:
+  // Direction unwrapping of Stat::mean
+  void unwrap(double value)
+  {
+    double direction = value;
+    if (itsCount > 0)
+    {
+      const double diff = value - itsPrevious;
+      direction = itsPrevious + diff;
+      if (diff < -MODULO_VALUE_360 / 2.0)
+        direction += MODULO_VALUE_360;
+      else if (diff > MODULO_VALUE_360 / 2.0)
+        direction -= MODULO_VALUE_360;
+    }
+    itsSum += direction;
+    itsPrevious = direction;
+  }
+
+  double itsLowerLimit;
+  double itsUpperLimit;
+  double itsSum = 0;
+  double itsSquaredSum = 0;
+  double itsWeights = 0;
+  double itsFirst = 0;
+  double itsPrevious = 0;
+  long itsOccurrences = 0;
+  long itsTotal = 0;
+  std::size_t itsCount = 0;
+};
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Circular mean of a window from batched direction sums
+ *
+ * Stat::circlemean ignores the weights, but in weighted mode the
+ * subvector contains the inner values twice. The data must have been
+ * validated for weighted use.
+ */
+// ----------------------------------------------------------------------
+
+template <bool Weighted>
+double run_circle_mean(const Stat::DataVector& data, double missingValue)
+{
+  thread_local std::vector<double> directions;
+  directions.clear();
+  directions.reserve(data.size());
+  for (const auto& item : data)
+    directions.push_back(item.value);
+
+  const std::size_t n = directions.size();
+  auto sums = direction_sums(directions.data(), nullptr, n, missingValue);
+
+  if constexpr (Weighted)
+  {
+    if (n > 1)
+    {
+      double s1 = 0;
+      double c1 = 0;
+      double s2 = 0;
+      double c2 = 0;
+      sincos_degrees(directions.front(), s1, c1);
+      sincos_degrees(directions.back(), s2, c2);
+      sums.x = 2 * sums.x - c1 - c2;
+      sums.y = 2 * sums.y - s1 - s2;
+      sums.weights = 2.0 * (n - 1);
+    }
+  }
+
+  return circle_mean(sums.x, sums.y, sums.weights, missingValue);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Feed the window to an accumulator the way Stat extracts it
+ *
+ * Unweighted data is used as is. Weighted data is split at the
+ * midpoints between the timesteps, and the values on both sides of
+ * each interval are weighted by the whole seconds they cover.
+ */
+// ----------------------------------------------------------------------
+
+template <FunctionId Id, bool Weighted, bool Degrees>
+double run_accumulator(const Stat::DataVector& data, const DataFunction& func, double missingValue)
+{
+  const std::size_t n = data.size();
+  Accumulator<Id, Degrees> acc(func);
+
+  if (n == 1)
+  {
+    acc(data[0].value, 1.0);
+    return acc.result(missingValue);
+  }
+
+  if constexpr (Weighted)
+  {
+    for (std::size_t i = 1; i < n; i++)
+    {
+      const auto seconds =
+          ((data[i].time + Fmi::Microseconds(1)) - data[i - 1].time).total_seconds();
+      const auto half = seconds / 2;
+      acc(data[i - 1].value, static_cast<double>(half));
+      acc(data[i].value, static_cast<double>(seconds - half));
+    }
+  }
+  else
+  {
+    for (const auto& item : data)
+      acc(item.value, 1.0);
+  }
+
+  return acc.result(missingValue);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Aggregate a window, or return false if Stat must handle it
+ */
+// ----------------------------------------------------------------------
+
+template <FunctionId Id, bool Weighted, bool Degrees>
+bool run_kernel(const Stat::DataVector& data,
+                const DataFunction& func,
+                double missingValue,
+                double& result)
+{
+  const std::size_t n = data.size();
+  if (n == 0)
+    return false;
+
+  for (const auto& item : data)
+    if (item.value == missingValue)
+    {
+      result = missingValue;
+      return true;
+    }
+
+  if constexpr (Weighted || order_dependent(Id, Degrees))
+  {
+    // Stat sorts the data and skips intervals shorter than a second
+    for (std::size_t i = 1; i < n; i++)
+      if (data[i - 1].time.is_not_a_date_time() || data[i].time.is_not_a_date_time() ||
+          ((data[i].time + Fmi::Microseconds(1)) - data[i - 1].time).total_seconds() < 1)
+        return false;
+  }
+  else if constexpr (sums_values(Id))
+  {
+    // Sum in the order of Stat, which sorts its copy of the data with std::sort. The sort is
+    // not stable, so equal times are ordered exactly as Stat orders them only by sorting
+    // the same sequence the same way.
+    if (reordered_by_stat(data))
+    {
+      auto sorted = data;
+      std::sort(sorted.begin(),
+                sorted.end(),
+                [](const Stat::DataItem& a, const Stat::DataItem& b) { return a.time < b.time; });
+      result = run_accumulator<Id, Weighted, Degrees>(sorted, func, missingValue);
+      return true;
+    }
+  }
+
+  if constexpr (Id == FunctionId::CircleMean)
+    result = run_circle_mean<Weighted>(data, missingValue);
+  else
+    result = run_accumulator<Id, Weighted, Degrees>(data, func, missingValue);
+  return true;
+}
+
+constexpr std::size_t function_count = static_cast<std::size_t>(FunctionId::NullFunction) + 1;
+
+using KernelTable = std::array<std::array<std::array<Kernel, 2>, 2>, function_count>;
+
+template <FunctionId Id, bool Degrees>
+Kernel make_kernel(bool weighted)
+{
+  if constexpr (ignores_weights(Id))
+    return &run_kernel<Id, false, Degrees>;
+  else if (weighted)
+    return &run_kernel<Id, true, Degrees>;
+  else if constexpr (Id == FunctionId::Integ)
+    return nullptr;  // Stat integrates unweighted data with its own weights
+  else
+    return &run_kernel<Id, false, Degrees>;
+}
+
+template <FunctionId Id>
+void add_kernels(KernelTable& table)
+{
+  auto& row = table[static_cast<std::size_t>(Id)];
+  row[0][0] = make_kernel<Id, false>(false);
+  row[1][0] = make_kernel<Id, false>(true);
+  row[0][1] = make_kernel<Id, true>(false);
+  row[1][1] = make_kernel<Id, true>(true);
+}
+
+// Indexed by function, weighting and degrees. Median, the interpolators and the
+// ordinary standard deviation have no kernels.
+KernelTable make_kernel_table()
+{
+  KernelTable table{};
+  add_kernels<FunctionId::Mean>(table);
+  add_kernels<FunctionId::Amean>(table);
+  add_kernels<FunctionId::CircleMean>(table);
+  add_kernels<FunctionId::Maximum>(table);
+  add_kernels<FunctionId::Minimum>(table);
+  add_kernels<FunctionId::Sum>(table);
+  add_kernels<FunctionId::Integ>(table);
+  add_kernels<FunctionId::Count>(table);
+  add_kernels<FunctionId::Percentage>(table);
+  add_kernels<FunctionId::Change>(table);
+  add_kernels<FunctionId::Trend>(table);
+
+  auto& stddev = table[static_cast<std::size_t>(FunctionId::StandardDeviation)];
+  stddev[0][1] = &run_kernel<FunctionId::StandardDeviation, false, true>;
+  stddev[1][1] = &run_kernel<FunctionId::StandardDeviation, true, true>;
+  return table;
+}
+
+const KernelTable kernel_table = make_kernel_table();
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Unweighted statistics of a float32 column
+ *
+ * Missing values are detected in the same pass. Comparisons are done
+ * in single precision, which is exact, while sums and limits use double
+ * precision as in Stat.
+ */
+// ----------------------------------------------------------------------
+
+template <FunctionId Id, bool Degrees>
+double run_float_kernel(const float* values,
+                        std::size_t n,
+                        const DataFunction& func,
+                        double missingValue)
+{
+  if (n == 0)
+    return missingValue;
+
+  // A missing value not representable as a float can never match
+  const auto missing = static_cast<float>(missingValue);
+  const bool check_missing = (static_cast<double>(missing) == missingValue);
+
+  std::array<double, lanes> sums{};
+  std::array<float, lanes> extremes;
+  extremes.fill(values[0]);
+  std::array<int, lanes> found{};
+  const double lo = func.lowerLimit();
+  const double hi = func.upperLimit();
+
+  std::size_t i = 0;
+  for (; i + lanes <= n; i += lanes)
+  {
+    for (std::size_t j = 0; j < lanes; j++)
+    {
+      const float value = values[i + j];
+      found[j] |= (check_missing && value == missing);
+      if constexpr (Id == FunctionId::Maximum)
+        extremes[j] = std::max(extremes[j], value);
+      else if constexpr (Id == FunctionId::Minimum)
+        extremes[j] = std::min(extremes[j], value);
+      else if constexpr (Id == FunctionId::Count)
+        sums[j] += ((value >= lo) & (value <= hi));
+      else
+        sums[j] += value;
+    }
+  }
+
+  // The remainder goes to the first lane
+  for (; i < n; i++)
+  {
+    const float value = values[i];
+    found[0] |= (check_missing && value == missing);
+    if constexpr (Id == FunctionId::Maximum)
+      extremes[0] = std::max(extremes[0], value);
+    else if constexpr (Id == FunctionId::Minimum)
+      extremes[0] = std::min(extremes[0], value);
+    else if constexpr (Id == FunctionId::Count)
+      sums[0] += ((value >= lo) & (value <= hi));
+    else
+      sums[0] += value;
+  }
+
+  for (std::size_t j = 0; j < lanes; j++)
+    if (found[j])
+      return missingValue;
+
+  if constexpr (Id == FunctionId::Maximum)
+    return *std::max_element(extremes.begin(), extremes.end());
+  else if constexpr (Id == FunctionId::Minimum)
+    return *std::min_element(extremes.begin(), extremes.end());
+  else
+  {
+    double sum = 0;
+    for (std::size_t j = 0; j < lanes; j++)
+      sum += sums[j];
+
+    if constexpr (Id == FunctionId::Sum)
+      return (Degrees ? fmod(sum, MODULO_VALUE_360) : sum);
+    else if constexpr (Id == FunctionId::Mean || Id == FunctionId::Amean)
+      return sum / n;
+    else
+      return sum;
+  }
+}
+
+template <FunctionId Id>
+FloatKernel make_float_kernel(bool degrees)
+{
+  // Direction means need the values in order
+  if constexpr (Id == FunctionId::Mean || Id == FunctionId::Amean)
+    return (degrees ? nullptr : &run_float_kernel<Id, false>);
+  else if constexpr (Id == FunctionId::Sum)
+    return (degrees ? &run_float_kernel<Id, true> : &run_float_kernel<Id, false>);
+  else
+    return &run_float_kernel<Id, false>;
+}
+
+}  // namespace
+
+Kernel select_kernel(const DataFunction& func, bool useWeights)
+{
+  const auto index = static_cast<std::size_t>(func.id());
+  if (index >= function_count)
+    return nullptr;
+  return kernel_table[index][useWeights ? 1 : 0][func.isDirFunction() ? 1 : 0];
+}
+
+double circular_mean(const double* directions, std::size_t n, double missingValue)
+{
+  return circular_mean_impl(directions, nullptr, n, missingValue);
+}
+
+double circular_mean(const float* directions, std::size_t n, double missingValue)
+{
+  return circular_mean_impl(directions, nullptr, n, missingValue);
+}
+
+double circular_mean(const double* directions,
+                     const double* weights,
+                     std::size_t n,
+                     double missingValue)
+{
+  return circular_mean_impl(directions, weights, n, missingValue);
+}
+
+FloatKernel select_float_kernel(const DataFunction& func)
+{
+  const bool degrees = func.isDirFunction();
+  switch (func.id())
+  {
+    case FunctionId::Mean:
+      return make_float_kernel<FunctionId::Mean>(degrees);
+    case FunctionId::Amean:
+      return make_float_kernel<FunctionId::Amean>(degrees);
+    case FunctionId::Maximum:
+      return make_float_kernel<FunctionId::Maximum>(degrees);
+    case FunctionId::Minimum:
+      return make_float_kernel<FunctionId::Minimum>(degrees);
+    case FunctionId::Sum:
+      return make_float_kernel<FunctionId::Sum>(degrees);
+    case FunctionId::Count:
+      return make_float_kernel<FunctionId::Count>(degrees);
+    case FunctionId::CircleMean:
+      return [](const float* values, std::size_t n, const DataFunction&, double missingValue)
+      { return circular_mean(values, n, missingValue); };
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace Aggregator
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
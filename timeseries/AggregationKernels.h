@@ -0,0 +1,67 @@
+// ======================================================================
+/*!
+ * \brief Specialized kernels for aggregating numeric windows
+ *
+ * The kernels are instantiated per function, weighting and degree
+ * handling, and are selected once per aggregation instead of once per
+ * window. They compute the same results as the corresponding Stat
+ * methods without copying the window into a Stat object, sorting it
+ * and extracting weighted subvectors from it. Circular means use
+ * batched sines and cosines and agree with Stat up to rounding.
+ *
+ * Unweighted sums over unordered or equal times are accumulated in the
+ * order Stat sorts the values to, so that they round identically.
+ *
+ * Stat remains the reference implementation. Functions without a
+ * kernel, and windows a kernel cannot handle identically, for example
+ * weighted ones with unordered or duplicate times, are left to it.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "DataFunction.h"
+#include "Stat.h"
+#include <cstddef>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+namespace Aggregator
+{
+// Returns false if the data must be aggregated with the reference implementation
+using Kernel = bool (*)(const Stat::DataVector& data,
+                        const DataFunction& func,
+                        double missingValue,
+                        double& result);
+
+// Returns nullptr if the function has no kernel
+Kernel select_kernel(const DataFunction& func, bool useWeights);
+
+// Unweighted kernels for float32 columns such as querydata values over an area.
+// The values are processed in independent lanes which the compiler can vectorize,
+// sums are accumulated in double. As in Stat, a missing value makes the result missing.
+using FloatKernel = double (*)(const float* values,
+                               std::size_t n,
+                               const DataFunction& func,
+                               double missingValue);
+
+// Mean, Amean, CircleMean, Maximum, Minimum, Sum and Count, nullptr for other functions
+FloatKernel select_float_kernel(const DataFunction& func);
+
+// Circular means of directions in degrees. The sines and cosines are evaluated in
+// vectorizable batches. As in Stat::circlemean the result is missing if the mean
+// resultant length is below 0.5, and so it is if any direction is missing.
+double circular_mean(const double* directions, std::size_t n, double missingValue);
+double circular_mean(const float* directions, std::size_t n, double missingValue);
+double circular_mean(const double* directions,
+                     const double* weights,
+                     std::size_t n,
+                     double missingValue);
+
+}  // namespace Aggregator
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
@@ -0,0 +1,878 @@
+#include "ArrowWriter.h"
+#include <macgyver/Exception.h>
+#include <macgyver/StringConversion.h>
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <unistd.h>
+#include <variant>
+
+// The message layout follows the Arrow columnar format specification
+// (format/Message.fbs and format/Schema.fbs, metadata version V5):
+//
+//   stream:  schema message, record batch messages, end-of-stream marker
+//   message: 0xFFFFFFFF, int32 metadata size, flatbuffer Message, body
+//
+// The flatbuffers are built back to front just like the flatbuffers library does it.
+// All numbers are written in the native byte order, which Arrow requires to be declared
+// in the schema. Only little endian is supported.
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "ArrowWriter supports only little endian hosts"
+#endif
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+namespace
+{
+const Fmi::DateTime epoch(Fmi::Date(1970, 1, 1));
+
+// flatbuffer enum values from the Arrow schema
+const std::int16_t metadata_version_v5 = 4;
+const std::uint8_t header_schema = 1;
+const std::uint8_t header_record_batch = 3;
+const std::uint8_t type_int = 2;
+const std::uint8_t type_floating_point = 3;
+const std::uint8_t type_utf8 = 5;
+const std::uint8_t type_timestamp = 10;
+const std::int16_t precision_double = 2;
+const std::int16_t timeunit_microsecond = 2;
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Minimal flatbuffer builder for the Arrow metadata
+ *
+ * Objects are prepended to the buffer, and an object is referred to by
+ * its distance from the end of the buffer. Bytes are stored in reverse
+ * order so that prepending is cheap.
+ */
+// ----------------------------------------------------------------------
+
+class FlatBufferBuilder
+{
+ public:
+  using Offset = std::uint32_t;
+
+  std::uint32_t size() const { return static_cast<std::uint32_t>(itsBytes.size()); }
+
+  template <typename T>
+  Offset push(T value)
+  {
+    align(sizeof(T), sizeof(T));
+    prepend_scalar(value);
+    return size();
+  }
+
+  Offset push_offset(Offset target)
+  {
+    align(4, 4);
+    prepend_scalar<std::uint32_t>(size() + 4 - target);
+    return size();
+  }
+
+  Offset create_string(const std::string& str)
+  {
+    align(str.size() + 1, 4);
+    itsBytes.push_back(0);
+    itsBytes.insert(itsBytes.end(), str.rbegin(), str.rend());
+    return push(static_cast<std::uint32_t>(str.size()));
+  }
+
+  Offset create_vector(const std::vector<Offset>& offsets)
+  {
+    align(offsets.size() * 4, 4);
+    for (auto it = offsets.rbegin(); it != offsets.rend(); ++it)
+      push_offset(*it);
+    return push(static_cast<std::uint32_t>(offsets.size()));
+  }
+
+  // Vector of structs with two 64-bit members (FieldNode and Buffer)
+  Offset create_vector(const std::vector<std::pair<std::int64_t, std::int64_t>>& pairs)
+  {
+    align(pairs.size() * 16, 8);
+    for (auto it = pairs.rbegin(); it != pairs.rend(); ++it)
+    {
+      prepend_scalar(it->second);
+      prepend_scalar(it->first);
+    }
+    return push(static_cast<std::uint32_t>(pairs.size()));
+  }
+
+  void start_table()
+  {
+    itsFields.clear();
+    itsTableStart = size();
+  }
+
+  template <typename T>
+  void add_field(std::uint16_t id, T value)
+  {
+    itsFields.emplace_back(id, push(value));
+  }
+
+  void add_offset(std::uint16_t id, Offset target)
+  {
+    itsFields.emplace_back(id, push_offset(target));
+  }
+
+  Offset end_table()
+  {
+    // Placeholder for the offset to the vtable
+    const Offset table = push<std::int32_t>(0);
+
+    std::uint16_t nfields = 0;
+    for (const auto& field : itsFields)
+      nfields = std::max<std::uint16_t>(nfields, field.first + 1);
+
+    std::vector<std::uint16_t> entries(nfields, 0);
+    for (const auto& field : itsFields)
+      entries[field.first] = static_cast<std::uint16_t>(table - field.second);
+
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+      prepend_scalar(*it);
+    prepend_scalar(static_cast<std::uint16_t>(table - itsTableStart));
+    prepend_scalar(static_cast<std::uint16_t>(4 + 2 * nfields));
+    const Offset vtable = size();
+
+    // The vtable precedes the table
+    const std::int32_t soffset = static_cast<std::int32_t>(vtable - table);
+    for (std::size_t i = 0; i < 4; i++)
+      itsBytes[table - 1 - i] = static_cast<std::uint8_t>(soffset >> (8 * i));
+
+    return table;
+  }
+
+  std::string finish(Offset root)
+  {
+    align(4, 8);
+    push_offset(root);
+    return std::string(itsBytes.rbegin(), itsBytes.rend());
+  }
+
+ private:
+  template <typename T>
+  void prepend_scalar(T value)
+  {
+    using U = std::make_unsigned_t<T>;
+    U bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    for (std::size_t i = sizeof(T); i > 0; i--)
+      itsBytes.push_back(static_cast<std::uint8_t>(bits >> (8 * (i - 1))));
+  }
+
+  void prepend_scalar(double value)
+  {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    prepend_scalar(bits);
+  }
+
+  // Pad so that the size is a multiple of the alignment after len more bytes have been added
+  void align(std::size_t len, std::size_t alignment)
+  {
+    const std::size_t padding = (alignment - (itsBytes.size() + len) % alignment) % alignment;
+    itsBytes.insert(itsBytes.end(), padding, 0);
+  }
+
+  std::vector<std::uint8_t> itsBytes;
+  std::vector<std::pair<std::uint16_t, Offset>> itsFields;
+  Offset itsTableStart = 0;
+};
+
+enum class ColumnType
+{
+  Int32,
+  Float64,
+  Timestamp,
+  Utf8
+};
+
+// One data column of an OutputData element
+struct Column
+{
+  TimedValueView series;
+  std::vector<TimedValueView> group;  // set only for several locations
+
+  std::size_t size() const { return group.empty() ? series.size() : group.front().size(); }
+};
+
+// Collects the columns of heap or pmr allocated data. Run-length encoded series are
+// expanded into the given storage, since the columns are written out value by value anyway.
+class ColumnCollector
+{
+ public:
+  ColumnCollector(std::vector<Column>& columns, std::deque<TimeSeries>& expanded)
+      : itsColumns(columns), itsExpanded(expanded)
+  {
+  }
+
+  template <typename Ptr>
+  void operator()(const Ptr& ptr) const
+  {
+    add(ptr.get());
+  }
+
+ private:
+  void add(const TimeSeries* ts) const { add_series(ts); }
+  void add(const pmr::TimeSeries* ts) const { add_series(ts); }
+  void add(const TimeSeriesVector* tsv) const { add_vector(tsv); }
+  void add(const pmr::TimeSeriesVector* tsv) const { add_vector(tsv); }
+  void add(const TimeSeriesGroup* tsg) const { add_group(tsg); }
+  void add(const pmr::TimeSeriesGroup* tsg) const { add_group(tsg); }
+
+  void add(const RunLengthTimeSeries* rts) const
+  {
+    if (rts == nullptr)
+      return add_series(static_cast<const TimeSeries*>(nullptr));
+    itsExpanded.push_back(rts->expand());
+    add_series(&itsExpanded.back());
+  }
+
+  template <typename Series>
+  void add_series(const Series* ts) const
+  {
+    itsColumns.emplace_back();
+    if (ts != nullptr)
+      itsColumns.back().series = *ts;
+  }
+
+  template <typename Vector>
+  void add_vector(const Vector* tsv) const
+  {
+    if (tsv != nullptr)
+      for (const auto& ts : *tsv)
+        add_series(&ts);
+  }
+
+  template <typename Group>
+  void add_group(const Group* tsg) const
+  {
+    if (tsg == nullptr || tsg->empty())
+      itsColumns.emplace_back();
+    else if (tsg->size() == 1)
+      add_series(&tsg->front().timeseries);
+    else
+    {
+      Column column;
+      for (const auto& lts : *tsg)
+        column.group.emplace_back(lts.timeseries);
+      itsColumns.push_back(std::move(column));
+    }
+  }
+
+  std::vector<Column>& itsColumns;
+  std::deque<TimeSeries>& itsExpanded;
+};
+
+template <typename Data>
+std::vector<Column> get_columns(const std::vector<Data>& data, std::deque<TimeSeries>& expanded)
+{
+  std::vector<Column> columns;
+  ColumnCollector collector(columns, expanded);
+  for (const auto& tsdata : data)
+    std::visit(collector, tsdata);
+  return columns;
+}
+
+// Value types seen in a column
+struct ColumnInfo
+{
+  bool has_int = false;
+  bool has_double = false;
+  bool has_time = false;
+  bool has_other = false;
+
+  void add(const Value& value)
+  {
+    if (std::holds_alternative<int>(value))
+      has_int = true;
+    else if (std::holds_alternative<double>(value))
+      has_double = true;
+    else if (std::holds_alternative<Fmi::LocalDateTime>(value))
+      has_time = true;
+    else if (!std::holds_alternative<None>(value))
+      has_other = true;
+  }
+
+  ColumnType type() const
+  {
+    if (has_other || (has_time && (has_int || has_double)))
+      return ColumnType::Utf8;
+    if (has_time)
+      return ColumnType::Timestamp;
+    if (has_int && !has_double)
+      return ColumnType::Int32;
+    return ColumnType::Float64;
+  }
+};
+
+std::int64_t epoch_microseconds(const Fmi::LocalDateTime& ldt)
+{
+  return (ldt.utc_time() - epoch).total_microseconds();
+}
+
+// Text for values in utf8 columns, numbers use the shortest exact representation. Missing
+// values are nulls, but inside group cells they are written as the missing text.
+class TextAppender
+{
+ public:
+  TextAppender(std::string& output, const std::string& missingtext)
+      : itsOutput(output), itsMissingText(missingtext)
+  {
+  }
+
+  void operator()(const None& /* none */) const { itsOutput += itsMissingText; }
+  void operator()(const std::string& str) const { itsOutput += str; }
+  void operator()(double d) const { append_number(d); }
+  void operator()(int i) const { append_number(i); }
+  void operator()(const LonLat& lonlat) const
+  {
+    append_number(lonlat.lon);
+    itsOutput += ", ";
+    append_number(lonlat.lat);
+  }
+  void operator()(const Fmi::LocalDateTime& ldt) const
+  {
+    itsOutput += Fmi::to_iso_extended_string(ldt.local_time());
+  }
+
+ private:
+  template <typename T>
+  void append_number(T value) const
+  {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    itsOutput.append(buffer, result.ptr);
+  }
+
+  std::string& itsOutput;
+  const std::string& itsMissingText;
+};
+
+// Collects the record batch body and the matching field nodes and buffer descriptions
+class BatchBuilder
+{
+ public:
+  explicit BatchBuilder(std::size_t length) : itsLength(length) {}
+
+  std::size_t length() const { return itsLength; }
+
+  // Validity bitmap of the column being built
+  void start_column()
+  {
+    itsValidity.assign((itsLength + 7) / 8, 0);
+    itsNullCount = itsLength;
+  }
+
+  void set_valid(std::size_t row)
+  {
+    itsValidity[row / 8] |= static_cast<std::uint8_t>(1U << (row % 8));
+    --itsNullCount;
+  }
+
+  // The validity bitmap is followed by the given data buffers
+  void end_column(const std::vector<std::pair<const void*, std::size_t>>& buffers)
+  {
+    itsNodes.emplace_back(itsLength, itsNullCount);
+    if (itsNullCount == 0)
+      add_buffer(nullptr, 0);
+    else
+      add_buffer(itsValidity.data(), itsValidity.size());
+    for (const auto& buffer : buffers)
+      add_buffer(buffer.first, buffer.second);
+  }
+
+  std::string message() const
+  {
+    FlatBufferBuilder builder;
+    const auto nodes = builder.create_vector(itsNodes);
+    const auto buffers = builder.create_vector(itsBuffers);
+
+    builder.start_table();
+    builder.add_field<std::int64_t>(0, itsLength);
+    builder.add_offset(1, nodes);
+    builder.add_offset(2, buffers);
+    const auto batch = builder.end_table();
+
+    builder.start_table();
+    builder.add_field<std::int16_t>(0, metadata_version_v5);
+    builder.add_field<std::uint8_t>(1, header_record_batch);
+    builder.add_offset(2, batch);
+    builder.add_field<std::int64_t>(3, itsBody.size());
+    return builder.finish(builder.end_table());
+  }
+
+  const std::string& body() const { return itsBody; }
+
+ private:
+  void add_buffer(const void* data, std::size_t size)
+  {
+    itsBuffers.emplace_back(itsBody.size(), size);
+    itsBody.append(static_cast<const char*>(data), size);
+    itsBody.append((8 - size % 8) % 8, '\0');
+  }
+
+  std::size_t itsLength;
+  std::size_t itsNullCount = 0;
+  std::vector<std::uint8_t> itsValidity;
+  std::vector<std::pair<std::int64_t, std::int64_t>> itsNodes;
+  std::vector<std::pair<std::int64_t, std::int64_t>> itsBuffers;
+  std::string itsBody;
+};
+
+// Accumulates a utf8 column
+class Utf8Column
+{
+ public:
+  explicit Utf8Column(std::size_t length)
+  {
+    itsOffsets.reserve(length + 1);
+    itsOffsets.push_back(0);
+  }
+
+  std::string& data() { return itsData; }
+  void end_value()
+  {
+    if (itsData.size() > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+      throw Fmi::Exception(BCP, "Arrow utf8 column exceeds 2 GB");
+    itsOffsets.push_back(static_cast<std::int32_t>(itsData.size()));
+  }
+
+  void add_to(BatchBuilder& batch) const
+  {
+    batch.end_column({{itsOffsets.data(), itsOffsets.size() * sizeof(std::int32_t)},
+                      {itsData.data(), itsData.size()}});
+  }
+
+ private:
+  std::vector<std::int32_t> itsOffsets;
+  std::string itsData;
+};
+
+template <typename T>
+void add_fixed_column(BatchBuilder& batch, const std::vector<T>& values)
+{
+  batch.end_column({{values.data(), values.size() * sizeof(T)}});
+}
+
+// The value of a column at the given row, or nullptr if there is none
+const Value* get_value(const Column& column, std::size_t row)
+{
+  if (row >= column.series.size())
+    return nullptr;
+  const Value& value = column.series[row].value;
+  if (std::holds_alternative<None>(value))
+    return nullptr;
+  return &value;
+}
+
+// The time of the row from the first column which has one
+const Fmi::LocalDateTime* get_time(const std::vector<Column>& columns, std::size_t row)
+{
+  for (const auto& column : columns)
+  {
+    const auto& ts = (column.group.empty() ? column.series : column.group.front());
+    if (row < ts.size())
+      return &ts[row].time;
+  }
+  return nullptr;
+}
+
+void add_group_column(BatchBuilder& batch, const Column& column, const std::string& missingtext)
+{
+  Utf8Column utf8(batch.length());
+  batch.start_column();
+  for (std::size_t row = 0; row < batch.length(); row++)
+  {
+    if (!column.group.empty() && row < column.size())
+    {
+      auto& text = utf8.data();
+      TextAppender appender(text, missingtext);
+      text += '[';
+      for (std::size_t k = 0; k < column.group.size(); k++)
+      {
+        if (k > 0)
+          text += ' ';
+        const auto& ts = column.group[k];
+        if (row < ts.size())
+          std::visit(appender, static_cast<const Value_&>(ts[row].value));
+      }
+      text += ']';
+      batch.set_valid(row);
+    }
+    utf8.end_value();
+  }
+  utf8.add_to(batch);
+}
+
+void add_column(BatchBuilder& batch,
+                const Column& column,
+                ColumnType type,
+                const std::string& missingtext)
+{
+  if (!column.group.empty())
+    return add_group_column(batch, column, missingtext);
+
+  const std::size_t n = batch.length();
+  batch.start_column();
+
+  switch (type)
+  {
+    case ColumnType::Int32:
+    {
+      std::vector<std::int32_t> values(n, 0);
+      for (std::size_t row = 0; row < n; row++)
+        if (const auto* value = get_value(column, row))
+        {
+          values[row] = std::get<int>(*value);
+          batch.set_valid(row);
+        }
+      return add_fixed_column(batch, values);
+    }
+    case ColumnType::Float64:
+    {
+      std::vector<double> values(n, 0);
+      for (std::size_t row = 0; row < n; row++)
+        if (const auto* value = get_value(column, row))
+        {
+          const auto* d = std::get_if<double>(value);
+          values[row] = (d != nullptr ? *d : std::get<int>(*value));
+          batch.set_valid(row);
+        }
+      return add_fixed_column(batch, values);
+    }
+    case ColumnType::Timestamp:
+    {
+      std::vector<std::int64_t> values(n, 0);
+      for (std::size_t row = 0; row < n; row++)
+        if (const auto* value = get_value(column, row))
+        {
+          values[row] = epoch_microseconds(std::get<Fmi::LocalDateTime>(*value));
+          batch.set_valid(row);
+        }
+      return add_fixed_column(batch, values);
+    }
+    case ColumnType::Utf8:
+    {
+      Utf8Column utf8(n);
+      TextAppender appender(utf8.data(), missingtext);
+      for (std::size_t row = 0; row < n; row++)
+      {
+        if (const auto* value = get_value(column, row))
+        {
+          std::visit(appender, static_cast<const Value_&>(*value));
+          batch.set_valid(row);
+        }
+        utf8.end_value();
+      }
+      return utf8.add_to(batch);
+    }
+  }
+}
+
+FlatBufferBuilder::Offset create_field(FlatBufferBuilder& builder,
+                                       const std::string& name,
+                                       ColumnType type,
+                                       const std::string& zone,
+                                       bool nullable)
+{
+  const auto name_offset = builder.create_string(name);
+  const bool has_zone = (type == ColumnType::Timestamp && !zone.empty());
+  const auto zone_offset = (has_zone ? builder.create_string(zone) : 0);
+  const auto children = builder.create_vector(std::vector<FlatBufferBuilder::Offset>());
+
+  builder.start_table();
+  std::uint8_t type_type = type_utf8;
+  switch (type)
+  {
+    case ColumnType::Int32:
+      type_type = type_int;
+      builder.add_field<std::int32_t>(0, 32);
+      builder.add_field<std::uint8_t>(1, 1);
+      break;
+    case ColumnType::Float64:
+      type_type = type_floating_point;
+      builder.add_field<std::int16_t>(0, precision_double);
+      break;
+    case ColumnType::Timestamp:
+      type_type = type_timestamp;
+      builder.add_field<std::int16_t>(0, timeunit_microsecond);
+      if (has_zone)
+        builder.add_offset(1, zone_offset);
+      break;
+    case ColumnType::Utf8:
+      break;
+  }
+  const auto type_offset = builder.end_table();
+
+  builder.start_table();
+  builder.add_offset(0, name_offset);
+  builder.add_field<std::uint8_t>(1, nullable ? 1 : 0);
+  builder.add_field<std::uint8_t>(2, type_type);
+  builder.add_offset(3, type_offset);
+  builder.add_offset(5, children);
+  return builder.end_table();
+}
+
+std::string schema_message(const std::vector<std::string>& names,
+                           const std::vector<ColumnType>& types,
+                           const std::string& zone)
+{
+  FlatBufferBuilder builder;
+
+  std::vector<FlatBufferBuilder::Offset> fields;
+  fields.push_back(create_field(builder, "name", ColumnType::Utf8, zone, false));
+  fields.push_back(create_field(builder, "time", ColumnType::Timestamp, zone, true));
+  for (std::size_t i = 0; i < types.size(); i++)
+    fields.push_back(create_field(builder, names[i], types[i], zone, true));
+  const auto fields_offset = builder.create_vector(fields);
+
+  builder.start_table();
+  builder.add_field<std::int16_t>(0, 0);  // little endian
+  builder.add_offset(1, fields_offset);
+  const auto schema = builder.end_table();
+
+  builder.start_table();
+  builder.add_field<std::int16_t>(0, metadata_version_v5);
+  builder.add_field<std::uint8_t>(1, header_schema);
+  builder.add_offset(2, schema);
+  builder.add_field<std::int64_t>(3, 0);
+  return builder.finish(builder.end_table());
+}
+
+void write_message(ChunkedWriter& writer, const std::string& metadata, const std::string& body)
+{
+  // Flatbuffers are finished to a multiple of 8 bytes, hence no padding is needed
+  const std::uint32_t continuation = 0xFFFFFFFF;
+  const std::int32_t size = static_cast<std::int32_t>(metadata.size());
+  writer.append(std::string_view(reinterpret_cast<const char*>(&continuation), 4));
+  writer.append(std::string_view(reinterpret_cast<const char*>(&size), 4));
+  writer.append(metadata);
+  writer.append(body);
+}
+
+template <typename Data>
+void write_stream(ChunkedWriter& writer,
+                  const Data& data,
+                  const std::vector<std::string>& columnnames,
+                  const std::string& missingtext)
+{
+  // Determine the schema from all elements so that all batches share it
+
+  std::vector<std::vector<Column>> columns;
+  columns.reserve(data.size());
+  std::vector<ColumnInfo> infos;
+  std::deque<TimeSeries> expanded;
+  std::string zone;
+
+  for (const auto& item : data)
+  {
+    columns.push_back(get_columns(item.second, expanded));
+    const auto& cols = columns.back();
+    if (cols.size() > infos.size())
+      infos.resize(cols.size());
+
+    for (std::size_t i = 0; i < cols.size(); i++)
+    {
+      if (!cols[i].group.empty())
+      {
+        infos[i].has_other = true;
+        continue;
+      }
+      for (const auto& tv : cols[i].series)
+      {
+        infos[i].add(tv.value);
+        if (zone.empty() && !tv.time.is_not_a_date_time())
+          zone = tv.time.zone()->name();
+      }
+    }
+  }
+
+  std::vector<ColumnType> types;
+  std::vector<std::string> names;
+  for (std::size_t i = 0; i < infos.size(); i++)
+  {
+    types.push_back(infos[i].type());
+    names.push_back(i < columnnames.size() ? columnnames[i] : "column" + Fmi::to_string(i + 1));
+  }
+
+  write_message(writer, schema_message(names, types, zone), std::string());
+
+  for (std::size_t k = 0; k < data.size(); k++)
+  {
+    const auto& cols = columns[k];
+
+    std::size_t nrows = 0;
+    for (const auto& column : cols)
+      nrows = std::max(nrows, column.size());
+
+    BatchBuilder batch(nrows);
+
+    // name column
+    Utf8Column name_column(nrows);
+    batch.start_column();
+    for (std::size_t row = 0; row < nrows; row++)
+    {
+      name_column.data() += data[k].first;
+      name_column.end_value();
+      batch.set_valid(row);
+    }
+    name_column.add_to(batch);
+
+    // time column
+    std::vector<std::int64_t> times(nrows, 0);
+    batch.start_column();
+    for (std::size_t row = 0; row < nrows; row++)
+    {
+      const auto* ldt = get_time(cols, row);
+      if (ldt != nullptr && !ldt->is_not_a_date_time())
+      {
+        times[row] = epoch_microseconds(*ldt);
+        batch.set_valid(row);
+      }
+    }
+    add_fixed_column(batch, times);
+
+    // data columns, missing columns are all nulls
+    const Column missing;
+    for (std::size_t i = 0; i < types.size(); i++)
+      add_column(batch, (i < cols.size() ? cols[i] : missing), types[i], missingtext);
+
+    write_message(writer, batch.message(), batch.body());
+  }
+
+  // end-of-stream marker
+  const std::uint64_t eos = 0x00000000FFFFFFFF;
+  writer.append(std::string_view(reinterpret_cast<const char*>(&eos), 8));
+  writer.flush();
+}
+
+// Writes everything to the file descriptor
+ChunkedWriter::Writer fd_writer(int fd)
+{
+  return [fd](const char* ptr, std::size_t size)
+  {
+    while (size > 0)
+    {
+      const auto n = ::write(fd, ptr, size);
+      if (n < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        throw Fmi::Exception(BCP, "Failed to write Arrow stream")
+            .addParameter("Error", std::strerror(errno));
+      }
+      ptr += n;
+      size -= static_cast<std::size_t>(n);
+    }
+  };
+}
+
+}  // namespace
+
+void write_arrow_stream(ChunkedWriter& writer,
+                        const OutputData& data,
+                        const std::vector<std::string>& columnnames,
+                        const std::string& missingtext)
+{
+  try
+  {
+    write_stream(writer, data, columnnames, missingtext);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void write_arrow_stream(int fd,
+                        const OutputData& data,
+                        const std::vector<std::string>& columnnames,
+                        const std::string& missingtext)
+{
+  try
+  {
+    ChunkedWriter writer(fd_writer(fd));
+    write_stream(writer, data, columnnames, missingtext);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+std::string arrow_stream(const OutputData& data,
+                         const std::vector<std::string>& columnnames,
+                         const std::string& missingtext)
+{
+  try
+  {
+    std::string output;
+    ChunkedWriter writer([&output](const char* ptr, std::size_t size)
+                         { output.append(ptr, size); });
+    write_stream(writer, data, columnnames, missingtext);
+    return output;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void write_arrow_stream(ChunkedWriter& writer,
+                        const pmr::OutputData& data,
+                        const std::vector<std::string>& columnnames,
+                        const std::string& missingtext)
+{
+  try
+  {
+    write_stream(writer, data, columnnames, missingtext);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void write_arrow_stream(int fd,
+                        const pmr::OutputData& data,
+                        const std::vector<std::string>& columnnames,
+                        const std::string& missingtext)
+{
+  try
+  {
+    ChunkedWriter writer(fd_writer(fd));
+    write_stream(writer, data, columnnames, missingtext);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+std::string arrow_stream(const pmr::OutputData& data,
+                         const std::vector<std::string>& columnnames,
+                         const std::string& missingtext)
+{
+  try
+  {
+    std::string output;
+    ChunkedWriter writer([&output](const char* ptr, std::size_t size)
+                         { output.append(ptr, size); });
+    write_stream(writer, data, columnnames, missingtext);
+    return output;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
@@ -0,0 +1,74 @@
+// ======================================================================
+/*!
+ * \brief Export OutputData in the Apache Arrow IPC stream format
+ *
+ * Each OutputData element becomes one record batch. The batches share
+ * a schema with the columns
+ *
+ *   name     utf8                  the name of the OutputData element
+ *   time     timestamp[us, zone]   the time of the row
+ *   columns  int32, float64, timestamp[us, zone] or utf8
+ *
+ * The data columns are laid out like TableFeeder lays them out. Each
+ * column gets the narrowest type which can hold all its values: int32
+ * if there are only integers, float64 if there are numbers, timestamp
+ * if there are only times, and utf8 otherwise. Missing values and
+ * missing rows are nulls. Multi-location TimeSeriesGroup columns are
+ * written as "[v1 v2 ...]" strings, in which missing values are written
+ * as the missing text like in TableFeeder.
+ *
+ * The writer needs no Arrow libraries. It encodes the messages itself,
+ * and its output can be read by any Arrow implementation
+ * (pyarrow.ipc.open_stream, polars.read_ipc_stream, ...).
+ */
+// ======================================================================
+
+#pragma once
+
+#include "ChunkedWriter.h"
+#include "TimeSeriesUtility.h"
+#include <string>
+#include <vector>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+// Write the stream via the chunked writer, and flush it at the end. Columns without a name are
+// called column1, column2 etc. The missing text is used only in group cells, the default is
+// that of Fmi::ValueFormatterParam.
+void write_arrow_stream(ChunkedWriter& writer,
+                        const OutputData& data,
+                        const std::vector<std::string>& columnnames = {},
+                        const std::string& missingtext = "nan");
+
+// Write the stream to a file descriptor
+void write_arrow_stream(int fd,
+                        const OutputData& data,
+                        const std::vector<std::string>& columnnames = {},
+                        const std::string& missingtext = "nan");
+
+// Return the stream as a memory buffer
+std::string arrow_stream(const OutputData& data,
+                         const std::vector<std::string>& columnnames = {},
+                         const std::string& missingtext = "nan");
+
+// The same for data allocated from a memory resource
+void write_arrow_stream(ChunkedWriter& writer,
+                        const pmr::OutputData& data,
+                        const std::vector<std::string>& columnnames = {},
+                        const std::string& missingtext = "nan");
+
+void write_arrow_stream(int fd,
+                        const pmr::OutputData& data,
+                        const std::vector<std::string>& columnnames = {},
+                        const std::string& missingtext = "nan");
+
+std::string arrow_stream(const pmr::OutputData& data,
+                         const std::vector<std::string>& columnnames = {},
+                         const std::string& missingtext = "nan");
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
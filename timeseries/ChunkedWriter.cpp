@@ -0,0 +1,45 @@
+#include "ChunkedWriter.h"
+#include <macgyver/Exception.h>
+#include <utility>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+ChunkedWriter::ChunkedWriter(Writer writer, std::size_t chunksize)
+    : itsWriter(std::move(writer)), itsChunkSize(chunksize)
+{
+  try
+  {
+    if (!itsWriter)
+      throw Fmi::Exception(BCP, "ChunkedWriter requires a writer callback");
+    if (itsChunkSize == 0)
+      throw Fmi::Exception(BCP, "ChunkedWriter chunk size must be positive");
+
+    itsBuffer.reserve(itsChunkSize);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void ChunkedWriter::flush()
+{
+  try
+  {
+    if (itsBuffer.empty())
+      return;
+
+    itsWriter(itsBuffer.data(), itsBuffer.size());
+    itsBytesWritten += itsBuffer.size();
+    itsBuffer.clear();
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
@@ -0,0 +1,72 @@
+// ======================================================================
+/*!
+ * \brief Output buffer which is flushed to a writer callback in chunks
+ *
+ * Text is appended to an internal buffer. Whenever the buffer reaches
+ * the chunk size its contents are passed to the writer callback and the
+ * buffer is reused, hence the memory use is bounded by the chunk size
+ * plus the size of the largest single append.
+ */
+// ======================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+class ChunkedWriter
+{
+ public:
+  using Writer = std::function<void(const char* data, std::size_t size)>;
+
+  explicit ChunkedWriter(Writer writer, std::size_t chunksize = 64 * 1024);
+
+  ChunkedWriter() = delete;
+  ChunkedWriter(const ChunkedWriter& other) = delete;
+  ChunkedWriter& operator=(const ChunkedWriter& other) = delete;
+
+  void append(std::string_view text)
+  {
+    itsBuffer.append(text);
+    commit();
+  }
+
+  void append(char ch)
+  {
+    itsBuffer.push_back(ch);
+    commit();
+  }
+
+  // Direct access for formatting values in place. Call commit() when done.
+  std::string& buffer() { return itsBuffer; }
+
+  // Flush if the chunk size has been reached
+  void commit()
+  {
+    if (itsBuffer.size() >= itsChunkSize)
+      flush();
+  }
+
+  // Pass all buffered output to the writer
+  void flush();
+
+  std::size_t chunkSize() const { return itsChunkSize; }
+  std::size_t bytesWritten() const { return itsBytesWritten; }
+
+ private:
+  Writer itsWriter;
+  std::size_t itsChunkSize;
+  std::size_t itsBytesWritten = 0;
+  std::string itsBuffer;
+};
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
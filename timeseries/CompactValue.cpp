@@ -0,0 +1,211 @@
+#include "CompactValue.h"
+#include <macgyver/Exception.h>
+#include <limits>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+namespace
+{
+const Fmi::DateTime epoch(Fmi::Date(1970, 1, 1));
+
+// Handles of times without a zone and of NOT_A_DATE_TIME
+const std::uint32_t no_zone = std::numeric_limits<std::uint32_t>::max();
+const std::uint32_t not_a_date_time = no_zone - 1;
+
+std::uint32_t make_handle(std::size_t index)
+{
+  if (index >= not_a_date_time)
+    throw Fmi::Exception(BCP, "ValuePool is full");
+  return static_cast<std::uint32_t>(index);
+}
+
+}  // namespace
+
+// ----------------------------------------------------------------------
+// ValuePool
+// ----------------------------------------------------------------------
+
+std::uint32_t ValuePool::intern(const std::string& str)
+{
+  auto pos = itsStringIndex.find(str);
+  if (pos != itsStringIndex.end())
+    return pos->second;
+
+  const auto handle = make_handle(itsStrings.size());
+  itsStrings.push_back(str);
+  itsStringIndex.emplace(itsStrings.back(), handle);
+  return handle;
+}
+
+std::uint32_t ValuePool::intern(const Fmi::TimeZonePtr& zone)
+{
+  if (!zone)
+    return no_zone;
+
+  // Typically all times are in the same zone
+  const auto& name = zone->name();
+  if (itsLastZone < itsZones.size() && itsZones[itsLastZone]->name() == name)
+    return itsLastZone;
+
+  for (std::size_t i = 0; i < itsZones.size(); i++)
+  {
+    if (itsZones[i]->name() == name)
+    {
+      itsLastZone = static_cast<std::uint32_t>(i);
+      return itsLastZone;
+    }
+  }
+
+  itsLastZone = make_handle(itsZones.size());
+  itsZones.push_back(zone);
+  return itsLastZone;
+}
+
+CompactValue ValuePool::compact(const Fmi::LocalDateTime& time)
+{
+  try
+  {
+    if (time.is_not_a_date_time())
+      return CompactValue(CompactValue::Type::LocalDateTime, 0, not_a_date_time);
+
+    const std::int64_t us = (time.utc_time() - epoch).total_microseconds();
+    return CompactValue(
+        CompactValue::Type::LocalDateTime, static_cast<std::uint64_t>(us), intern(time.zone()));
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+CompactValue ValuePool::compact(const Value& value)
+{
+  try
+  {
+    if (const auto* d = std::get_if<double>(&value))
+      return CompactValue(*d);
+    if (const auto* i = std::get_if<int>(&value))
+      return CompactValue(*i);
+    if (const auto* s = std::get_if<std::string>(&value))
+      return CompactValue(CompactValue::Type::String, intern(*s));
+    if (const auto* ll = std::get_if<LonLat>(&value))
+    {
+      // Coordinates repeat only in consecutive values of a location
+      if (!itsLonLats.empty() && itsLonLats.back().lon == ll->lon &&
+          itsLonLats.back().lat == ll->lat)
+        return CompactValue(CompactValue::Type::LonLat, itsLonLats.size() - 1);
+
+      const auto handle = make_handle(itsLonLats.size());
+      itsLonLats.push_back(*ll);
+      return CompactValue(CompactValue::Type::LonLat, handle);
+    }
+    if (const auto* t = std::get_if<Fmi::LocalDateTime>(&value))
+      return compact(*t);
+    return {};
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+Fmi::LocalDateTime ValuePool::expandTime(const CompactValue& value) const
+{
+  if (value.itsZone == not_a_date_time)
+    return Fmi::LocalDateTime();
+
+  const auto utc = epoch + Fmi::Microseconds(static_cast<std::int64_t>(value.itsBits));
+  if (value.itsZone == no_zone)
+    return Fmi::LocalDateTime(utc, Fmi::TimeZonePtr());
+  return Fmi::LocalDateTime(utc, itsZones[value.itsZone]);
+}
+
+Value ValuePool::expand(const CompactValue& value) const
+{
+  switch (value.type())
+  {
+    case CompactValue::Type::None:
+      return {};
+    case CompactValue::Type::String:
+      return itsStrings[value.itsBits];
+    case CompactValue::Type::Double:
+      return value.getDouble();
+    case CompactValue::Type::Int:
+      return value.getInt();
+    case CompactValue::Type::LonLat:
+      return itsLonLats[value.itsBits];
+    case CompactValue::Type::LocalDateTime:
+      return expandTime(value);
+  }
+  return {};
+}
+
+// ----------------------------------------------------------------------
+// CompactTimeSeries
+// ----------------------------------------------------------------------
+
+CompactTimeSeries::CompactTimeSeries(ValuePoolPtr pool) : itsPool(std::move(pool))
+{
+  if (!itsPool)
+    throw Fmi::Exception(BCP, "CompactTimeSeries requires a value pool");
+}
+
+CompactTimeSeries::CompactTimeSeries(const TimeSeries& ts, ValuePoolPtr pool)
+    : CompactTimeSeries(std::move(pool))
+{
+  try
+  {
+    reserve(ts.size());
+    for (const auto& tv : ts)
+      push_back(tv);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void CompactTimeSeries::push_back(const TimedValue& tv)
+{
+  itsTimes.push_back(itsPool->compact(tv.time));
+  itsValues.push_back(itsPool->compact(tv.value));
+}
+
+void CompactTimeSeries::reserve(std::size_t n)
+{
+  itsTimes.reserve(n);
+  itsValues.reserve(n);
+}
+
+Fmi::LocalDateTime CompactTimeSeries::time(std::size_t pos) const
+{
+  return itsPool->expandTime(itsTimes.at(pos));
+}
+
+Value CompactTimeSeries::value(std::size_t pos) const
+{
+  return itsPool->expand(itsValues.at(pos));
+}
+
+TimeSeries CompactTimeSeries::expand() const
+{
+  try
+  {
+    TimeSeries ts;
+    ts.reserve(size());
+    for (std::size_t i = 0; i < size(); i++)
+      ts.emplace_back(itsPool->expandTime(itsTimes[i]), itsPool->expand(itsValues[i]));
+    return ts;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
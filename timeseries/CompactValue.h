@@ -0,0 +1,139 @@
+// ======================================================================
+/*!
+ * \brief Compact 16 byte storage for time series values
+ *
+ * A Value is as large as its largest alternative, hence every number
+ * pays for the space of a string or a LocalDateTime. A CompactValue
+ * stores numbers inline and strings, coordinates and time zones as
+ * handles to a ValuePool, and times as UTC microseconds since the
+ * epoch plus a zone handle.
+ *
+ * A ValuePool is not thread safe while values are being added to it,
+ * use one pool per request or per thread. Expanding values from a pool
+ * which is no longer modified is safe.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "TimeSeries.h"
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+class CompactValue
+{
+ public:
+  // Same order as the alternatives of Value_
+  enum class Type : std::uint8_t
+  {
+    None,
+    String,
+    Double,
+    Int,
+    LonLat,
+    LocalDateTime
+  };
+
+  CompactValue() = default;
+  CompactValue(double value) : itsType(Type::Double) { std::memcpy(&itsBits, &value, 8); }
+  CompactValue(int value) : itsBits(static_cast<std::uint32_t>(value)), itsType(Type::Int) {}
+
+  Type type() const { return itsType; }
+  bool isNone() const { return itsType == Type::None; }
+
+  // Valid only for the matching type
+  double getDouble() const
+  {
+    double value;
+    std::memcpy(&value, &itsBits, 8);
+    return value;
+  }
+  int getInt() const { return static_cast<int>(static_cast<std::uint32_t>(itsBits)); }
+
+ private:
+  friend class ValuePool;
+
+  CompactValue(Type type, std::uint64_t bits, std::uint32_t zone = 0)
+      : itsBits(bits), itsZone(zone), itsType(type)
+  {
+  }
+
+  std::uint64_t itsBits = 0;  // double, int, pool handle or UTC microseconds
+  std::uint32_t itsZone = 0;  // time zone handle of a time
+  Type itsType = Type::None;
+};
+
+static_assert(sizeof(CompactValue) <= 16, "CompactValue must fit into 16 bytes");
+
+class ValuePool
+{
+ public:
+  ValuePool() = default;
+  ValuePool(const ValuePool&) = delete;
+  ValuePool& operator=(const ValuePool&) = delete;
+
+  CompactValue compact(const Value& value);
+  Value expand(const CompactValue& value) const;
+
+  // Times are always stored as times, not as values of any other type
+  CompactValue compact(const Fmi::LocalDateTime& time);
+  Fmi::LocalDateTime expandTime(const CompactValue& value) const;
+
+  std::size_t strings() const { return itsStrings.size(); }
+  std::size_t zones() const { return itsZones.size(); }
+
+ private:
+  std::uint32_t intern(const std::string& str);
+  std::uint32_t intern(const Fmi::TimeZonePtr& zone);
+
+  // A deque does not move the strings the index refers to
+  std::deque<std::string> itsStrings;
+  std::unordered_map<std::string_view, std::uint32_t> itsStringIndex;
+  std::vector<LonLat> itsLonLats;
+  std::vector<Fmi::TimeZonePtr> itsZones;
+  std::uint32_t itsLastZone = 0;
+};
+
+using ValuePoolPtr = std::shared_ptr<ValuePool>;
+
+// A time series stored as compact values, the pool is shared with other series of the request
+class CompactTimeSeries
+{
+ public:
+  explicit CompactTimeSeries(ValuePoolPtr pool);
+  CompactTimeSeries(const TimeSeries& ts, ValuePoolPtr pool);
+
+  void push_back(const TimedValue& tv);
+  void reserve(std::size_t n);
+  std::size_t size() const { return itsValues.size(); }
+  bool empty() const { return itsValues.empty(); }
+
+  Fmi::LocalDateTime time(std::size_t pos) const;
+  Value value(std::size_t pos) const;
+  TimedValue operator[](std::size_t pos) const { return TimedValue(time(pos), value(pos)); }
+
+  const CompactValue& compactValue(std::size_t pos) const { return itsValues[pos]; }
+  const ValuePool& pool() const { return *itsPool; }
+
+  TimeSeries expand() const;
+
+ private:
+  ValuePoolPtr itsPool;
+  std::vector<CompactValue> itsTimes;
+  std::vector<CompactValue> itsValues;
+};
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
@@ -6,6 +6,8 @@
 
 #include "DataFunction.h"
 #include <macgyver/Exception.h>
+#include <macgyver/Hash.h>
+#include <functional>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
@@ -92,6 +94,41 @@ std::string DataFunction::hash() const
   }
 }
 
+// ----------------------------------------------------------------------
+/*!
+ * \brief Generate an integer hash for the function
+ */
+// ----------------------------------------------------------------------
+
+std::size_t DataFunction::hash_value() const
+{
+  std::size_t hash = std::hash<int>{}(static_cast<int>(itsFunctionId));
+  Fmi::hash_combine(hash, std::hash<int>{}(static_cast<int>(itsFunctionType)));
+  Fmi::hash_combine(hash, std::hash<double>{}(itsLowerLimit));
+  Fmi::hash_combine(hash, std::hash<double>{}(itsUpperLimit));
+  Fmi::hash_combine(hash, std::hash<unsigned int>{}(itsAggregationIntervalBehind));
+  Fmi::hash_combine(hash, std::hash<unsigned int>{}(itsAggregationIntervalAhead));
+  Fmi::hash_combine(hash, std::hash<bool>{}(itsNaNFunction));
+  Fmi::hash_combine(hash, std::hash<bool>{}(itsDirFunction));
+  return hash;
+}
+
+bool DataFunction::operator==(const DataFunction& other) const
+{
+  return (itsFunctionId == other.itsFunctionId && itsFunctionType == other.itsFunctionType &&
+          itsLowerLimit == other.itsLowerLimit && itsUpperLimit == other.itsUpperLimit &&
+          itsAggregationIntervalBehind == other.itsAggregationIntervalBehind &&
+          itsAggregationIntervalAhead == other.itsAggregationIntervalAhead &&
+          itsNaNFunction == other.itsNaNFunction && itsDirFunction == other.itsDirFunction);
+}
+
+std::size_t DataFunctions::hash_value() const
+{
+  std::size_t hash = innerFunction.hash_value();
+  Fmi::hash_combine(hash, outerFunction.hash_value());
+  return hash;
+}
+
 // ----------------------------------------------------------------------
 /*!
  * \brief Printable information on the function
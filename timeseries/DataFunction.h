@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <iostream>
 #include <limits>
 #include <string>
@@ -88,6 +89,10 @@ struct DataFunction
   bool isNanFunction() const { return itsNaNFunction; }
   bool isDirFunction() const { return itsDirFunction; }
   std::string hash() const;
+  // Cheap hash for cache keys, unlike hash() all members contribute to it
+  std::size_t hash_value() const;
+  bool operator==(const DataFunction& other) const;
+  bool operator!=(const DataFunction& other) const { return !(*this == other); }
   void setLimits(double theLowerLimit, double theUpperLimit)
   {
     itsLowerLimit = theLowerLimit;
@@ -121,6 +126,13 @@ struct DataFunctions
   DataFunctions(const DataFunctions& functions) = default;
   DataFunctions& operator=(const DataFunctions& other) = default;
 
+  std::size_t hash_value() const;
+  bool operator==(const DataFunctions& other) const
+  {
+    return innerFunction == other.innerFunction && outerFunction == other.outerFunction;
+  }
+  bool operator!=(const DataFunctions& other) const { return !(*this == other); }
+
   DataFunction innerFunction;
   DataFunction outerFunction;
 
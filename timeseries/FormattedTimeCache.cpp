@@ -0,0 +1,145 @@
+#include "FormattedTimeCache.h"
+#include <macgyver/Exception.h>
+#include <macgyver/StringConversion.h>
+#include <utility>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+namespace
+{
+std::string zone_name(const Fmi::TimeZonePtr& zone)
+{
+  return zone ? zone->name() : std::string();
+}
+
+// The time in the requested zone, or as is if no zone was given
+Fmi::LocalDateTime to_zone(const Fmi::LocalDateTime& ldt, const Fmi::TimeZonePtr& zone)
+{
+  if (!zone)
+    return ldt;
+  return Fmi::LocalDateTime(ldt.utc_time(), zone);
+}
+
+}  // namespace
+
+template <typename Formatter>
+const FormattedTimeCache::Strings& FormattedTimeCache::find_or_format(const Key& key,
+                                                                      const TimeList& timeline,
+                                                                      Formatter&& formatter)
+{
+  // Formatting is done while holding the lock so that concurrent users of the same
+  // timeline do not format it several times. Entries are never removed while the
+  // cache is in use, hence the returned references remain valid.
+
+  std::lock_guard<std::mutex> lock(itsMutex);
+
+  auto pos = itsEntries.find(key);
+  if (pos != itsEntries.end())
+  {
+    ++itsHits;
+    return pos->second.times;
+  }
+
+  ++itsMisses;
+
+  Entry entry;
+  entry.timeline = timeline;
+  entry.times.reserve(timeline->size());
+  for (const auto& ldt : *timeline)
+    entry.times.push_back(formatter(ldt));
+
+  return itsEntries.emplace(key, std::move(entry)).first->second.times;
+}
+
+const FormattedTimeCache::Strings& FormattedTimeCache::format(const TimeList& timeline,
+                                                              const Fmi::TimeFormatter& formatter,
+                                                              const Fmi::TimeZonePtr& zone)
+{
+  try
+  {
+    if (!timeline)
+      throw Fmi::Exception(BCP, "Cannot format an undefined timeline");
+
+    const Key key(timeline.get(), &formatter, zone_name(zone), std::string(), std::string());
+
+    return find_or_format(key,
+                          timeline,
+                          [&](const Fmi::LocalDateTime& ldt)
+                          { return formatter.format(to_zone(ldt, zone)); });
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+const FormattedTimeCache::Strings& FormattedTimeCache::format(const TimeList& timeline)
+{
+  try
+  {
+    if (!timeline)
+      throw Fmi::Exception(BCP, "Cannot format an undefined timeline");
+
+    const Key key(timeline.get(), nullptr, std::string(), std::string(), std::string());
+
+    return find_or_format(key,
+                          timeline,
+                          [](const Fmi::LocalDateTime& ldt)
+                          { return Fmi::to_iso_extended_string(ldt.local_time()); });
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+const FormattedTimeCache::Strings& FormattedTimeCache::format(const TimeList& timeline,
+                                                              const std::string& timestring,
+                                                              const std::locale& locale,
+                                                              const Fmi::TimeZonePtr& zone)
+{
+  try
+  {
+    if (!timeline)
+      throw Fmi::Exception(BCP, "Cannot format an undefined timeline");
+
+    // Unnamed locales are identified by the object itself
+    const std::string name = locale.name();
+    const void* id = (name == "*" ? &locale : nullptr);
+    const Key key(timeline.get(), id, zone_name(zone), name, timestring);
+
+    return find_or_format(key,
+                          timeline,
+                          [&](const Fmi::LocalDateTime& ldt)
+                          { return Fmi::format_time(locale, timestring, to_zone(ldt, zone)); });
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+std::size_t FormattedTimeCache::hits() const
+{
+  std::lock_guard<std::mutex> lock(itsMutex);
+  return itsHits;
+}
+
+std::size_t FormattedTimeCache::misses() const
+{
+  std::lock_guard<std::mutex> lock(itsMutex);
+  return itsMisses;
+}
+
+void FormattedTimeCache::clear()
+{
+  std::lock_guard<std::mutex> lock(itsMutex);
+  itsEntries.clear();
+  itsHits = 0;
+  itsMisses = 0;
+}
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
@@ -0,0 +1,94 @@
+// ======================================================================
+/*!
+ * \brief Per-request cache of formatted timelines
+ *
+ * The same timeline is typically formatted for every location and
+ * sometimes for several time columns. The cache formats each timestep
+ * of a timeline once per (timeline, formatter, zone, locale, format)
+ * and hands out the same strings for all later requests.
+ *
+ * Timelines are identified by the LocalTimeList object, hence the
+ * lists shared via TimeSeriesGeneratorCache hit the cache. The cache
+ * keeps the timelines alive so that their addresses cannot be reused.
+ * Formatters and unnamed locales are identified by their address and
+ * must outlive the cache.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "TimeSeriesTypes.h"
+#include <macgyver/LocalDateTime.h>
+#include <macgyver/TimeFormatter.h>
+#include <locale>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+class FormattedTimeCache
+{
+ public:
+  using TimeList = std::shared_ptr<LocalTimeList>;
+  using Strings = std::vector<std::string>;
+
+  // Format with the time formatter. Times are converted to the given zone unless it is empty.
+  // The returned strings remain valid as long as the cache exists.
+  const Strings& format(const TimeList& timeline,
+                        const Fmi::TimeFormatter& formatter,
+                        const Fmi::TimeZonePtr& zone = Fmi::TimeZonePtr());
+
+  // Format as ISO 8601 extended local times like StringVisitor and RowFeeder do
+  const Strings& format(const TimeList& timeline);
+
+  // Format with a format string in the given locale (see Fmi::format_time)
+  const Strings& format(const TimeList& timeline,
+                        const std::string& timestring,
+                        const std::locale& locale,
+                        const Fmi::TimeZonePtr& zone = Fmi::TimeZonePtr());
+
+  // Formatted time of a single timestep
+  std::string_view get(const TimeList& timeline,
+                       std::size_t index,
+                       const Fmi::TimeFormatter& formatter,
+                       const Fmi::TimeZonePtr& zone = Fmi::TimeZonePtr())
+  {
+    return format(timeline, formatter, zone).at(index);
+  }
+
+  std::size_t hits() const;
+  std::size_t misses() const;
+
+  // Invalidates all previously returned strings
+  void clear();
+
+ private:
+  // timeline, formatter, zone name, locale name, format string
+  using Key = std::tuple<const LocalTimeList*, const void*, std::string, std::string, std::string>;
+
+  struct Entry
+  {
+    TimeList timeline;
+    Strings times;
+  };
+
+  template <typename Formatter>
+  const Strings& find_or_format(const Key& key, const TimeList& timeline, Formatter&& formatter);
+
+  mutable std::mutex itsMutex;
+  std::map<Key, Entry> itsEntries;
+  std::size_t itsHits = 0;
+  std::size_t itsMisses = 0;
+};
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
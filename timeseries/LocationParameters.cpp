@@ -70,7 +70,7 @@ try
 
   Value result = LocationParameters::instance(Fmi::ascii_tolower_copy(paramName), args, precision);
 
-  return std::visit(visitor, dynamic_cast<Value_&>(result));
+  return std::visit(visitor, static_cast<const Value_&>(result));
 }
 catch (...)
 {
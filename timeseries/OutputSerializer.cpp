@@ -0,0 +1,105 @@
+#include "OutputSerializer.h"
+#include "RowFeeder.h"
+#include "RowSink.h"
+#include <macgyver/Exception.h>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+namespace
+{
+template <typename Data>
+void serialize(RowSink& sink,
+               const Data& data,
+               const std::vector<std::string>& columnnames,
+               const Fmi::ValueFormatter& valueformatter,
+               const std::vector<int>& precisions,
+               NumberFormatting formatting)
+{
+  RowFeeder feeder(sink, valueformatter, precisions);
+  feeder.setNumberFormatting(formatting);
+
+  sink.beginTable(columnnames);
+  feeder << data;
+  sink.endTable();
+}
+
+}  // namespace
+
+void write_csv(ChunkedWriter& writer,
+               const OutputData& data,
+               const std::vector<std::string>& columnnames,
+               const Fmi::ValueFormatter& valueformatter,
+               const std::vector<int>& precisions,
+               NumberFormatting formatting,
+               char separator)
+{
+  try
+  {
+    CsvRowSink sink(writer, separator);
+    serialize(sink, data, columnnames, valueformatter, precisions, formatting);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void write_json(ChunkedWriter& writer,
+                const OutputData& data,
+                const std::vector<std::string>& columnnames,
+                const Fmi::ValueFormatter& valueformatter,
+                const std::vector<int>& precisions,
+                NumberFormatting formatting)
+{
+  try
+  {
+    JsonRowSink sink(writer);
+    serialize(sink, data, columnnames, valueformatter, precisions, formatting);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void write_csv(ChunkedWriter& writer,
+               const pmr::OutputData& data,
+               const std::vector<std::string>& columnnames,
+               const Fmi::ValueFormatter& valueformatter,
+               const std::vector<int>& precisions,
+               NumberFormatting formatting,
+               char separator)
+{
+  try
+  {
+    CsvRowSink sink(writer, separator);
+    serialize(sink, data, columnnames, valueformatter, precisions, formatting);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void write_json(ChunkedWriter& writer,
+                const pmr::OutputData& data,
+                const std::vector<std::string>& columnnames,
+                const Fmi::ValueFormatter& valueformatter,
+                const std::vector<int>& precisions,
+                NumberFormatting formatting)
+{
+  try
+  {
+    JsonRowSink sink(writer);
+    serialize(sink, data, columnnames, valueformatter, precisions, formatting);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
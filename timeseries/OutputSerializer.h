@@ -0,0 +1,63 @@
+// ======================================================================
+/*!
+ * \brief Serialize OutputData directly as CSV or JSON
+ *
+ * The serializers stream the rows through RowFeeder into a CsvRowSink
+ * or a JsonRowSink, so no Spine::Table or per-cell strings are needed.
+ * The output is flushed through the writer in chunks.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "ChunkedWriter.h"
+#include "TimeSeriesOutput.h"
+#include "TimeSeriesUtility.h"
+#include <macgyver/ValueFormatter.h>
+#include <string>
+#include <vector>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+// Numbers are formatted with the given ValueFormatter unless std::to_chars is requested
+// explicitly, which reproduces only the default ValueFormatterParam settings.
+
+// CSV with a header row if column names are given
+void write_csv(ChunkedWriter& writer,
+               const OutputData& data,
+               const std::vector<std::string>& columnnames,
+               const Fmi::ValueFormatter& valueformatter,
+               const std::vector<int>& precisions,
+               NumberFormatting formatting = NumberFormatting::ValueFormatter,
+               char separator = ',');
+
+// JSON array of row objects keyed by the column names, or of row arrays if there are no names
+void write_json(ChunkedWriter& writer,
+                const OutputData& data,
+                const std::vector<std::string>& columnnames,
+                const Fmi::ValueFormatter& valueformatter,
+                const std::vector<int>& precisions,
+                NumberFormatting formatting = NumberFormatting::ValueFormatter);
+
+// The same for data allocated from a memory resource
+void write_csv(ChunkedWriter& writer,
+               const pmr::OutputData& data,
+               const std::vector<std::string>& columnnames,
+               const Fmi::ValueFormatter& valueformatter,
+               const std::vector<int>& precisions,
+               NumberFormatting formatting = NumberFormatting::ValueFormatter,
+               char separator = ',');
+
+void write_json(ChunkedWriter& writer,
+                const pmr::OutputData& data,
+                const std::vector<std::string>& columnnames,
+                const Fmi::ValueFormatter& valueformatter,
+                const std::vector<int>& precisions,
+                NumberFormatting formatting = NumberFormatting::ValueFormatter);
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
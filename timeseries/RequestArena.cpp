@@ -0,0 +1,43 @@
+#include "RequestArena.h"
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+RequestArena::RequestArena(std::size_t initialSize)
+    : itsResource(initialSize, std::pmr::new_delete_resource())
+{
+}
+
+RequestArena::~RequestArena() = default;
+
+std::size_t RequestArena::allocated() const
+{
+  std::lock_guard<std::mutex> lock(itsMutex);
+  return itsAllocated;
+}
+
+void* RequestArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+  std::lock_guard<std::mutex> lock(itsMutex);
+  void* p = itsResource.allocate(bytes, alignment);
+  itsAllocated += bytes;
+  return p;
+}
+
+// Memory is released only when the arena is destroyed
+void RequestArena::do_deallocate(void* /* p */,
+                                 std::size_t /* bytes */,
+                                 std::size_t /* alignment */)
+{
+}
+
+bool RequestArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+  return this == &other;
+}
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
@@ -0,0 +1,64 @@
+// ======================================================================
+/*!
+ * \brief Per-request memory arena for time series containers
+ *
+ * The pmr variants of TimeSeries, TimeSeriesVector and TimeSeriesGroup
+ * allocate from a std::pmr memory resource. Containers created with
+ * make_shared() allocate themselves, their control blocks and all nested
+ * series from the arena, and so do aggregation results computed from
+ * them. Nothing is released before the arena itself is destroyed at the
+ * end of the request, hence results which must outlive the request are
+ * copied to the heap with to_heap().
+ *
+ * Allocation is synchronized so that the arena can be shared by the
+ * threads processing a request.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "TimeSeries.h"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+class RequestArena : public std::pmr::memory_resource
+{
+ public:
+  explicit RequestArena(std::size_t initialSize = 64 * 1024);
+  ~RequestArena() override;
+
+  RequestArena(const RequestArena&) = delete;
+  RequestArena& operator=(const RequestArena&) = delete;
+
+  // Allocate an object and its nested containers from the arena, for example
+  // make_shared<pmr::TimeSeriesVector>(nparams)
+  template <typename T, typename... Args>
+  std::shared_ptr<T> make_shared(Args&&... args)
+  {
+    return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(this),
+                                   std::forward<Args>(args)...);
+  }
+
+  // Bytes allocated from the arena so far
+  std::size_t allocated() const;
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+  mutable std::mutex itsMutex;
+  std::pmr::monotonic_buffer_resource itsResource;
+  std::size_t itsAllocated = 0;
+};
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
@@ -0,0 +1,98 @@
+#include "RequestEstimator.h"
+#include "TimeSeries.h"
+#include <macgyver/Exception.h>
+#include <algorithm>
+#include <limits>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+namespace
+{
+// Typical heap allocation of a formatted string value such as a name or a time
+// which does not fit into the small string buffer
+const std::size_t string_payload = 32;
+
+const std::size_t max_size = std::numeric_limits<std::size_t>::max();
+
+// Saturating arithmetic, absurd requests must not wrap around to small estimates
+std::size_t multiply(std::size_t a, std::size_t b)
+{
+  if (a != 0 && b > max_size / a)
+    return max_size;
+  return a * b;
+}
+
+std::size_t add(std::size_t a, std::size_t b)
+{
+  return (b > max_size - a ? max_size : a + b);
+}
+
+// Values read per result value by a time function
+std::size_t aggregation_inputs(const DataFunction& func, unsigned int datatimestep)
+{
+  if (func.type() != FunctionType::TimeFunction)
+    return 1;
+
+  // Unlimited intervals are limited by the maximum aggregation interval
+  const auto max_interval = static_cast<unsigned int>(MAX_AGGREGATION_INTERVAL);
+  const std::size_t interval = std::min(func.getAggregationIntervalBehind(), max_interval) +
+                               std::min(func.getAggregationIntervalAhead(), max_interval);
+  return 1 + interval / std::max(datatimestep, 1U);
+}
+
+}  // namespace
+
+RequestEstimate estimate_request(const OptionParsers::ParameterOptions& options,
+                                 const RequestDimensions& dimensions)
+{
+  try
+  {
+    RequestEstimate estimate;
+
+    const std::size_t levels = std::max<std::size_t>(dimensions.levels, 1);
+    const std::size_t values =
+        multiply(multiply(dimensions.locations, dimensions.timesteps), levels);
+
+    for (const auto& paramfuncs : options.parameterFunctions())
+    {
+      estimate.elements = add(estimate.elements, values);
+
+      // Data independent values are mostly strings such as names and times
+      const bool data_independent =
+          (paramfuncs.parameter.type() == Spine::Parameter::Type::DataIndependent);
+      const std::size_t value_size =
+          sizeof(TimedValue) + (data_independent ? string_payload : std::size_t(0));
+      estimate.bytes = add(estimate.bytes, multiply(values, value_size));
+
+      // Time aggregation reads the values of the whole interval for each result value
+      std::size_t inputs = 1;
+      if (!data_independent)
+      {
+        const auto& funcs = paramfuncs.functions;
+        inputs = std::max(aggregation_inputs(funcs.innerFunction, dimensions.datatimestep),
+                          aggregation_inputs(funcs.outerFunction, dimensions.datatimestep));
+      }
+      estimate.cost = add(estimate.cost, multiply(values, inputs));
+    }
+
+    return estimate;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void check_request_limits(const RequestLimits& limits, const RequestEstimate& estimate)
+{
+  check_request_limit(limits, estimate.elements, RequestLimitMember::ELEMENTS);
+  check_request_limit(limits, estimate.bytes, RequestLimitMember::BYTES);
+  check_request_limit(limits, estimate.cost, RequestLimitMember::COST);
+}
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
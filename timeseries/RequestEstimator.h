@@ -0,0 +1,48 @@
+// ======================================================================
+/*!
+ * \brief Estimate the size and cost of a request before fetching data
+ *
+ * The estimate is computed from the parsed parameters and the request
+ * dimensions only, so that too large or too expensive requests can be
+ * refused before any data is retrieved. The numbers are upper bounds
+ * for typical data rather than exact predictions.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "OptionParsers.h"
+#include "RequestLimits.h"
+#include <cstddef>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+// Request dimensions known after parsing the options. The number of timesteps can be
+// taken from TimeSeriesGenerator::LocalTimeRange::max_size() without generating them.
+struct RequestDimensions
+{
+  std::size_t locations = 1;
+  std::size_t timesteps = 0;
+  std::size_t levels = 1;
+  unsigned int datatimestep = 60;  // minutes between source data values
+};
+
+struct RequestEstimate
+{
+  std::size_t elements = 0;  // result values, as counted by number_of_elements
+  std::size_t bytes = 0;     // memory needed for the result values
+  std::size_t cost = 0;      // values read or computed, including aggregation inputs
+};
+
+RequestEstimate estimate_request(const OptionParsers::ParameterOptions& options,
+                                 const RequestDimensions& dimensions);
+
+// Check the ELEMENTS, BYTES and COST limits
+void check_request_limits(const RequestLimits& limits, const RequestEstimate& estimate);
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
@@ -36,6 +36,17 @@ void check_request_limit(const RequestLimits &limits, std::size_t amount, Reques
     if (limits.maxelements > 0 && limits.maxelements < amount)
       description = ("Too many elements: Max " + Fmi::to_string(limits.maxelements) + " allowed!");
   }
+  else if (member == RequestLimitMember::BYTES)
+  {
+    if (limits.maxbytes > 0 && limits.maxbytes < amount)
+      description = ("Too much data: Max " + Fmi::to_string(limits.maxbytes) + " bytes allowed!");
+  }
+  else if (member == RequestLimitMember::COST)
+  {
+    if (limits.maxcost > 0 && limits.maxcost < amount)
+      description = ("Too expensive request: Max cost " + Fmi::to_string(limits.maxcost) +
+                     " allowed, estimated " + Fmi::to_string(amount) + "!");
+  }
 
   if (!description.empty())
     throw Fmi::Exception::Trace(BCP, "RequestLimitError").addParameter("description", description);
@@ -19,6 +19,8 @@ struct RequestLimits
   std::size_t maxlevels = 0;
   std::size_t maxelements = 0;
   double maxradius = 0;
+  std::size_t maxbytes = 0;  // estimated memory use of the result values
+  std::size_t maxcost = 0;   // estimated number of values read or computed
 };
 
 enum class RequestLimitMember
@@ -27,7 +29,9 @@ enum class RequestLimitMember
   PARAMETERS,
   TIMESTEPS,
   LEVELS,
-  ELEMENTS
+  ELEMENTS,
+  BYTES,
+  COST
 };
 
 void check_request_limit(const RequestLimits &limits,
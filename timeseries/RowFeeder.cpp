@@ -0,0 +1,375 @@
+#include "RowFeeder.h"
+#include <macgyver/Exception.h>
+#include <macgyver/StringConversion.h>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <string>
+#include <variant>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+namespace
+{
+// Appends a formatted value to a string exactly like StringVisitor would return it
+class CellAppender
+{
+ public:
+  CellAppender(std::string& output,
+               const Fmi::ValueFormatter& valueformatter,
+               int precision,
+               Spine::LonLatFormat lonlatformat,
+               NumberFormatting numberformatting)
+      : itsOutput(output),
+        itsValueFormatter(valueformatter),
+        itsPrecision(precision),
+        itsLonLatFormat(lonlatformat),
+        itsNumberFormatting(numberformatting)
+  {
+  }
+
+  void operator()(const Spine::None& /* none */) const { itsOutput += itsValueFormatter.missing(); }
+  void operator()(const std::string& str) const { itsOutput += str; }
+  void operator()(double d) const
+  {
+    append_number(itsOutput, itsValueFormatter, d, itsPrecision, itsNumberFormatting);
+  }
+  void operator()(int i) const
+  {
+    char buffer[16];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), i);
+    itsOutput.append(buffer, result.ptr);
+  }
+  void operator()(const Spine::LonLat& lonlat) const
+  {
+    const bool lonfirst = (itsLonLatFormat == Spine::LonLatFormat::LONLAT);
+    (*this)(lonfirst ? lonlat.lon : lonlat.lat);
+    itsOutput += ", ";
+    (*this)(lonfirst ? lonlat.lat : lonlat.lon);
+  }
+  void operator()(const Fmi::LocalDateTime& ldt) const
+  {
+    itsOutput += Fmi::to_iso_extended_string(ldt.local_time());
+  }
+
+ private:
+  std::string& itsOutput;
+  const Fmi::ValueFormatter& itsValueFormatter;
+  int itsPrecision;
+  Spine::LonLatFormat itsLonLatFormat;
+  NumberFormatting itsNumberFormatting;
+};
+
+enum class CellType
+{
+  Text,
+  Number,
+  Missing
+};
+
+// Non-finite numbers are formatted as missing values, for example as nulls in JSON
+CellType cell_type(const Value& value)
+{
+  if (const auto* d = std::get_if<double>(&value))
+    return std::isfinite(*d) ? CellType::Number : CellType::Missing;
+  if (std::holds_alternative<int>(value))
+    return CellType::Number;
+  if (std::holds_alternative<None>(value))
+    return CellType::Missing;
+  return CellType::Text;
+}
+
+// One output column: a plain time series, a group of several locations or runs of values
+struct Column
+{
+  TimedValueView series;
+  std::vector<TimedValueView> group;  // set only for several locations
+  const RunLengthTimeSeries* runs = nullptr;
+  std::size_t run = 0;  // the run of the current row
+
+  std::size_t size() const
+  {
+    if (runs != nullptr)
+      return runs->size();
+    if (!group.empty())
+      return group.front().size();
+    return series.size();
+  }
+};
+
+// The columns are laid out the same way for heap and pmr allocated data
+
+template <typename Series>
+void add_series(std::vector<Column>& columns, const Series* ts)
+{
+  columns.emplace_back();
+  if (ts != nullptr)
+    columns.back().series = *ts;
+}
+
+template <typename Vector>
+void add_vector(std::vector<Column>& columns, const Vector* tsv)
+{
+  // An empty vector produces no columns just like in TableFeeder
+  if (tsv != nullptr)
+    for (const auto& ts : *tsv)
+      add_series(columns, &ts);
+}
+
+template <typename Group>
+void add_group(std::vector<Column>& columns, const Group* tsg)
+{
+  if (tsg == nullptr || tsg->empty())
+    columns.emplace_back();
+  else if (tsg->size() == 1)
+    add_series(columns, &tsg->front().timeseries);
+  else
+  {
+    Column column;
+    for (const auto& lts : *tsg)
+      column.group.emplace_back(lts.timeseries);
+    columns.push_back(std::move(column));
+  }
+}
+
+void add_column(std::vector<Column>& columns, const TimeSeries* ts)
+{
+  add_series(columns, ts);
+}
+
+void add_column(std::vector<Column>& columns, const pmr::TimeSeries* ts)
+{
+  add_series(columns, ts);
+}
+
+void add_column(std::vector<Column>& columns, const TimeSeriesVector* tsv)
+{
+  add_vector(columns, tsv);
+}
+
+void add_column(std::vector<Column>& columns, const pmr::TimeSeriesVector* tsv)
+{
+  add_vector(columns, tsv);
+}
+
+void add_column(std::vector<Column>& columns, const TimeSeriesGroup* tsg)
+{
+  add_group(columns, tsg);
+}
+
+void add_column(std::vector<Column>& columns, const pmr::TimeSeriesGroup* tsg)
+{
+  add_group(columns, tsg);
+}
+
+void add_column(std::vector<Column>& columns, const RunLengthTimeSeries* rts)
+{
+  Column column;
+  column.runs = rts;
+  columns.push_back(column);
+}
+
+template <typename Data>
+std::vector<Column> get_columns(const std::vector<Data>& data)
+{
+  std::vector<Column> columns;
+  columns.reserve(data.size());
+  for (const auto& tsdata : data)
+    std::visit([&columns](const auto& ptr) { add_column(columns, ptr.get()); }, tsdata);
+  return columns;
+}
+
+}  // namespace
+
+RowFeeder::RowFeeder(RowSink& sink,
+                     const Fmi::ValueFormatter& valueformatter,
+                     const std::vector<int>& precisions)
+    : itsSink(sink), itsValueFormatter(valueformatter), itsPrecisions(precisions)
+{
+}
+
+RowFeeder& RowFeeder::operator<<(const OutputData& data)
+{
+  try
+  {
+    for (const auto& item : data)
+      *this << item.second;
+    return *this;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+RowFeeder& RowFeeder::operator<<(const pmr::OutputData& data)
+{
+  try
+  {
+    for (const auto& item : data)
+      *this << item.second;
+    return *this;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+RowFeeder& RowFeeder::operator<<(const std::vector<TimeSeriesData>& data)
+{
+  try
+  {
+    feed(data);
+    return *this;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+RowFeeder& RowFeeder::operator<<(const std::vector<pmr::TimeSeriesData>& data)
+{
+  try
+  {
+    feed(data);
+    return *this;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+template <typename Data>
+void RowFeeder::feed(const std::vector<Data>& data)
+{
+  try
+  {
+    auto columns = get_columns(data);
+
+    if (columns.size() > itsPrecisions.size())
+      throw Fmi::Exception(BCP, "Not enough precisions for the output columns")
+          .addParameter("Columns", Fmi::to_string(columns.size()))
+          .addParameter("Precisions", Fmi::to_string(itsPrecisions.size()));
+
+    std::size_t nrows = 0;
+    for (const auto& column : columns)
+      nrows = std::max(nrows, column.size());
+
+    if (itsCells.size() < columns.size())
+      itsCells.resize(columns.size());
+
+    // Timesteps of the timeline are formatted once for all locations and time columns
+    const FormattedTimeCache::Strings* times = nullptr;
+    LocalTimeList::const_iterator timestep;
+    if (itsTimeCache != nullptr && itsTimeline)
+    {
+      times = &itsTimeCache->format(itsTimeline);
+      timestep = itsTimeline->cbegin();
+    }
+
+    for (std::size_t row = 0; row < nrows; row++)
+    {
+      const bool has_timestep = (times != nullptr && row < times->size());
+
+      itsSink.beginRow();
+      for (std::size_t col = 0; col < columns.size(); col++)
+      {
+        auto& column = columns[col];
+        auto& cell = itsCells[col];
+
+        // Rows missing from shorter columns are missing values
+        CellType type = CellType::Missing;
+
+        if (row >= column.size())
+          cell.clear();
+        else
+        {
+          CellAppender appender(
+              cell, itsValueFormatter, itsPrecisions[col], itsLonLatFormat, itsNumberFormatting);
+
+          if (column.runs == nullptr && column.group.empty())
+          {
+            const Value& value = column.series[row].value;
+            type = cell_type(value);
+
+            const auto* ldt = std::get_if<Fmi::LocalDateTime>(&value);
+            if (ldt != nullptr && has_timestep && ldt->local_time() == timestep->local_time())
+              cell = (*times)[row];
+            // The cell of the previous row is still intact in the buffer
+            else if (row == 0 || !is_repeated_value(column.series[row - 1].value, value))
+            {
+              cell.clear();
+              std::visit(appender, static_cast<const Value_&>(value));
+            }
+          }
+          else if (column.runs != nullptr)
+          {
+            // Each run is formatted only once
+            const auto& runs = column.runs->runs();
+            const bool same_run = (row > 0 && row < runs[column.run].end);
+            while (runs[column.run].end <= row)
+              ++column.run;
+
+            const Value& value = runs[column.run].value;
+            type = cell_type(value);
+            if (!same_run)
+            {
+              cell.clear();
+              std::visit(appender, static_cast<const Value_&>(value));
+            }
+          }
+          else
+          {
+            type = CellType::Text;
+
+            // Concatenate the values of all locations like TableFeeder does
+            cell = '[';
+            for (std::size_t k = 0; k < column.group.size(); k++)
+            {
+              if (k > 0)
+                cell += ' ';
+              const auto& ts = column.group[k];
+              if (row < ts.size())
+                std::visit(appender, static_cast<const Value_&>(ts[row].value));
+            }
+            cell += ']';
+
+            const auto first = cell.find_first_not_of(' ', 1);
+            cell.erase(1, first - 1);
+            const auto last = cell.find_last_not_of(' ', cell.size() - 2);
+            cell.erase(last + 1, cell.size() - 2 - last);
+          }
+        }
+
+        if (type == CellType::Number)
+          itsSink.addNumber(cell);
+        else if (type == CellType::Missing)
+          itsSink.addMissing(cell);
+        else
+          itsSink.addCell(cell);
+      }
+      itsSink.endRow();
+      ++itsRowCount;
+      if (has_timestep)
+        ++timestep;
+    }
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+RowFeeder& RowFeeder::operator<<(Spine::LonLatFormat newformat)
+{
+  itsLonLatFormat = newformat;
+  return *this;
+}
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
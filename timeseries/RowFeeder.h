@@ -0,0 +1,75 @@
+#pragma once
+
+#include "FormattedTimeCache.h"
+#include "RowSink.h"
+#include "TimeSeriesOutput.h"
+#include "TimeSeriesUtility.h"
+#include <macgyver/ValueFormatter.h>
+#include <spine/LonLat.h>
+#include <vector>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+// Feed data row by row to a RowSink instead of materializing a Spine::Table.
+//
+// The columns of one OutputData element are laid out like TableFeeder lays them
+// out: a TimeSeries is one column, each member of a TimeSeriesVector is a column
+// of its own and a TimeSeriesGroup is one column of "[v1 v2 ...]" cells unless it
+// has a single member. A RunLengthTimeSeries is one column. The rows of
+// consecutive OutputData elements follow each other. Shorter columns are padded
+// with empty cells. A value repeating the value above it, for example in a
+// constant column, is not formatted again.
+//
+// If a FormattedTimeCache is set, times equal to the respective timestep of the
+// timeline are taken from the cache. Each timestep is then formatted only once
+// for all locations and time columns.
+//
+// usage: rowfeeder << outputdata; sink.endTable();
+
+class RowFeeder
+{
+ public:
+  RowFeeder(RowSink& sink,
+            const Fmi::ValueFormatter& valueformatter,
+            const std::vector<int>& precisions);
+
+  RowFeeder& operator<<(const OutputData& data);
+  RowFeeder& operator<<(const std::vector<TimeSeriesData>& columns);
+
+  // Data allocated from a memory resource is output without copying it to the heap
+  RowFeeder& operator<<(const pmr::OutputData& data);
+  RowFeeder& operator<<(const std::vector<pmr::TimeSeriesData>& columns);
+
+  // Set LonLat formatting
+  RowFeeder& operator<<(Spine::LonLatFormat newformat);
+
+  void setNumberFormatting(NumberFormatting newFormatting) { itsNumberFormatting = newFormatting; }
+
+  // The cache must outlive the feeder
+  void setTimeCache(FormattedTimeCache& cache, const FormattedTimeCache::TimeList& timeline)
+  {
+    itsTimeCache = &cache;
+    itsTimeline = timeline;
+  }
+
+  std::size_t getRowCount() const { return itsRowCount; }
+
+ private:
+  template <typename Data>
+  void feed(const std::vector<Data>& data);
+
+  RowSink& itsSink;
+  const Fmi::ValueFormatter& itsValueFormatter;
+  const std::vector<int>& itsPrecisions;
+  Spine::LonLatFormat itsLonLatFormat = Spine::LonLatFormat::LONLAT;
+  NumberFormatting itsNumberFormatting = NumberFormatting::ValueFormatter;
+  std::size_t itsRowCount = 0;
+  std::vector<std::string> itsCells;  // cells of the latest row, reused for repeated values
+  FormattedTimeCache* itsTimeCache = nullptr;
+  FormattedTimeCache::TimeList itsTimeline;
+};
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
@@ -0,0 +1,366 @@
+#include "RowSink.h"
+#include <macgyver/Exception.h>
+#include <string>
+#include <utility>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+namespace
+{
+std::size_t skip_digits(std::string_view value, std::size_t pos)
+{
+  while (pos < value.size() && value[pos] >= '0' && value[pos] <= '9')
+    ++pos;
+  return pos;
+}
+
+// Validate against the JSON number grammar -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool is_json_number(std::string_view value)
+{
+  std::size_t pos = 0;
+  if (pos < value.size() && value[pos] == '-')
+    ++pos;
+
+  if (pos < value.size() && value[pos] == '0')
+    ++pos;
+  else
+  {
+    const std::size_t end = skip_digits(value, pos);
+    if (end == pos)
+      return false;
+    pos = end;
+  }
+
+  if (pos < value.size() && value[pos] == '.')
+  {
+    const std::size_t end = skip_digits(value, ++pos);
+    if (end == pos)
+      return false;
+    pos = end;
+  }
+
+  if (pos < value.size() && (value[pos] == 'e' || value[pos] == 'E'))
+  {
+    ++pos;
+    if (pos < value.size() && (value[pos] == '+' || value[pos] == '-'))
+      ++pos;
+    const std::size_t end = skip_digits(value, pos);
+    if (end == pos)
+      return false;
+    pos = end;
+  }
+
+  return pos == value.size();
+}
+
+}  // namespace
+
+RowSink::~RowSink() = default;
+
+DelimitedRowSink::DelimitedRowSink(ChunkedWriter& writer, char separator, std::string newline)
+    : itsWriter(writer), itsSeparator(separator), itsNewline(std::move(newline))
+{
+}
+
+void DelimitedRowSink::beginTable(const std::vector<std::string>& names)
+{
+  try
+  {
+    if (names.empty())
+      return;
+
+    beginRow();
+    for (const auto& name : names)
+      addCell(name);
+    endRow();
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void DelimitedRowSink::beginRow()
+{
+  itsFirstCell = true;
+}
+
+std::string& DelimitedRowSink::startCell()
+{
+  auto& buffer = itsWriter.buffer();
+  if (!itsFirstCell)
+    buffer += itsSeparator;
+  itsFirstCell = false;
+  return buffer;
+}
+
+void DelimitedRowSink::addCell(std::string_view value)
+{
+  try
+  {
+    startCell() += value;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void DelimitedRowSink::endRow()
+{
+  try
+  {
+    // Chunks are flushed only at row boundaries
+    itsWriter.append(itsNewline);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void DelimitedRowSink::endTable()
+{
+  try
+  {
+    itsWriter.flush();
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+// CsvRowSink
+// ----------------------------------------------------------------------
+
+CsvRowSink::CsvRowSink(ChunkedWriter& writer, char separator, std::string newline)
+    : DelimitedRowSink(writer, separator, std::move(newline))
+{
+}
+
+void CsvRowSink::addCell(std::string_view value)
+{
+  try
+  {
+    auto& buffer = startCell();
+
+    const char special[] = {separator(), '"', '\n', '\r', '\0'};
+    if (value.find_first_of(special) == std::string_view::npos)
+    {
+      buffer += value;
+      return;
+    }
+
+    buffer += '"';
+    for (char ch : value)
+    {
+      if (ch == '"')
+        buffer += '"';
+      buffer += ch;
+    }
+    buffer += '"';
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+// JsonRowSink
+// ----------------------------------------------------------------------
+
+void append_json_string(std::string& output, std::string_view value)
+{
+  try
+  {
+    static const char* hex = "0123456789abcdef";
+
+    output += '"';
+
+    // Copy runs of characters which need no escaping at once
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < value.size(); i++)
+    {
+      const auto ch = static_cast<unsigned char>(value[i]);
+      if (ch >= 0x20 && ch != '"' && ch != '\\')
+        continue;
+
+      output.append(value.data() + start, i - start);
+      start = i + 1;
+
+      output += '\\';
+      switch (ch)
+      {
+        case '"':
+          output += '"';
+          break;
+        case '\\':
+          output += '\\';
+          break;
+        case '\n':
+          output += 'n';
+          break;
+        case '\r':
+          output += 'r';
+          break;
+        case '\t':
+          output += 't';
+          break;
+        case '\b':
+          output += 'b';
+          break;
+        case '\f':
+          output += 'f';
+          break;
+        default:
+          output += "u00";
+          output += hex[ch >> 4];
+          output += hex[ch & 0xF];
+      }
+    }
+    output.append(value.data() + start, value.size() - start);
+    output += '"';
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+JsonRowSink::JsonRowSink(ChunkedWriter& writer) : itsWriter(writer) {}
+
+void JsonRowSink::beginTable(const std::vector<std::string>& names)
+{
+  try
+  {
+    // Keys are escaped only once
+    itsKeys.clear();
+    for (const auto& name : names)
+    {
+      std::string key;
+      append_json_string(key, name);
+      key += ':';
+      itsKeys.push_back(std::move(key));
+    }
+    itsObjects = !names.empty();
+    itsStarted = true;
+    itsWriter.append('[');
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void JsonRowSink::beginRow()
+{
+  try
+  {
+    if (!itsStarted)
+      beginTable({});
+
+    auto& buffer = itsWriter.buffer();
+    if (itsRowCount > 0)
+      buffer += ',';
+    buffer += (itsObjects ? '{' : '[');
+    itsColumn = 0;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+std::string& JsonRowSink::startCell()
+{
+  auto& buffer = itsWriter.buffer();
+  if (itsColumn > 0)
+    buffer += ',';
+
+  if (itsObjects)
+  {
+    // Extra columns without a given name
+    while (itsColumn >= itsKeys.size())
+      itsKeys.push_back("\"column" + std::to_string(itsKeys.size() + 1) + "\":");
+    buffer += itsKeys[itsColumn];
+  }
+
+  ++itsColumn;
+  return buffer;
+}
+
+void JsonRowSink::addCell(std::string_view value)
+{
+  try
+  {
+    append_json_string(startCell(), value);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void JsonRowSink::addNumber(std::string_view value)
+{
+  try
+  {
+    // Formatter settings such as showpos, width or a decimal comma do not produce JSON numbers
+    if (is_json_number(value))
+      startCell() += value;
+    else
+      append_json_string(startCell(), value);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void JsonRowSink::addMissing(std::string_view /* value */)
+{
+  try
+  {
+    startCell() += "null";
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void JsonRowSink::endRow()
+{
+  try
+  {
+    itsWriter.append(itsObjects ? '}' : ']');
+    ++itsRowCount;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void JsonRowSink::endTable()
+{
+  try
+  {
+    if (!itsStarted)
+      beginTable({});
+    itsWriter.append(']');
+    itsWriter.flush();
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
@@ -0,0 +1,116 @@
+// ======================================================================
+/*!
+ * \brief Interface for receiving formatted output row by row
+ *
+ * A RowSink is the streaming alternative to filling a Spine::Table:
+ * cells arrive in row-major order and may be written out immediately.
+ * The sinks write through a ChunkedWriter, which flushes at row
+ * boundaries.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "ChunkedWriter.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SmartMet
+{
+namespace TimeSeries
+{
+class RowSink
+{
+ public:
+  virtual ~RowSink();
+
+  // Called once before any rows, the names may be empty
+  virtual void beginTable(const std::vector<std::string>& /* names */) {}
+
+  virtual void beginRow() = 0;
+  virtual void addCell(std::string_view value) = 0;
+  virtual void endRow() = 0;
+
+  // Formatted numbers and missing values. By default they are added like any other cell.
+  virtual void addNumber(std::string_view value) { addCell(value); }
+  virtual void addMissing(std::string_view value) { addCell(value); }
+
+  // Called once after all rows
+  virtual void endTable() {}
+};
+
+// Writes cells separated by a delimiter and rows terminated by a newline.
+// No quoting is done, the values are written as is.
+
+class DelimitedRowSink : public RowSink
+{
+ public:
+  DelimitedRowSink(ChunkedWriter& writer, char separator = ' ', std::string newline = "\n");
+
+  void beginTable(const std::vector<std::string>& names) override;
+  void beginRow() override;
+  void addCell(std::string_view value) override;
+  void endRow() override;
+  void endTable() override;
+
+ protected:
+  // Write the separator if needed and return the buffer for the cell contents
+  std::string& startCell();
+
+  char separator() const { return itsSeparator; }
+
+ private:
+  ChunkedWriter& itsWriter;
+  char itsSeparator;
+  std::string itsNewline;
+  bool itsFirstCell = true;
+};
+
+// Writes CSV (RFC 4180). Cells containing the separator, quotes or line breaks are quoted. This
+// applies to numbers too, since the formatter may for example use a decimal comma.
+
+class CsvRowSink : public DelimitedRowSink
+{
+ public:
+  explicit CsvRowSink(ChunkedWriter& writer, char separator = ',', std::string newline = "\n");
+
+  void addCell(std::string_view value) override;
+};
+
+// Writes a JSON array with one element per row. The rows are objects keyed by the column names
+// given to beginTable, or arrays if there are no names. Numbers are written as JSON numbers and
+// missing values as nulls. Formatted numbers which are not valid JSON numbers, for example due to
+// a leading plus sign or padding, are written as strings.
+
+class JsonRowSink : public RowSink
+{
+ public:
+  explicit JsonRowSink(ChunkedWriter& writer);
+
+  void beginTable(const std::vector<std::string>& names) override;
+  void beginRow() override;
+  void addCell(std::string_view value) override;
+  void addNumber(std::string_view value) override;
+  void addMissing(std::string_view value) override;
+  void endRow() override;
+  void endTable() override;
+
+ private:
+  std::string& startCell();
+
+  ChunkedWriter& itsWriter;
+  std::vector<std::string> itsKeys;  // escaped and quoted names followed by a colon
+  bool itsObjects = false;
+  bool itsStarted = false;
+  std::size_t itsRowCount = 0;
+  std::size_t itsColumn = 0;
+};
+
+// Append a string as a quoted JSON string
+void append_json_string(std::string& output, std::string_view value);
+
+}  // namespace TimeSeries
+}  // namespace SmartMet
+
+// ======================================================================
@@ -23,8 +23,7 @@ try : Fmi
           Value value = None();
           if (args.station.stationDirection >= 0)
           {
-            Fmi::ValueFormatterParam vfp;
-            Fmi::ValueFormatter valueFormatter(vfp);
+            static const Fmi::ValueFormatter valueFormatter{Fmi::ValueFormatterParam()};
             value = valueFormatter.format(args.station.stationDirection, 1);
           }
           return value;
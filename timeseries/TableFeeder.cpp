@@ -1,11 +1,123 @@
 #include "TableFeeder.h"
 #include "TimeSeriesOutput.h"
 #include <macgyver/Exception.h>
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+#include <sstream>
 
 namespace SmartMet
 {
 namespace TimeSeries
 {
+namespace
+{
+// Appends a formatted value to a string exactly like OStreamVisitor would write it
+class AppendVisitor
+{
+ public:
+  AppendVisitor(std::string& output, const Fmi::ValueFormatter& valueformatter, int precision)
+      : itsOutput(output), itsValueFormatter(valueformatter), itsPrecision(precision)
+  {
+  }
+
+  void operator()(const Spine::None& /* none */) const { itsOutput += itsValueFormatter.missing(); }
+  void operator()(const std::string& str) const { itsOutput += str; }
+  void operator()(double d) const { itsOutput += itsValueFormatter.format(d, itsPrecision); }
+  void operator()(int i) const
+  {
+    char buffer[16];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), i);
+    itsOutput.append(buffer, result.ptr);
+  }
+  void operator()(const Spine::LonLat& lonlat) const
+  {
+    itsOutput += itsValueFormatter.format(lonlat.lon, itsPrecision);
+    itsOutput += ", ";
+    itsOutput += itsValueFormatter.format(lonlat.lat, itsPrecision);
+  }
+  void operator()(const Fmi::LocalDateTime& ldt) const
+  {
+    std::ostringstream out;
+    out << ldt;
+    itsOutput += out.str();
+  }
+
+ private:
+  std::string& itsOutput;
+  const Fmi::ValueFormatter& itsValueFormatter;
+  int itsPrecision;
+};
+
+// Feed values of the given type starting from the given position, returns the end of the run.
+// The run also ends at a value repeating the previous one.
+template <typename T>
+std::size_t feed_run(Spine::TableVisitor& visitor, const TimeSeries& ts, std::size_t pos)
+{
+  const std::size_t start = pos;
+  const std::size_t n = ts.size();
+  for (; pos < n; ++pos)
+  {
+    const T* value = std::get_if<T>(&ts[pos].value);
+    if (value == nullptr)
+      break;
+    if (pos > start && is_repeated_value(ts[pos - 1].value, ts[pos].value))
+      break;
+    visitor(*value);
+  }
+  return pos;
+}
+
+// Feed values repeating the previous one by copying the cell already formatted for it
+std::size_t feed_repeats(Spine::TableVisitor& visitor,
+                         const Spine::Table& table,
+                         const TimeSeries& ts,
+                         std::size_t pos)
+{
+  const std::string cell = table.get(visitor.getCurrentColumn(), visitor.getCurrentRow() - 1);
+  const std::size_t n = ts.size();
+  for (; pos < n && is_repeated_value(ts[pos - 1].value, ts[pos].value); ++pos)
+    visitor(cell);
+  return pos;
+}
+
+// Times formatted like the timestep: the same instant, and in the same zone unless the
+// times are converted to a fixed zone
+bool same_time(const Fmi::LocalDateTime& ldt, const Fmi::LocalDateTime& timestep, bool converted)
+{
+  if (ldt.utc_time() != timestep.utc_time())
+    return false;
+  if (converted)
+    return true;
+  return (ldt.zone() && timestep.zone() && ldt.zone()->name() == timestep.zone()->name());
+}
+
+// Feed times equal to the respective timesteps of the timeline from the formatted timeline,
+// returns the end of the run
+std::size_t feed_times(Spine::TableVisitor& visitor,
+                       const TimeSeries& ts,
+                       std::size_t pos,
+                       const LocalTimeList& timeline,
+                       const FormattedTimeCache::Strings& times,
+                       bool converted)
+{
+  const std::size_t n = std::min(ts.size(), times.size());
+  if (pos >= n)
+    return pos;
+
+  auto timestep = std::next(timeline.cbegin(), static_cast<std::ptrdiff_t>(pos));
+  for (; pos < n; ++pos, ++timestep)
+  {
+    const auto* ldt = std::get_if<Fmi::LocalDateTime>(&ts[pos].value);
+    if (ldt == nullptr || !same_time(*ldt, *timestep, converted))
+      break;
+    visitor(times[pos]);
+  }
+  return pos;
+}
+
+}  // namespace
+
 const TableFeeder& TableFeeder::operator<<(const TimeSeries& ts)
 {
   try
@@ -13,10 +125,65 @@ const TableFeeder& TableFeeder::operator<<(const TimeSeries& ts)
     if (ts.empty())
       return *this;
 
-    for (const auto& t : ts)
+    // Feed consecutive values of the same type without visiting them one by one, and
+    // format repeated values such as constant columns only once
+
+    const FormattedTimeCache::Strings* times = nullptr;
+    if (itsTimeCache != nullptr && itsTimeline && itsTimeFormatter)
+      times = &itsTimeCache->format(itsTimeline, *itsTimeFormatter, itsTimeZone);
+    const bool converted = !!itsTimeZone;
+
+    const std::size_t n = ts.size();
+    std::size_t pos = 0;
+    while (pos < n)
     {
-      Value val = t.value;
-      std::visit(itsTableVisitor, dynamic_cast<Value_&>(val));
+      const Value& value = ts[pos].value;
+      std::size_t end = pos;
+      if (times != nullptr && std::holds_alternative<Fmi::LocalDateTime>(value))
+        end = feed_times(itsTableVisitor, ts, pos, *itsTimeline, *times, converted);
+
+      if (end > pos)
+        pos = end;
+      else if (pos > 0 && is_repeated_value(ts[pos - 1].value, value))
+        pos = feed_repeats(itsTableVisitor, itsTable, ts, pos);
+      else if (std::holds_alternative<double>(value))
+        pos = feed_run<double>(itsTableVisitor, ts, pos);
+      else if (std::holds_alternative<int>(value))
+        pos = feed_run<int>(itsTableVisitor, ts, pos);
+      else if (std::holds_alternative<std::string>(value))
+        pos = feed_run<std::string>(itsTableVisitor, ts, pos);
+      else
+      {
+        std::visit(itsTableVisitor, static_cast<const Value_&>(value));
+        ++pos;
+      }
+    }
+
+    return *this;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+const TableFeeder& TableFeeder::operator<<(const RunLengthTimeSeries& rts)
+{
+  try
+  {
+    // Each run is formatted once and the formatted cell is copied for the rest of the run
+    std::size_t pos = 0;
+    for (const auto& run : rts.runs())
+    {
+      std::visit(itsTableVisitor, static_cast<const Value_&>(run.value));
+      if (run.end - pos > 1)
+      {
+        const std::string cell = itsTable.get(itsTableVisitor.getCurrentColumn(),
+                                              itsTableVisitor.getCurrentRow() - 1);
+        for (std::size_t i = pos + 1; i < run.end; i++)
+          itsTableVisitor(cell);
+      }
+      pos = run.end;
     }
 
     return *this;
@@ -42,44 +209,40 @@ const TableFeeder& TableFeeder::operator<<(const TimeSeriesGroup& ts_group)
     // several time series
     size_t n_locations = ts_group.size();
     size_t n_timestamps = ts_group[0].timeseries.size();
+
+    // the same buffer is used for all timesteps
+    std::string str_value;
+
     // iterate through timestamps
     for (size_t i = 0; i < n_timestamps; i++)
     {
-      std::stringstream ss;
-      OStreamVisitor ostream_visitor(
-          ss, itsValueFormatter, itsPrecisions[itsTableVisitor.getCurrentColumn()]);
-      ostream_visitor << itsLonLatFormat;
+      AppendVisitor append_visitor(
+          str_value, itsValueFormatter, itsPrecisions[itsTableVisitor.getCurrentColumn()]);
 
       // get values of the same timestep from all locations and concatenate them into one string
-      ss << "[";
+      str_value = "[";
       // iterate through locations
       for (size_t k = 0; k < n_locations; k++)
       {
-        // take time series from k:th location
-        const TimeSeries& timeseries = ts_group[k].timeseries;
-
         if (k > 0)
-          ss << " ";
+          str_value += ' ';
 
-        // take value from i:th timestep
-        Value val = timeseries[i].value;
-        // append value to the ostream
-        std::visit(ostream_visitor, dynamic_cast<const Value_&>(val));
+        // append value from i:th timestep of the k:th location
+        std::visit(append_visitor, static_cast<const Value_&>(ts_group[k].timeseries[i].value));
       }
       // if no data added (timestep not included)
-      if (ss.str().size() == 1)
+      if (str_value.size() == 1)
         continue;
 
-      ss << "]";
-      std::string str_value(ss.str());
+      str_value += ']';
+
       // remove spaces
-      while (str_value[1] == ' ')
-        str_value.erase(1, 1);
-      while (str_value[str_value.size() - 2] == ' ')
-        str_value.erase(str_value.size() - 2, 1);
+      const auto first = str_value.find_first_not_of(' ', 1);
+      str_value.erase(1, first - 1);
+      const auto last = str_value.find_last_not_of(' ', str_value.size() - 2);
+      str_value.erase(last + 1, str_value.size() - 2 - last);
 
-      Value dv = str_value;
-      dv.apply_visitor(itsTableVisitor);
+      itsTableVisitor(str_value);
     }
 
     return *this;
@@ -104,11 +267,7 @@ const TableFeeder& TableFeeder::operator<<(const TimeSeriesVector& ts_vector)
     {
       itsTableVisitor.setCurrentRow(startRow);
 
-      TimeSeries ts(tvalue);
-      for (auto& t : ts)
-      {
-        t.value.apply_visitor(itsTableVisitor);
-      }
+      *this << tvalue;
       itsTableVisitor.setCurrentColumn(itsTableVisitor.getCurrentColumn() + 1);
     }
 
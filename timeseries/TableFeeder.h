@@ -1,5 +1,6 @@
 #pragma once
 
+#include "FormattedTimeCache.h"
 #include "TimeSeries.h"
 #include <macgyver/ValueFormatter.h>
 #include <spine/Table.h>
@@ -15,21 +16,33 @@ namespace TimeSeries
 // feed data to Table
 // usage1: tablefeeder << TimeSeries
 // usage2: tablefeeder << TimeSeriesGroup
+// usage3: tablefeeder << RunLengthTimeSeries
+// usage4: tablefeeder.appendColumn(std::vector<double>)
+//
+// If a time formatter and a FormattedTimeCache are set, times equal to the
+// respective timestep of the timeline are taken from the cache. Each timestep is
+// then formatted only once for all locations and time columns.
 
 class TableFeeder
 {
  private:
+  Spine::Table& itsTable;
   const Fmi::ValueFormatter& itsValueFormatter;
   const std::vector<int>& itsPrecisions;
   Spine::TableVisitor itsTableVisitor;
   Spine::LonLatFormat itsLonLatFormat;
+  std::shared_ptr<Fmi::TimeFormatter> itsTimeFormatter;
+  Fmi::TimeZonePtr itsTimeZone;
+  FormattedTimeCache* itsTimeCache = nullptr;
+  FormattedTimeCache::TimeList itsTimeline;
 
  public:
   TableFeeder(Spine::Table& table,
               const Fmi::ValueFormatter& valueformatter,
               const std::vector<int>& precisions,
               unsigned int currentcolumn = 0)
-      : itsValueFormatter(valueformatter),
+      : itsTable(table),
+        itsValueFormatter(valueformatter),
         itsPrecisions(precisions),
         itsTableVisitor(table, valueformatter, precisions, currentcolumn, currentcolumn),
         itsLonLatFormat(Spine::LonLatFormat::LONLAT)
@@ -43,7 +56,8 @@ class TableFeeder
               const std::shared_ptr<Fmi::TimeFormatter>& timeformatter,
               const std::optional<Fmi::TimeZonePtr>& timezoneptr,
               unsigned int currentcolumn = 0)
-      : itsValueFormatter(valueformatter),
+      : itsTable(table),
+        itsValueFormatter(valueformatter),
         itsPrecisions(precisions),
         itsTableVisitor(table,
                         valueformatter,
@@ -51,7 +65,9 @@ class TableFeeder
                         timeformatter,
                         timezoneptr,
                         currentcolumn,
-                        currentcolumn)
+                        currentcolumn),
+        itsTimeFormatter(timeformatter),
+        itsTimeZone(timezoneptr ? *timezoneptr : Fmi::TimeZonePtr())
   {
   }
 
@@ -67,9 +83,26 @@ class TableFeeder
   const TableFeeder& operator<<(const TimeSeriesGroup& ts_group);
   const TableFeeder& operator<<(const TimeSeriesVector& ts_vector);
   const TableFeeder& operator<<(const std::vector<Value>& value_vector);
+  const TableFeeder& operator<<(const RunLengthTimeSeries& rts);
+
+  // Feed a column of values of a single type, the current row advances by values.size()
+  template <typename T>
+  const TableFeeder& appendColumn(const std::vector<T>& values)
+  {
+    for (const auto& value : values)
+      itsTableVisitor(value);
+    return *this;
+  }
 
   // Set LonLat formatting
   TableFeeder& operator<<(Spine::LonLatFormat newformat);
+
+  // Used only if a time formatter was given. The cache must outlive the feeder.
+  void setTimeCache(FormattedTimeCache& cache, const FormattedTimeCache::TimeList& timeline)
+  {
+    itsTimeCache = &cache;
+    itsTimeline = timeline;
+  }
 };
 
 }  // namespace TimeSeries
@@ -1,20 +1,22 @@
 #include "TimeSeries.h"
 #include <boost/make_shared.hpp>
+#include <macgyver/Exception.h>
 #include <macgyver/Hash.h>
+#include <macgyver/StringConversion.h>
 #include <algorithm>
 
 namespace SmartMet
 {
 namespace TimeSeries
 {
-void TimeSeries::emplace_back(const TimedValue& tv)
+void TimeSeries::push_back(const TimedValue& tv)
 {
-  TimedValueVector::emplace_back(tv);
+  TimedValueVector::push_back(tv);
 }
 
-void TimeSeries::push_back(const TimedValue& tv)
+void TimeSeries::push_back(TimedValue&& tv)
 {
-  TimedValueVector::push_back(tv);
+  TimedValueVector::push_back(std::move(tv));
 }
 
 TimedValueVector::iterator TimeSeries::insert(TimedValueVector::iterator pos, const TimedValue& tv)
@@ -22,6 +24,11 @@ TimedValueVector::iterator TimeSeries::insert(TimedValueVector::iterator pos, co
   return TimedValueVector::insert(pos, tv);
 }
 
+TimedValueVector::iterator TimeSeries::insert(TimedValueVector::iterator pos, TimedValue&& tv)
+{
+  return TimedValueVector::insert(pos, std::move(tv));
+}
+
 void TimeSeries::insert(TimedValueVector::iterator pos,
                         TimedValueVector::iterator first,
                         TimedValueVector::iterator last)
@@ -55,5 +62,132 @@ LocalTimeList TimeSeries::getTimes() const
   return ret;
 }
 
+LocalTimeList pmr::TimeSeries::getTimes() const
+{
+  LocalTimeList ret;
+  std::transform(
+      begin(), end(), std::back_inserter(ret), [](const auto& item) { return item.time; });
+  return ret;
+}
+
+TimeSeries to_heap(const pmr::TimeSeries& ts)
+{
+  TimeSeries ret;
+  ret.assign(ts.begin(), ts.end());
+  return ret;
+}
+
+TimeSeriesGroup to_heap(const pmr::TimeSeriesGroup& tsg)
+{
+  TimeSeriesGroup ret;
+  ret.reserve(tsg.size());
+  for (const auto& llts : tsg)
+    ret.emplace_back(llts.lonlat, to_heap(llts.timeseries));
+  return ret;
+}
+
+TimeSeriesVector to_heap(const pmr::TimeSeriesVector& tsv)
+{
+  TimeSeriesVector ret;
+  ret.reserve(tsv.size());
+  for (const auto& ts : tsv)
+    ret.push_back(to_heap(ts));
+  return ret;
+}
+
+// ----------------------------------------------------------------------
+// RunLengthTimeSeries
+// ----------------------------------------------------------------------
+
+RunLengthTimeSeries::RunLengthTimeSeries(Times times) : itsTimes(std::move(times))
+{
+  if (!itsTimes)
+    throw Fmi::Exception(BCP, "RunLengthTimeSeries requires a timeline");
+}
+
+RunLengthTimeSeries::RunLengthTimeSeries(const Value& value, Times times)
+    : RunLengthTimeSeries(std::move(times))
+{
+  if (!itsTimes->empty())
+    itsRuns.push_back(Run{value, itsTimes->size()});
+}
+
+RunLengthTimeSeries::RunLengthTimeSeries(const TimeSeries& ts)
+    : RunLengthTimeSeries(std::make_shared<const LocalTimeList>(ts.getTimes()))
+{
+  for (const auto& tv : ts)
+    append(tv.value);
+}
+
+void RunLengthTimeSeries::append(const Value& value, std::size_t count)
+{
+  try
+  {
+    if (count == 0)
+      return;
+
+    const std::size_t end = size() + count;
+    if (!itsTimes || end > itsTimes->size())
+      throw Fmi::Exception(BCP, "Too many values for the timeline of a RunLengthTimeSeries")
+          .addParameter("Values", Fmi::to_string(end))
+          .addParameter("Timesteps", Fmi::to_string(itsTimes ? itsTimes->size() : 0));
+
+    if (!itsRuns.empty() && itsRuns.back().value == value)
+      itsRuns.back().end = end;
+    else
+      itsRuns.push_back(Run{value, end});
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+const LocalTimeList& RunLengthTimeSeries::times() const
+{
+  static const LocalTimeList empty_times;
+  return itsTimes ? *itsTimes : empty_times;
+}
+
+std::size_t RunLengthTimeSeries::runIndex(std::size_t pos) const
+{
+  auto it = std::upper_bound(itsRuns.begin(),
+                             itsRuns.end(),
+                             pos,
+                             [](std::size_t p, const Run& run) { return p < run.end; });
+  if (it == itsRuns.end())
+    throw Fmi::Exception(BCP, "RunLengthTimeSeries index out of range")
+        .addParameter("Index", Fmi::to_string(pos))
+        .addParameter("Size", Fmi::to_string(size()));
+  return it - itsRuns.begin();
+}
+
+TimeSeries RunLengthTimeSeries::expand() const
+{
+  try
+  {
+    TimeSeries ts;
+    ts.reserve(size());
+
+    // Values missing from the end of the timeline are not expanded
+    auto time = times().begin();
+    std::size_t pos = 0;
+    for (const auto& run : itsRuns)
+      for (; pos < run.end; ++pos, ++time)
+        ts.emplace_back(*time, run.value);
+    return ts;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+LocalTimeList RunLengthTimeSeries::getTimes() const
+{
+  auto begin = times().begin();
+  return LocalTimeList(begin, std::next(begin, size()));
+}
+
 }  // namespace TimeSeries
 }  // namespace SmartMet
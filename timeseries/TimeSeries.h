@@ -9,8 +9,10 @@
 #include "TimeSeriesTypes.h"
 #include <macgyver/LocalDateTime.h>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -41,10 +43,11 @@ struct Value : public Value_
   {
   }
 
+  // The base class is known statically, no RTTI is needed to visit it
   template <typename VisitorType>
   auto apply_visitor(VisitorType&& visitor) const
   {
-    return std::visit(visitor, dynamic_cast<const Value_&>(*this));
+    return std::visit(std::forward<VisitorType>(visitor), static_cast<const Value_&>(*this));
   }
 
   Value(const Spine::LonLat& x) : Value_(x) {}
@@ -52,8 +55,10 @@ struct Value : public Value_
   Value(const Fmi::LocalDateTime& x) : Value_(x) {}
 
   Value(const Value&) = default;
+  Value(Value&&) = default;
 
   Value& operator=(const Value&) = default;
+  Value& operator=(Value&&) = default;
 
   bool operator==(const Value& other) const;
 
@@ -62,29 +67,40 @@ struct Value : public Value_
   /**
    *   @brief Get double value using supported conversions
    */
-  double as_double() const;
+  double as_double() const
+  {
+    if (const auto* d = std::get_if<double>(static_cast<const Value_*>(this)))
+      return *d;
+    if (const auto* i = std::get_if<int>(static_cast<const Value_*>(this)))
+      return *i;
+    return convert_to_double();
+  }
+
+  int as_int() const
+  {
+    if (const auto* i = std::get_if<int>(static_cast<const Value_*>(this)))
+      return *i;
+    if (const auto* d = std::get_if<double>(static_cast<const Value_*>(this)))
+      return static_cast<int>(*d);
+    return convert_to_int();
+  }
 
-  int as_int() const;
+ private:
+  // Conversions from the other alternatives, which may throw
+  double convert_to_double() const;
+  int convert_to_int() const;
 };
 
 struct TimedValue
 {
-  TimedValue(const Fmi::LocalDateTime& timestamp, const Value& val)
-      : time(const_cast<Fmi::LocalDateTime&>(timestamp)), value(val)
+  TimedValue(Fmi::LocalDateTime timestamp, Value val)
+      : time(std::move(timestamp)), value(std::move(val))
   {
   }
-  TimedValue(const TimedValue& tv) : time(const_cast<Fmi::LocalDateTime&>(tv.time)), value(tv.value)
-  {
-  }
-  TimedValue& operator=(const TimedValue& tv)
-  {
-    if (this != &tv)
-    {
-      time = const_cast<Fmi::LocalDateTime&>(tv.time);
-      value = tv.value;
-    }
-    return *this;
-  }
+  TimedValue(const TimedValue& tv) = default;
+  TimedValue(TimedValue&& tv) = default;
+  TimedValue& operator=(const TimedValue& tv) = default;
+  TimedValue& operator=(TimedValue&& tv) = default;
 
   Fmi::LocalDateTime time;
   Value value;
@@ -97,9 +113,19 @@ class TimeSeries : public TimedValueVector
  public:
   TimeSeries() = default;
   TimeSeries(const TimeSeries&) = default;
-  void emplace_back(const TimedValue& tv);
+  TimeSeries(TimeSeries&&) = default;
+
+  // Construct the value in place, for example emplace_back(time, value)
+  template <typename... Args>
+  TimedValue& emplace_back(Args&&... args)
+  {
+    return TimedValueVector::emplace_back(std::forward<Args>(args)...);
+  }
+
   void push_back(const TimedValue& tv);
+  void push_back(TimedValue&& tv);
   TimedValueVector::iterator insert(TimedValueVector::iterator pos, const TimedValue& tv);
+  TimedValueVector::iterator insert(TimedValueVector::iterator pos, TimedValue&& tv);
   void insert(TimedValueVector::iterator pos,
               TimedValueVector::iterator first,
               TimedValueVector::iterator last);
@@ -107,6 +133,7 @@ class TimeSeries : public TimedValueVector
               TimedValueVector::const_iterator first,
               TimedValueVector::const_iterator last);
   TimeSeries& operator=(const TimeSeries& ts);
+  TimeSeries& operator=(TimeSeries&& ts) = default;
 
   LocalTimeList getTimes() const;
 };
@@ -117,9 +144,14 @@ using TimeSeriesPtr = std::shared_ptr<TimeSeries>;
 // time series result variable for an area
 struct LonLatTimeSeries
 {
-  LonLatTimeSeries(const Spine::LonLat& coord, const TimeSeries& ts) : lonlat(coord), timeseries(ts)
+  LonLatTimeSeries(const Spine::LonLat& coord, TimeSeries ts)
+      : lonlat(coord), timeseries(std::move(ts))
   {
   }
+  LonLatTimeSeries(const LonLatTimeSeries& other) = default;
+  LonLatTimeSeries(LonLatTimeSeries&& other) = default;
+  LonLatTimeSeries& operator=(const LonLatTimeSeries& other) = default;
+  LonLatTimeSeries& operator=(LonLatTimeSeries&& other) = default;
 
   LocalTimeList getTimes() const { return timeseries.getTimes(); }
 
@@ -135,6 +167,187 @@ using TimeSeriesGroupPtr = std::shared_ptr<TimeSeriesGroup>;
 using TimeSeriesVector = std::vector<TimeSeries>;
 using TimeSeriesVectorPtr = std::shared_ptr<TimeSeriesVector>;
 
+// Variants of the containers which allocate from a memory resource such as a
+// RequestArena. They are separate types so that the heap allocated containers
+// above keep their API. Nested series use the memory resource of their container,
+// copies made outside a container use the heap.
+namespace pmr
+{
+using TimedValueVector = std::pmr::vector<TimedValue>;
+
+class TimeSeries : public TimedValueVector
+{
+ public:
+  TimeSeries() = default;
+  TimeSeries(const TimeSeries&) = default;
+  TimeSeries(TimeSeries&&) = default;
+
+  explicit TimeSeries(const allocator_type& alloc) : TimedValueVector(alloc) {}
+  TimeSeries(const TimeSeries& ts, const allocator_type& alloc) : TimedValueVector(ts, alloc) {}
+  TimeSeries(TimeSeries&& ts, const allocator_type& alloc)
+      : TimedValueVector(std::move(ts), alloc)
+  {
+  }
+
+  // Copy heap allocated values to the memory resource
+  explicit TimeSeries(const SmartMet::TimeSeries::TimeSeries& ts, const allocator_type& alloc = {})
+      : TimedValueVector(ts.begin(), ts.end(), alloc)
+  {
+  }
+
+  TimeSeries& operator=(const TimeSeries& ts) = default;
+  TimeSeries& operator=(TimeSeries&& ts) = default;
+
+  LocalTimeList getTimes() const;
+};
+
+using TimeSeriesPtr = std::shared_ptr<TimeSeries>;
+
+struct LonLatTimeSeries
+{
+  using allocator_type = TimeSeries::allocator_type;
+
+  LonLatTimeSeries(const Spine::LonLat& coord, TimeSeries ts)
+      : lonlat(coord), timeseries(std::move(ts))
+  {
+  }
+  LonLatTimeSeries(const Spine::LonLat& coord, TimeSeries ts, const allocator_type& alloc)
+      : lonlat(coord), timeseries(std::move(ts), alloc)
+  {
+  }
+  LonLatTimeSeries(const LonLatTimeSeries& other, const allocator_type& alloc)
+      : lonlat(other.lonlat), timeseries(other.timeseries, alloc)
+  {
+  }
+  LonLatTimeSeries(LonLatTimeSeries&& other, const allocator_type& alloc)
+      : lonlat(other.lonlat), timeseries(std::move(other.timeseries), alloc)
+  {
+  }
+  LonLatTimeSeries(const LonLatTimeSeries& other) = default;
+  LonLatTimeSeries(LonLatTimeSeries&& other) = default;
+  LonLatTimeSeries& operator=(const LonLatTimeSeries& other) = default;
+  LonLatTimeSeries& operator=(LonLatTimeSeries&& other) = default;
+
+  LocalTimeList getTimes() const { return timeseries.getTimes(); }
+
+  Spine::LonLat lonlat;
+  TimeSeries timeseries;
+};
+
+using TimeSeriesGroup = std::pmr::vector<LonLatTimeSeries>;
+using TimeSeriesGroupPtr = std::shared_ptr<TimeSeriesGroup>;
+
+using TimeSeriesVector = std::pmr::vector<TimeSeries>;
+using TimeSeriesVectorPtr = std::shared_ptr<TimeSeriesVector>;
+
+}  // namespace pmr
+
+// Read-only view of the values of a heap or pmr allocated time series, for code which
+// handles both without templates
+class TimedValueView
+{
+ public:
+  TimedValueView() = default;
+  TimedValueView(const TimedValueVector& ts) : itsData(ts.data()), itsSize(ts.size()) {}
+  TimedValueView(const pmr::TimedValueVector& ts) : itsData(ts.data()), itsSize(ts.size()) {}
+
+  std::size_t size() const { return itsSize; }
+  bool empty() const { return itsSize == 0; }
+  const TimedValue& operator[](std::size_t pos) const { return itsData[pos]; }
+  const TimedValue* begin() const { return itsData; }
+  const TimedValue* end() const { return itsData + itsSize; }
+
+ private:
+  const TimedValue* itsData = nullptr;
+  std::size_t itsSize = 0;
+};
+
+// Heap allocated copies of arena data, for example for results which must outlive
+// the request
+TimeSeries to_heap(const pmr::TimeSeries& ts);
+TimeSeriesGroup to_heap(const pmr::TimeSeriesGroup& tsg);
+TimeSeriesVector to_heap(const pmr::TimeSeriesVector& tsv);
+
+// Immutable snapshots which can be shared by concurrent requests, for example via
+// a result cache. Library functions taking a snapshot return a new snapshot instead
+// of modifying their input.
+using TimeSeriesSnapshot = std::shared_ptr<const TimeSeries>;
+using TimeSeriesVectorSnapshot = std::shared_ptr<const TimeSeriesVector>;
+using TimeSeriesGroupSnapshot = std::shared_ptr<const TimeSeriesGroup>;
+
+// Snapshot of a heap allocated copy
+template <typename T>
+std::shared_ptr<const T> make_snapshot(const T& data)
+{
+  return std::shared_ptr<const T>(std::make_shared<T>(data));
+}
+
+// Turn a private heap allocated result into a snapshot without copying it. No other
+// owner of the pointer may modify the data afterwards.
+template <typename T>
+std::shared_ptr<const T> freeze(std::shared_ptr<T>&& data)
+{
+  return std::shared_ptr<const T>(std::move(data));
+}
+
+// Copy on write: a private modifiable copy of a snapshot
+template <typename T>
+std::shared_ptr<T> thaw(const std::shared_ptr<const T>& snapshot)
+{
+  return std::make_shared<T>(*snapshot);
+}
+
+// A time series stored as runs of equal values on a timeline. Data independent
+// parameters such as location names and coordinates are a single run, and the
+// timeline can be shared by all of them.
+class RunLengthTimeSeries
+{
+ public:
+  struct Run
+  {
+    Value value;
+    std::size_t end;  // one past the last timestep of the run
+  };
+
+  using Times = std::shared_ptr<const LocalTimeList>;
+
+  RunLengthTimeSeries() = default;
+
+  // Empty runs on the given timeline, to be filled with append()
+  explicit RunLengthTimeSeries(Times times);
+
+  // The same value at every timestep
+  RunLengthTimeSeries(const Value& value, Times times);
+
+  // Encode a full time series
+  explicit RunLengthTimeSeries(const TimeSeries& ts);
+
+  // Append values, a value equal to the last one extends the last run
+  void append(const Value& value, std::size_t count = 1);
+
+  // Number of values, the timeline is longer only while appending
+  std::size_t size() const { return itsRuns.empty() ? 0 : itsRuns.back().end; }
+  bool empty() const { return size() == 0; }
+  bool isConstant() const { return itsRuns.size() == 1; }
+
+  const LocalTimeList& times() const;
+  const Times& timesPtr() const { return itsTimes; }
+  const std::vector<Run>& runs() const { return itsRuns; }
+
+  // The run containing the given timestep
+  std::size_t runIndex(std::size_t pos) const;
+  const Value& value(std::size_t pos) const { return itsRuns[runIndex(pos)].value; }
+
+  TimeSeries expand() const;
+  LocalTimeList getTimes() const;
+
+ private:
+  Times itsTimes;
+  std::vector<Run> itsRuns;
+};
+
+using RunLengthTimeSeriesPtr = std::shared_ptr<RunLengthTimeSeries>;
+
 }  // namespace TimeSeries
 }  // namespace SmartMet
 
@@ -1,5 +1,6 @@
 #include "TimeSeriesAggregator.h"
 
+#include "AggregationKernels.h"
 #include "Stat.h"
 #include "TimeSeries.h"
 #include "TimeSeriesOutput.h"
@@ -11,9 +12,12 @@
 #include <spine/LonLat.h>
 #include <cmath>
 #include <iostream>
+#include <memory_resource>
 #include <numeric>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
 
 using namespace std;
 using SmartMet::Spine::LonLat;
@@ -45,17 +49,61 @@ class StatCalculator
   LonLat getLonLatStatValue(const DataFunction &func) const;
 
   std::optional<Fmi::LocalDateTime> itsTimestep;
+  Kernel itsKernel = nullptr;
 
  public:
   StatCalculator() = default;
   void operator()(const TimedValue &tv);
   Value getStatValue(const DataFunction &func, bool useWeights) const;
   void setTimestep(const Fmi::LocalDateTime &timestep) { itsTimestep = timestep; }
+
+  // Kernel for numeric data selected with the same function and weighting as getStatValue
+  void setKernel(Kernel kernel) { itsKernel = kernel; }
+
+  // Reuse the allocated space for the next aggregation window
+  void clear()
+  {
+    itsDataVector.clear();
+    itsTimeSeries.clear();
+    itsTimestep.reset();
+  }
 };
 
 namespace
 {
-bool include_value(const TimedValue &tv, const DataFunction &func)
+// True for the pmr variants of the containers
+template <typename Container>
+constexpr bool uses_resource =
+    std::is_same_v<typename Container::allocator_type,
+                   std::pmr::polymorphic_allocator<typename Container::value_type>>;
+
+// The series type of a group
+template <typename Group>
+using SeriesOf = decltype(std::declval<typename Group::value_type>().timeseries);
+
+// Results of the pmr containers are allocated from the memory resource of the input,
+// the results of the ordinary containers from the heap
+template <typename T, typename Container>
+std::shared_ptr<T> make_result(const Container &input)
+{
+  if constexpr (uses_resource<Container>)
+    return std::allocate_shared<T>(
+        std::pmr::polymorphic_allocator<T>(input.get_allocator().resource()));
+  else
+    return std::make_shared<T>();
+}
+
+// Temporaries are allocated like the results
+template <typename T, typename Container>
+T make_temporary(const Container &input)
+{
+  if constexpr (uses_resource<Container>)
+    return T(input.get_allocator());
+  else
+    return T();
+}
+
+bool include_value(const Value &value, const DataFunction &func)
 {
   bool ret = true;
 
@@ -65,11 +113,11 @@ bool include_value(const TimedValue &tv, const DataFunction &func)
       funcId != FunctionId::Count)
   {
     std::optional<double> double_value;
-    if (const double *tmp = std::get_if<double>(&tv.value))
+    if (const double *tmp = std::get_if<double>(&value))
     {
       double_value = *tmp;
     }
-    else if (const int *tmp = std::get_if<int>(&tv.value))
+    else if (const int *tmp = std::get_if<int>(&value))
     {
       double_value = *tmp;
     }
@@ -81,11 +129,17 @@ bool include_value(const TimedValue &tv, const DataFunction &func)
   return ret;
 }
 
-TimeSeries area_aggregate(const TimeSeriesGroup &ts_group, const DataFunction &func)
+bool include_value(const TimedValue &tv, const DataFunction &func)
+{
+  return include_value(tv.value, func);
+}
+
+template <typename Group>
+SeriesOf<Group> area_aggregate(const Group &ts_group, const DataFunction &func)
 {
   try
   {
-    TimeSeries ret;
+    auto ret = make_temporary<SeriesOf<Group>>(ts_group);
 
     if (ts_group.empty())
     {
@@ -95,11 +149,15 @@ TimeSeries area_aggregate(const TimeSeriesGroup &ts_group, const DataFunction &f
     // all time series in the result container are same length, so we use length
     // of the first
     size_t ts_size(ts_group[0].timeseries.size());
+    ret.reserve(ts_size);
+
+    StatCalculator statcalculator;
+    statcalculator.setKernel(select_kernel(func, false));
 
     // iterate through timesteps
     for (size_t i = 0; i < ts_size; i++)
     {
-      StatCalculator statcalculator;
+      statcalculator.clear();
 
       // iterate through locations
       for (const auto &t : ts_group)
@@ -112,7 +170,7 @@ TimeSeries area_aggregate(const TimeSeriesGroup &ts_group, const DataFunction &f
       // inside area)
       const Fmi::LocalDateTime &timestamp = ts_group[0].timeseries[i].time;
 
-      ret.emplace_back(TimedValue(timestamp, statcalculator.getStatValue(func, false)));
+      ret.emplace_back(timestamp, statcalculator.getStatValue(func, false));
     }
 
     return ret;
@@ -165,6 +223,10 @@ double StatCalculator::getDoubleStatValue(const DataFunction &func, bool useWeig
   {
     const double kDoubleMissing = kFloatMissing;
 
+    double result = kDoubleMissing;
+    if (itsKernel != nullptr && itsKernel(itsDataVector, func, kDoubleMissing, result))
+      return result;
+
     Stat::Stat stat(itsDataVector, kDoubleMissing);
     stat.useWeights(useWeights);
     stat.useDegrees(func.isDirFunction());
@@ -428,7 +490,7 @@ Value StatCalculator::getStatValue(const DataFunction &func, bool useWeights) co
       if (result == kFloatMissing &&
           (func.id() == FunctionId::Nearest || func.id() == FunctionId::Interpolate))
         return None();
-      ret = getDoubleStatValue(func, useWeights);
+      ret = result;
     }
     else if (!itsTimeSeries.empty())
     {
@@ -458,9 +520,14 @@ Value StatCalculator::getStatValue(const DataFunction &func, bool useWeights) co
   }
 }
 
-TimeSeriesPtr time_aggregate(const TimeSeries &ts,
-                             const DataFunction &func,
-                             const TimeSeriesGenerator::LocalTimeList &timesteps)
+namespace
+{
+// The aggregation algorithms accept both pre-generated and lazily generated timesteps
+
+template <typename Series, typename Times>
+std::shared_ptr<Series> time_aggregate_series(const Series &ts,
+                                              const DataFunction &func,
+                                              const Times &timesteps)
 try
 {
   const Fmi::TimeDuration &before = Fmi::Minutes(func.getAggregationIntervalBehind());
@@ -469,12 +536,15 @@ try
   auto agg_begin_iter = ts.begin();
   auto agg_end_iter = ts.begin();
 
-  TimeSeriesPtr ret(new TimeSeries);
+  auto ret = make_result<Series>(ts);
 
   // Return empty result if input time series is empty
   if (ts.empty())
     return ret;
 
+  StatCalculator statcalculator;
+  statcalculator.setKernel(select_kernel(func, true));
+
   for (const auto &timestamp : timesteps)
   {
     Fmi::LocalDateTime agg_begin = timestamp - before;
@@ -488,7 +558,7 @@ try
     agg_end_iter = std::find_if(
         agg_end_iter, ts.end(), [&agg_end](const TimedValue &tv) { return tv.time > agg_end; });
 
-    StatCalculator statcalculator;
+    statcalculator.clear();
     statcalculator.setTimestep(timestamp);
 
     for (auto it = agg_begin_iter; it != agg_end_iter; ++it)
@@ -503,7 +573,7 @@ try
         statcalculator(*it);
     }
 
-    ret->emplace_back(TimedValue(timestamp, statcalculator.getStatValue(func, true)));
+    ret->emplace_back(timestamp, statcalculator.getStatValue(func, true));
   }
   return ret;
 }
@@ -512,20 +582,21 @@ catch (...)
   throw Fmi::Exception::Trace(BCP, "Operation failed!");
 }
 
-TimeSeriesGroupPtr time_aggregate(const TimeSeriesGroup &ts_group,
-                                  const DataFunction &func,
-                                  const TimeSeriesGenerator::LocalTimeList &timesteps)
+template <typename Group, typename Times>
+std::shared_ptr<Group> time_aggregate_group(const Group &ts_group,
+                                            const DataFunction &func,
+                                            const Times &timesteps)
 {
   try
   {
-    TimeSeriesGroupPtr ret(new TimeSeriesGroup());
+    auto ret = make_result<Group>(ts_group);
 
     // iterate through locations
+    ret->reserve(ts_group.size());
     for (const auto &t : ts_group)
     {
-      TimeSeries ts(t.timeseries);
-      TimeSeriesPtr aggregated_timeseries(time_aggregate(ts, func, timesteps));
-      ret->emplace_back(t.lonlat, *aggregated_timeseries);
+      auto aggregated_timeseries = time_aggregate_series(t.timeseries, func, timesteps);
+      ret->emplace_back(t.lonlat, std::move(*aggregated_timeseries));
     }
 
     return ret;
@@ -538,49 +609,52 @@ TimeSeriesGroupPtr time_aggregate(const TimeSeriesGroup &ts_group,
 
 // Before only time-aggregation was possible here, but since
 // filtering was added also 'area aggregation' may happen
-TimeSeriesPtr aggregate(const TimeSeries &ts,
-                        const DataFunctions &pf,
-                        const TimeSeriesGenerator::LocalTimeList &timesteps)
+template <typename Series, typename Times>
+std::shared_ptr<Series> aggregate_series(const Series &ts,
+                                         const DataFunctions &pf,
+                                         const Times &timesteps)
 try
 {
-  TimeSeriesPtr ret(new TimeSeries);
+  auto ret = make_result<Series>(ts);
 
   if (pf.innerFunction.type() == FunctionType::AreaFunction)
   {
-    TimeSeries local_ts;
+    auto local_ts = make_temporary<Series>(ts);
+    local_ts.reserve(ts.size());
     // Do filtering
     for (const auto &tv : ts)
     {
       if (include_value(tv, pf.innerFunction))
         local_ts.push_back(tv);
       else
-        local_ts.emplace_back(TimedValue(tv.time, None()));
+        local_ts.emplace_back(tv.time, None());
     }
 
     // Do time aggregationn
     if (pf.outerFunction.type() == FunctionType::TimeFunction)
     {
-      ret = time_aggregate(local_ts, pf.outerFunction, timesteps);
+      ret = time_aggregate_series(local_ts, pf.outerFunction, timesteps);
     }
     else
     {
-      *ret = local_ts;
+      *ret = std::move(local_ts);
     }
   }
   else if (pf.innerFunction.type() == FunctionType::TimeFunction)
   {
-    ret = time_aggregate(ts, pf.innerFunction, timesteps);
+    ret = time_aggregate_series(ts, pf.innerFunction, timesteps);
     if (pf.outerFunction.type() == FunctionType::AreaFunction)
     {
       // Do filtering
-      TimeSeries local_ts = *ret;
+      Series local_ts = std::move(*ret);
       ret->clear();
-      for (const auto &tv : local_ts)
+      ret->reserve(local_ts.size());
+      for (auto &tv : local_ts)
       {
         if (include_value(tv, pf.outerFunction))
-          ret->push_back(tv);
+          ret->push_back(std::move(tv));
         else
-          ret->emplace_back(TimedValue(tv.time, None()));
+          ret->emplace_back(std::move(tv.time), None());
       }
     }
   }
@@ -596,12 +670,13 @@ catch (...)
   throw Fmi::Exception::Trace(BCP, "Operation failed!");
 }
 
-TimeSeriesGroupPtr aggregate(const TimeSeriesGroup &ts_group,
-                             const DataFunctions &pf,
-                             const TimeSeriesGenerator::LocalTimeList &timesteps)
+template <typename Group, typename Times>
+std::shared_ptr<Group> aggregate_group(const Group &ts_group,
+                                       const DataFunctions &pf,
+                                       const Times &timesteps)
 try
 {
-  TimeSeriesGroupPtr ret(new TimeSeriesGroup);
+  auto ret = make_result<Group>(ts_group);
 
   if (ts_group.empty())
   {
@@ -616,12 +691,12 @@ try
 #endif
 
     // 1) do area aggregation
-    TimeSeries area_aggregated_vector = area_aggregate(ts_group, pf.innerFunction);
+    auto area_aggregated_vector = area_aggregate(ts_group, pf.innerFunction);
 
     // 2) do time aggregation
-    TimeSeriesPtr ts = time_aggregate(area_aggregated_vector, pf.outerFunction, timesteps);
+    auto ts = time_aggregate_series(area_aggregated_vector, pf.outerFunction, timesteps);
 
-    ret->emplace_back(ts_group[0].lonlat, *ts);
+    ret->emplace_back(ts_group[0].lonlat, std::move(*ts));
   }
   else if (pf.outerFunction.type() == FunctionType::AreaFunction &&
            pf.innerFunction.type() == FunctionType::TimeFunction)
@@ -630,13 +705,12 @@ try
     cout << "area-time aggregation" << endl;
 #endif
     // 1) do time aggregation
-    TimeSeriesGroupPtr time_aggregated_result =
-        time_aggregate(ts_group, pf.innerFunction, timesteps);
+    auto time_aggregated_result = time_aggregate_group(ts_group, pf.innerFunction, timesteps);
 
     // 2) do area aggregation
-    TimeSeries ts = area_aggregate(*time_aggregated_result, pf.outerFunction);
+    auto ts = area_aggregate(*time_aggregated_result, pf.outerFunction);
 
-    ret->emplace_back(ts_group[0].lonlat, ts);
+    ret->emplace_back(ts_group[0].lonlat, std::move(ts));
   }
   else if (pf.innerFunction.type() == FunctionType::AreaFunction)
   {
@@ -644,9 +718,9 @@ try
     cout << "area aggregation" << endl;
 #endif
     // 1) do area aggregation
-    TimeSeries area_aggregated_vector = area_aggregate(ts_group, pf.innerFunction);
+    auto area_aggregated_vector = area_aggregate(ts_group, pf.innerFunction);
 
-    ret->emplace_back(ts_group[0].lonlat, area_aggregated_vector);
+    ret->emplace_back(ts_group[0].lonlat, std::move(area_aggregated_vector));
   }
   else if (pf.innerFunction.type() == FunctionType::TimeFunction)
   {
@@ -655,7 +729,7 @@ try
 #endif
 
     // 1) do time aggregation
-    ret = time_aggregate(ts_group, pf.innerFunction, timesteps);
+    ret = time_aggregate_group(ts_group, pf.innerFunction, timesteps);
   }
   else
   {
@@ -672,6 +746,307 @@ catch (...)
   throw Fmi::Exception::Trace(BCP, "Operation failed!");
 }
 
+// ----------------------------------------------------------------------
+/*!
+ * \brief The value a time function produces from any number of copies of the given value
+ *
+ * Returns an empty optional if the result depends on the number of values or on their
+ * times, as for sums, counts and interpolation.
+ */
+// ----------------------------------------------------------------------
+
+std::optional<Value> constant_result(const Value &value, const DataFunction &func)
+{
+  const FunctionId id = func.id();
+  const bool extremum = (id == FunctionId::Maximum || id == FunctionId::Minimum);
+
+  // Missing values stay missing, as do values excluded by the limits
+  if (std::holds_alternative<None>(value) || !include_value(value, func))
+    return Value(None());
+
+  // Numbers are aggregated as doubles
+  if (std::holds_alternative<double>(value) || std::holds_alternative<int>(value))
+  {
+    const double d = value.as_double();
+    if ((extremum || id == FunctionId::Median) && !func.isDirFunction() && !std::isnan(d) &&
+        d != kFloatMissing)
+      return Value(d);
+    return {};
+  }
+
+  if (std::holds_alternative<std::string>(value))
+  {
+    switch (id)
+    {
+      case FunctionId::Mean:
+      case FunctionId::Amean:
+      case FunctionId::StandardDeviation:
+      case FunctionId::Percentage:
+      case FunctionId::Change:
+      case FunctionId::Trend:
+      case FunctionId::Maximum:
+      case FunctionId::Minimum:
+      case FunctionId::Median:
+      case FunctionId::Nearest:
+      case FunctionId::Interpolate:
+        return value;
+      default:
+        return {};
+    }
+  }
+
+  if (std::holds_alternative<Fmi::LocalDateTime>(value) && (extremum || id == FunctionId::Median))
+    return value;
+
+  if (std::holds_alternative<LonLat>(value) && extremum)
+    return value;
+
+  return {};
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Time aggregation of a constant series
+ *
+ * Each timestep gets the constant result if there is any data in its
+ * aggregation interval, and a missing value otherwise.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Times>
+RunLengthTimeSeriesPtr constant_time_aggregate(const RunLengthTimeSeries &rts,
+                                               const Value &result,
+                                               const DataFunction &func,
+                                               const Times &timesteps)
+{
+  const Fmi::TimeDuration &before = Fmi::Minutes(func.getAggregationIntervalBehind());
+  const Fmi::TimeDuration &after = Fmi::Minutes(func.getAggregationIntervalAhead());
+
+  auto times = std::make_shared<LocalTimeList>();
+  std::vector<bool> has_data;
+
+  const auto &data_times = rts.times();
+  auto agg_begin_iter = data_times.begin();
+
+  for (const auto &timestamp : timesteps)
+  {
+    Fmi::LocalDateTime agg_begin = timestamp - before;
+    Fmi::LocalDateTime agg_end = timestamp + after;
+
+    agg_begin_iter =
+        std::find_if(agg_begin_iter,
+                     data_times.end(),
+                     [&agg_begin](const Fmi::LocalDateTime &t) { return t >= agg_begin; });
+
+    times->push_back(timestamp);
+    has_data.push_back(agg_begin_iter != data_times.end() && *agg_begin_iter <= agg_end);
+  }
+
+  auto ret = std::make_shared<RunLengthTimeSeries>(times);
+  for (bool data : has_data)
+    ret->append(data ? result : Value(None()));
+  return ret;
+}
+
+// Returns nullptr if the input is not constant or the functions do not reproduce it
+template <typename Times>
+RunLengthTimeSeriesPtr constant_aggregate(const RunLengthTimeSeries &rts,
+                                          const DataFunctions &pf,
+                                          const Times &timesteps)
+{
+  if (!rts.isConstant())
+    return nullptr;
+
+  const Value &value = rts.runs().front().value;
+
+  if (pf.innerFunction.type() == FunctionType::AreaFunction)
+  {
+    // Filtering
+    const Value filtered = (include_value(value, pf.innerFunction) ? value : Value(None()));
+
+    if (pf.outerFunction.type() != FunctionType::TimeFunction)
+      return std::make_shared<RunLengthTimeSeries>(filtered, rts.timesPtr());
+
+    const auto result = constant_result(filtered, pf.outerFunction);
+    if (!result)
+      return nullptr;
+    return constant_time_aggregate(rts, *result, pf.outerFunction, timesteps);
+  }
+
+  if (pf.innerFunction.type() == FunctionType::TimeFunction)
+  {
+    auto result = constant_result(value, pf.innerFunction);
+    if (!result)
+      return nullptr;
+
+    // Filtering
+    if (pf.outerFunction.type() == FunctionType::AreaFunction &&
+        !include_value(*result, pf.outerFunction))
+      result = Value(None());
+
+    return constant_time_aggregate(rts, *result, pf.innerFunction, timesteps);
+  }
+
+  return std::make_shared<RunLengthTimeSeries>(rts);
+}
+
+template <typename Times>
+RunLengthTimeSeriesPtr aggregate_impl(const RunLengthTimeSeries &rts,
+                                      const DataFunctions &pf,
+                                      const Times &timesteps)
+try
+{
+  if (auto ret = constant_aggregate(rts, pf, timesteps))
+    return ret;
+
+  const auto ts = aggregate_series(rts.expand(), pf, timesteps);
+  return std::make_shared<RunLengthTimeSeries>(*ts);
+}
+catch (...)
+{
+  throw Fmi::Exception::Trace(BCP, "Operation failed!");
+}
+
+}  // namespace
+
+TimeSeriesPtr time_aggregate(const TimeSeries &ts,
+                             const DataFunction &func,
+                             const TimeSeriesGenerator::LocalTimeList &timesteps)
+{
+  return time_aggregate_series(ts, func, timesteps);
+}
+
+TimeSeriesPtr time_aggregate(const TimeSeries &ts,
+                             const DataFunction &func,
+                             const TimeSeriesGenerator::LocalTimeRange &timesteps)
+{
+  return time_aggregate_series(ts, func, timesteps);
+}
+
+TimeSeriesPtr aggregate(const TimeSeries &ts,
+                        const DataFunctions &pf,
+                        const TimeSeriesGenerator::LocalTimeList &timesteps)
+{
+  return aggregate_series(ts, pf, timesteps);
+}
+
+TimeSeriesPtr aggregate(const TimeSeries &ts,
+                        const DataFunctions &pf,
+                        const TimeSeriesGenerator::LocalTimeRange &timesteps)
+{
+  return aggregate_series(ts, pf, timesteps);
+}
+
+TimeSeriesGroupPtr aggregate(const TimeSeriesGroup &ts_group,
+                             const DataFunctions &pf,
+                             const TimeSeriesGenerator::LocalTimeList &timesteps)
+{
+  return aggregate_group(ts_group, pf, timesteps);
+}
+
+TimeSeriesGroupPtr aggregate(const TimeSeriesGroup &ts_group,
+                             const DataFunctions &pf,
+                             const TimeSeriesGenerator::LocalTimeRange &timesteps)
+{
+  return aggregate_group(ts_group, pf, timesteps);
+}
+
+pmr::TimeSeriesPtr aggregate(const pmr::TimeSeries &ts,
+                             const DataFunctions &pf,
+                             const TimeSeriesGenerator::LocalTimeList &timesteps)
+{
+  return aggregate_series(ts, pf, timesteps);
+}
+
+pmr::TimeSeriesPtr aggregate(const pmr::TimeSeries &ts,
+                             const DataFunctions &pf,
+                             const TimeSeriesGenerator::LocalTimeRange &timesteps)
+{
+  return aggregate_series(ts, pf, timesteps);
+}
+
+pmr::TimeSeriesGroupPtr aggregate(const pmr::TimeSeriesGroup &ts_group,
+                                  const DataFunctions &pf,
+                                  const TimeSeriesGenerator::LocalTimeList &timesteps)
+{
+  return aggregate_group(ts_group, pf, timesteps);
+}
+
+pmr::TimeSeriesGroupPtr aggregate(const pmr::TimeSeriesGroup &ts_group,
+                                  const DataFunctions &pf,
+                                  const TimeSeriesGenerator::LocalTimeRange &timesteps)
+{
+  return aggregate_group(ts_group, pf, timesteps);
+}
+
+TimeSeriesPtr area_aggregate(const FloatColumns &columns, const DataFunction &func)
+{
+  try
+  {
+    auto ret = std::make_shared<TimeSeries>();
+    ret->reserve(columns.size());
+
+    // The float kernels cannot skip missing values or values outside the limits
+    const FunctionId funcId = func.id();
+    const bool filtered = (func.isNanFunction() ||
+                           (func.lowerOrUpperLimitGiven() && funcId != FunctionId::Percentage &&
+                            funcId != FunctionId::Count));
+    const FloatKernel kernel = (filtered ? nullptr : select_float_kernel(func));
+
+    StatCalculator statcalculator;
+    statcalculator.setKernel(select_kernel(func, false));
+
+    for (const auto &column : columns)
+    {
+      if (kernel != nullptr)
+      {
+        // Missing values and empty columns produce a missing result
+        const double result =
+            kernel(column.values.data(), column.values.size(), func, kFloatMissing);
+        if (result == kFloatMissing)
+          ret->emplace_back(column.time, None());
+        else
+          ret->emplace_back(column.time, result);
+        continue;
+      }
+
+      statcalculator.clear();
+      for (const float value : column.values)
+      {
+        if (value == kFloatMissing)
+          statcalculator(TimedValue(column.time, None()));
+        else
+        {
+          TimedValue tv(column.time, static_cast<double>(value));
+          if (include_value(tv, func))
+            statcalculator(tv);
+        }
+      }
+      ret->emplace_back(column.time, statcalculator.getStatValue(func, false));
+    }
+
+    return ret;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+RunLengthTimeSeriesPtr aggregate(const RunLengthTimeSeries &rts,
+                                 const DataFunctions &pf,
+                                 const TimeSeriesGenerator::LocalTimeList &timesteps)
+{
+  return aggregate_impl(rts, pf, timesteps);
+}
+
+RunLengthTimeSeriesPtr aggregate(const RunLengthTimeSeries &rts,
+                                 const DataFunctions &pf,
+                                 const TimeSeriesGenerator::LocalTimeRange &timesteps)
+{
+  return aggregate_impl(rts, pf, timesteps);
+}
+
 }  // namespace Aggregator
 }  // namespace TimeSeries
 }  // namespace SmartMet
@@ -12,6 +12,7 @@
 #include <macgyver/Exception.h>
 
 #include <stdexcept>
+#include <vector>
 
 namespace SmartMet
 {
@@ -27,6 +28,63 @@ TimeSeriesGroupPtr aggregate(const TimeSeriesGroup& ts_group,
                              const DataFunctions& pf,
                              const TimeSeriesGenerator::LocalTimeList& timesteps);
 
+// Lazily generated timesteps avoid materializing very long timelines. Note that
+// each location in a group iterates the timesteps again.
+
+TimeSeriesPtr aggregate(const TimeSeries& ts,
+                        const DataFunctions& pf,
+                        const TimeSeriesGenerator::LocalTimeRange& timesteps);
+
+TimeSeriesGroupPtr aggregate(const TimeSeriesGroup& ts_group,
+                             const DataFunctions& pf,
+                             const TimeSeriesGenerator::LocalTimeRange& timesteps);
+
+// Series allocated from a memory resource such as a RequestArena are aggregated into
+// results and temporaries allocated from the same resource.
+
+pmr::TimeSeriesPtr aggregate(const pmr::TimeSeries& ts,
+                             const DataFunctions& pf,
+                             const TimeSeriesGenerator::LocalTimeList& timesteps);
+
+pmr::TimeSeriesPtr aggregate(const pmr::TimeSeries& ts,
+                             const DataFunctions& pf,
+                             const TimeSeriesGenerator::LocalTimeRange& timesteps);
+
+pmr::TimeSeriesGroupPtr aggregate(const pmr::TimeSeriesGroup& ts_group,
+                                  const DataFunctions& pf,
+                                  const TimeSeriesGenerator::LocalTimeList& timesteps);
+
+pmr::TimeSeriesGroupPtr aggregate(const pmr::TimeSeriesGroup& ts_group,
+                                  const DataFunctions& pf,
+                                  const TimeSeriesGenerator::LocalTimeRange& timesteps);
+
+// Run-length encoded input is aggregated without expanding it when the functions
+// reproduce a constant input value, for example minimum, maximum and median.
+// Otherwise the series is expanded and the result is encoded again.
+
+RunLengthTimeSeriesPtr aggregate(const RunLengthTimeSeries& rts,
+                                 const DataFunctions& pf,
+                                 const TimeSeriesGenerator::LocalTimeList& timesteps);
+
+RunLengthTimeSeriesPtr aggregate(const RunLengthTimeSeries& rts,
+                                 const DataFunctions& pf,
+                                 const TimeSeriesGenerator::LocalTimeRange& timesteps);
+
+// Values of all locations of an area at one time, for example querydata values.
+// Missing values are kFloatMissing.
+struct FloatColumn
+{
+  Fmi::LocalDateTime time;
+  std::vector<float> values;
+};
+
+using FloatColumns = std::vector<FloatColumn>;
+
+// Area aggregation of float32 columns. The result equals that of a TimeSeriesGroup of the
+// same values up to rounding, but functions with a float kernel aggregate the columns
+// without converting the values.
+TimeSeriesPtr area_aggregate(const FloatColumns& columns, const DataFunction& func);
+
 TimedValue time_aggregate(const TimeSeries& ts,
                           const DataFunction& func,
                           const Fmi::LocalDateTime& timestep);
@@ -44,6 +102,10 @@ TimeSeriesPtr time_aggregate(const TimeSeries& ts,
                              const DataFunction& func,
                              const TimeSeriesGenerator::LocalTimeList& timesteps);
 
+TimeSeriesPtr time_aggregate(const TimeSeries& ts,
+                             const DataFunction& func,
+                             const TimeSeriesGenerator::LocalTimeRange& timesteps);
+
 }  // namespace Aggregator
 }  // namespace TimeSeries
 }  // namespace SmartMet
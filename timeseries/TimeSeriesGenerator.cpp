@@ -7,6 +7,7 @@
 #include "TimeSeriesGenerator.h"
 #include <macgyver/Exception.h>
 #include <macgyver/TimeParser.h>
+#include <algorithm>
 
 namespace SmartMet
 {
@@ -443,6 +444,122 @@ void generate_graphtimes(std::set<Fmi::LocalDateTime>& theTimes,
   }
 }
 
+// ----------------------------------------------------------------------
+/*!
+ * \brief Establish the start and end times in the given timezone
+ *
+ * Returns false if the times are to be taken from empty data.
+ */
+// ----------------------------------------------------------------------
+
+bool resolve_period(Fmi::LocalDateTime& theStartTime,
+                    Fmi::LocalDateTime& theEndTime,
+                    const TimeSeriesGeneratorOptions& theOptions,
+                    const Fmi::TimeZonePtr& theZone)
+{
+  // Adjust to given timezone if input was not UTC. Note that if start and end times
+  // are omitted, we use the data times for climatology data just like for normal data.
+
+  if (theOptions.startTimeData)
+  {
+    if (theOptions.getDataTimes()->empty())
+      return false;
+    theStartTime = Fmi::LocalDateTime(theOptions.getDataTimes()->front(), theZone);
+  }
+  else if (!theOptions.startTimeUTC)
+    theStartTime = Fmi::TimeParser::make_time(
+        theOptions.startTime.date(), theOptions.startTime.time_of_day(), theZone);
+  else
+    theStartTime = Fmi::LocalDateTime(theOptions.startTime, theZone);
+
+  if (theOptions.endTimeData)
+  {
+    if (theOptions.getDataTimes()->empty())
+      return false;
+    theEndTime = Fmi::LocalDateTime(theOptions.getDataTimes()->back(), theZone);
+  }
+  else if (!theOptions.endTimeUTC)
+    theEndTime = Fmi::TimeParser::make_time(
+        theOptions.endTime.date(), theOptions.endTime.time_of_day(), theZone);
+  else
+    theEndTime = Fmi::LocalDateTime(theOptions.endTime, theZone);
+
+  return true;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Apply the timesteps option to a size estimate
+ *
+ * The generators test the limit only after inserting a time, hence
+ * a zero limit may still produce one time.
+ */
+// ----------------------------------------------------------------------
+
+std::size_t apply_timesteps_limit(std::size_t theSize, const TimeSeriesGeneratorOptions& theOptions)
+{
+  if (!theOptions.timeSteps)
+    return theSize;
+  return std::min<std::size_t>(theSize, std::max(1U, *theOptions.timeSteps));
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Upper bound for the number of generated times
+ *
+ * Local wall clock times are iterated, hence the bounds are based on
+ * the local time span with an hour of slack at both ends for daylight
+ * saving time changes.
+ */
+// ----------------------------------------------------------------------
+
+std::size_t estimate_max_size(const TimeSeriesGeneratorOptions& theOptions,
+                              const Fmi::LocalDateTime& theStartTime,
+                              const Fmi::LocalDateTime& theEndTime)
+{
+  const long span = (theEndTime.local_time() - theStartTime.local_time()).total_seconds() / 60;
+
+  switch (theOptions.mode)
+  {
+    case TimeSeriesGeneratorOptions::TimeSteps:
+    {
+      unsigned int timestep = (!theOptions.timeStep ? default_timestep : *theOptions.timeStep);
+      if (timestep == 0)
+        return 2;
+      if (span < 0)
+        return 1;
+      return apply_timesteps_limit((span + 2 * 60) / timestep + 1, theOptions);
+    }
+    case TimeSeriesGeneratorOptions::FixedTimes:
+    {
+      if (theOptions.timeList.empty())
+        return 0;
+      if (!!theOptions.timeSteps)
+        return std::max(1U, *theOptions.timeSteps);
+      if (span < 0)
+        return 0;
+      const std::size_t days = span / (24 * 60) + 2;
+      return days * theOptions.timeList.size();
+    }
+    case TimeSeriesGeneratorOptions::DataTimes:
+    case TimeSeriesGeneratorOptions::GraphTimes:
+    {
+      std::size_t n = theOptions.getDataTimes()->size();
+      if (theOptions.isClimatology)
+      {
+        const int years = theEndTime.date().year() - theStartTime.date().year() + 1;
+        n *= std::max(0, years);
+      }
+      n = apply_timesteps_limit(n, theOptions);
+      if (theOptions.mode == TimeSeriesGeneratorOptions::GraphTimes)
+        ++n;
+      return n;
+    }
+  }
+  // NOTREACHED
+  return 0;
+}
+
 }  // namespace
 
 // ----------------------------------------------------------------------
@@ -461,32 +578,8 @@ LocalTimeList generate(const TimeSeriesGeneratorOptions& theOptions,
     Fmi::LocalDateTime starttime(Fmi::LocalDateTime::NOT_A_DATE_TIME);
     Fmi::LocalDateTime endtime(Fmi::LocalDateTime::NOT_A_DATE_TIME);
 
-    // Adjust to given timezone if input was not UTC. Note that if start and end times
-    // are omitted, we use the data times for climatology data just like for normal data.
-
-    if (theOptions.startTimeData)
-    {
-      if (theOptions.getDataTimes()->empty())
-        return {};
-      starttime = Fmi::LocalDateTime(theOptions.getDataTimes()->front(), theZone);
-    }
-    else if (!theOptions.startTimeUTC)
-      starttime = Fmi::TimeParser::make_time(
-          theOptions.startTime.date(), theOptions.startTime.time_of_day(), theZone);
-    else
-      starttime = Fmi::LocalDateTime(theOptions.startTime, theZone);
-
-    if (theOptions.endTimeData)
-    {
-      if (theOptions.getDataTimes()->empty())
-        return {};
-      endtime = Fmi::LocalDateTime(theOptions.getDataTimes()->back(), theZone);
-    }
-    else if (!theOptions.endTimeUTC)
-      endtime = Fmi::TimeParser::make_time(
-          theOptions.endTime.date(), theOptions.endTime.time_of_day(), theZone);
-    else
-      endtime = Fmi::LocalDateTime(theOptions.endTime, theZone);
+    if (!resolve_period(starttime, endtime, theOptions, theZone))
+      return {};
 
     // Start generating a set of unique local times
 
@@ -520,6 +613,323 @@ LocalTimeList generate(const TimeSeriesGeneratorOptions& theOptions,
   }
 }
 
+// ----------------------------------------------------------------------
+/*!
+ * \brief Extend previously generated data times
+ *
+ * theTimes must have been generated with identical options whose data
+ * times were a prefix of the current ones, and theFirstNewTime must
+ * point to the first appended data time. Since appending data times
+ * can only extend the period when the end time is taken from the data,
+ * the new times can simply be appended to the old ones as long as they
+ * are later than the old ones. Otherwise false is returned.
+ */
+// ----------------------------------------------------------------------
+
+bool extend(LocalTimeList& theTimes,
+            const TimeSeriesGeneratorOptions& theOptions,
+            const Fmi::TimeZonePtr& theZone,
+            std::list<Fmi::DateTime>::const_iterator theFirstNewTime)
+{
+  try
+  {
+    if (theOptions.isClimatology || (theOptions.mode != TimeSeriesGeneratorOptions::DataTimes &&
+                                     theOptions.mode != TimeSeriesGeneratorOptions::GraphTimes))
+      return false;
+
+    Fmi::LocalDateTime starttime(Fmi::LocalDateTime::NOT_A_DATE_TIME);
+    Fmi::LocalDateTime endtime(Fmi::LocalDateTime::NOT_A_DATE_TIME);
+
+    if (!resolve_period(starttime, endtime, theOptions, theZone))
+      return false;
+
+    // The earlier end time may have been accepted only since it was the end time
+
+    if (!theOptions.timeSteps && !theTimes.empty() && theTimes.front() < starttime)
+      return false;
+
+    Fmi::LocalTimePeriod period(starttime, endtime);
+
+    const auto datatimes_end = theOptions.getDataTimes()->end();
+    for (auto it = theFirstNewTime; it != datatimes_end; ++it)
+    {
+      // The size test is done after each insert in collect_datatimes_with_limit
+      if (!!theOptions.timeSteps && theTimes.size() >= *theOptions.timeSteps)
+        break;
+
+      Fmi::LocalDateTime lt(*it, theZone);
+      if (!passes_day_filter(lt, theOptions.days))
+        continue;
+
+      if (!!theOptions.timeSteps ? lt < starttime : !(period.contains(lt) || lt == endtime))
+        continue;
+
+      if (!theTimes.empty() && !(theTimes.back() < lt))
+      {
+        if (theTimes.back() == lt)
+          continue;
+        return false;  // not an append, the times would have to be sorted again
+      }
+      theTimes.push_back(lt);
+    }
+    return true;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Upper bound for the number of times generate() would return
+ */
+// ----------------------------------------------------------------------
+
+std::size_t max_size(const TimeSeriesGeneratorOptions& theOptions, const Fmi::TimeZonePtr& theZone)
+{
+  try
+  {
+    Fmi::LocalDateTime starttime(Fmi::LocalDateTime::NOT_A_DATE_TIME);
+    Fmi::LocalDateTime endtime(Fmi::LocalDateTime::NOT_A_DATE_TIME);
+
+    if (!resolve_period(starttime, endtime, theOptions, theZone))
+      return 0;
+
+    return estimate_max_size(theOptions, starttime, endtime);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Select the generation algorithm
+ *
+ * Plain data times are generated lazily only if they are strictly
+ * increasing, since otherwise generate() would sort and unique them.
+ */
+// ----------------------------------------------------------------------
+
+LocalTimeRange::LocalTimeRange(const TimeSeriesGeneratorOptions& theOptions,
+                               const Fmi::TimeZonePtr& theZone)
+    : itsOptions(theOptions), itsZone(theZone)
+{
+  try
+  {
+    if (!resolve_period(itsStartTime, itsEndTime, itsOptions, itsZone))
+      return;
+
+    itsMaxSize = estimate_max_size(itsOptions, itsStartTime, itsEndTime);
+
+    if (itsOptions.mode == TimeSeriesGeneratorOptions::TimeSteps)
+    {
+      itsTimeStep = (!itsOptions.timeStep ? default_timestep : *itsOptions.timeStep);
+      if (itsTimeStep > 0)
+      {
+        itsAlgorithm = Algorithm::TimeSteps;
+        return;
+      }
+    }
+    else if (itsOptions.mode == TimeSeriesGeneratorOptions::DataTimes &&
+             !itsOptions.isClimatology)
+    {
+      const auto& datatimes = *itsOptions.getDataTimes();
+      if (std::adjacent_find(datatimes.begin(),
+                             datatimes.end(),
+                             [](const Fmi::DateTime& t1, const Fmi::DateTime& t2)
+                             { return !(t1 < t2); }) == datatimes.end())
+      {
+        itsAlgorithm = Algorithm::DataTimes;
+        return;
+      }
+    }
+
+    itsTimes = generate(itsOptions, itsZone);
+    itsAlgorithm = Algorithm::List;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+LocalTimeRange::const_iterator LocalTimeRange::begin() const
+{
+  if (itsAlgorithm == Algorithm::Empty)
+    return end();
+  return const_iterator(this);
+}
+
+LocalTimeRange::const_iterator::const_iterator(const LocalTimeRange* theRange) : itsRange(theRange)
+{
+  switch (itsRange->itsAlgorithm)
+  {
+    case Algorithm::TimeSteps:
+      itsDay = itsRange->itsStartTime.local_time().date();
+      break;
+    case Algorithm::DataTimes:
+      itsDataTime = itsRange->itsOptions.getDataTimes()->begin();
+      break;
+    case Algorithm::List:
+      itsListedTime = itsRange->itsTimes.begin();
+      break;
+    case Algorithm::Empty:
+      break;
+  }
+  next();
+}
+
+LocalTimeRange::const_iterator& LocalTimeRange::const_iterator::operator++()
+{
+  ++itsCount;
+  next();
+  return *this;
+}
+
+LocalTimeRange::const_iterator LocalTimeRange::const_iterator::operator++(int)
+{
+  const_iterator tmp(*this);
+  operator++();
+  return tmp;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Advance to the next time, or to the end
+ */
+// ----------------------------------------------------------------------
+
+void LocalTimeRange::const_iterator::next()
+{
+  try
+  {
+    bool ok = false;
+    switch (itsRange->itsAlgorithm)
+    {
+      case Algorithm::TimeSteps:
+        ok = next_timestep();
+        break;
+      case Algorithm::DataTimes:
+        ok = next_datatime();
+        break;
+      case Algorithm::List:
+        ok = next_listed_time();
+        break;
+      case Algorithm::Empty:
+        break;
+    }
+    if (!ok)
+      *this = const_iterator();
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Lazy version of generate_timesteps
+ */
+// ----------------------------------------------------------------------
+
+bool LocalTimeRange::const_iterator::next_timestep()
+{
+  const auto& options = itsRange->itsOptions;
+  const auto& starttime = itsRange->itsStartTime;
+  const auto& endtime = itsRange->itsEndTime;
+  const Fmi::LocalTimePeriod period(starttime, endtime);
+
+  while (!itsStopped)
+  {
+    if (itsMinutes >= 24 * 60)
+    {
+      itsMinutes -= 24 * 60;
+      itsDay++;
+    }
+
+    Fmi::LocalDateTime t =
+        Fmi::TimeParser::make_time(itsDay, Fmi::Minutes(itsMinutes), itsRange->itsZone);
+
+    if (t > endtime)
+      return false;
+
+    itsMinutes += itsRange->itsTimeStep;
+
+    if (!options.days.empty() && options.days.find(itsDay.day()) == options.days.end())
+      continue;
+
+    bool valid = !t.is_not_a_date_time();
+    if (!!options.timeSteps)
+      valid = valid && t >= starttime;
+    else
+      valid = valid && (period.contains(t) || t == endtime);
+
+    // Skip duplicates caused by daylight saving time changes
+    valid = valid && (itsCount == 0 || t > itsTime);
+
+    // The limit is tested after each insert attempt just like in generate_timesteps
+    if (!!options.timeSteps && itsCount + (valid ? 1 : 0) >= *options.timeSteps)
+      itsStopped = true;
+
+    if (valid)
+    {
+      itsTime = t;
+      return true;
+    }
+  }
+  return false;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Lazy version of generate_datatimes_normal
+ */
+// ----------------------------------------------------------------------
+
+bool LocalTimeRange::const_iterator::next_datatime()
+{
+  const auto& options = itsRange->itsOptions;
+  const auto& starttime = itsRange->itsStartTime;
+  const auto& endtime = itsRange->itsEndTime;
+  const Fmi::LocalTimePeriod period(starttime, endtime);
+
+  if (!!options.timeSteps && itsCount >= *options.timeSteps)
+    return false;
+
+  const auto datatimes_end = options.getDataTimes()->end();
+  while (itsDataTime != datatimes_end)
+  {
+    Fmi::LocalDateTime lt(*itsDataTime++, itsRange->itsZone);
+    if (!passes_day_filter(lt, options.days))
+      continue;
+
+    if (!!options.timeSteps ? lt >= starttime : (period.contains(lt) || lt == endtime))
+    {
+      itsTime = lt;
+      return true;
+    }
+  }
+  return false;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Iterate over times generated in advance
+ */
+// ----------------------------------------------------------------------
+
+bool LocalTimeRange::const_iterator::next_listed_time()
+{
+  if (itsListedTime == itsRange->itsTimes.end())
+    return false;
+  itsTime = *itsListedTime++;
+  return true;
+}
+
 }  // namespace TimeSeriesGenerator
 }  // namespace TimeSeries
 }  // namespace SmartMet
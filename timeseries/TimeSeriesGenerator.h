@@ -10,6 +10,8 @@
 #include "TimeSeriesTypes.h"
 
 #include <macgyver/LocalDateTime.h>
+#include <cstddef>
+#include <iterator>
 #include <list>
 #include <string>
 
@@ -24,6 +26,107 @@ using LocalTimeList = ::SmartMet::TimeSeries::LocalTimeList;
 LocalTimeList generate(const TimeSeriesGeneratorOptions& theOptions,
                        const Fmi::TimeZonePtr& theZone);
 
+// Extend times generated earlier for a prefix of the current data times. Returns false
+// if the times cannot be extended incrementally and must be regenerated.
+bool extend(LocalTimeList& theTimes,
+            const TimeSeriesGeneratorOptions& theOptions,
+            const Fmi::TimeZonePtr& theZone,
+            std::list<Fmi::DateTime>::const_iterator theFirstNewTime);
+
+// Upper bound for the number of times generate() would return, computed in O(1)
+std::size_t max_size(const TimeSeriesGeneratorOptions& theOptions, const Fmi::TimeZonePtr& theZone);
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Lazily generated time series
+ *
+ * A forward range producing the same times as generate() on demand.
+ * Fixed timesteps and plain data times are produced one at a time,
+ * the remaining modes are generated into an internal list when the
+ * range is constructed.
+ */
+// ----------------------------------------------------------------------
+
+class LocalTimeRange
+{
+ public:
+  class const_iterator
+  {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Fmi::LocalDateTime;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Fmi::LocalDateTime*;
+    using reference = const Fmi::LocalDateTime&;
+
+    const_iterator() = default;
+
+    reference operator*() const { return itsTime; }
+    pointer operator->() const { return &itsTime; }
+
+    const_iterator& operator++();
+    const_iterator operator++(int);
+
+    bool operator==(const const_iterator& other) const
+    {
+      return itsRange == other.itsRange && itsCount == other.itsCount;
+    }
+    bool operator!=(const const_iterator& other) const { return !operator==(other); }
+
+   private:
+    friend class LocalTimeRange;
+    explicit const_iterator(const LocalTimeRange* theRange);
+
+    void next();
+    bool next_timestep();
+    bool next_datatime();
+    bool next_listed_time();
+
+    const LocalTimeRange* itsRange = nullptr;  // nullptr marks the end
+    Fmi::LocalDateTime itsTime{Fmi::LocalDateTime::NOT_A_DATE_TIME};
+    std::size_t itsCount = 0;  // number of times produced so far
+    bool itsStopped = false;   // timesteps limit was reached
+
+    // Algorithm::TimeSteps state
+    Fmi::Date itsDay;
+    unsigned int itsMinutes = 0;
+
+    // Algorithm::DataTimes and Algorithm::List state
+    std::list<Fmi::DateTime>::const_iterator itsDataTime;
+    LocalTimeList::const_iterator itsListedTime;
+  };
+
+  using iterator = const_iterator;
+  using value_type = Fmi::LocalDateTime;
+
+  LocalTimeRange(const TimeSeriesGeneratorOptions& theOptions, const Fmi::TimeZonePtr& theZone);
+
+  const_iterator begin() const;
+  const_iterator end() const { return {}; }
+  bool empty() const { return begin() == end(); }
+
+  // O(1) upper bound for the number of times in the range
+  std::size_t max_size() const { return itsMaxSize; }
+
+ private:
+  enum class Algorithm
+  {
+    Empty,      // nothing to generate
+    TimeSteps,  // fixed timestep produced on demand
+    DataTimes,  // data times converted on demand
+    List        // generated in advance
+  };
+
+  TimeSeriesGeneratorOptions itsOptions;
+  Fmi::TimeZonePtr itsZone;
+  Fmi::LocalDateTime itsStartTime{Fmi::LocalDateTime::NOT_A_DATE_TIME};
+  Fmi::LocalDateTime itsEndTime{Fmi::LocalDateTime::NOT_A_DATE_TIME};
+  Algorithm itsAlgorithm = Algorithm::Empty;
+  unsigned int itsTimeStep = 0;
+  std::size_t itsMaxSize = 0;
+  LocalTimeList itsTimes;  // Algorithm::List only
+};
+
 }  // namespace TimeSeriesGenerator
 }  // namespace TimeSeries
 }  // namespace SmartMet
@@ -1,11 +1,196 @@
 #include "TimeSeriesGeneratorCache.h"
 #include <macgyver/Exception.h>
 #include <macgyver/Hash.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
 
 namespace SmartMet
 {
 namespace TimeSeries
 {
+namespace
+{
+// Hash for comparing data times with a prefix of longer data times
+std::size_t data_times_hash(const std::list<Fmi::DateTime>& theTimes)
+{
+  std::size_t hash = 0;
+  for (const auto& t : theTimes)
+    Fmi::hash_combine(hash, Fmi::hash_value(t));
+  return hash;
+}
+
+// Snapshot file format, all integers in native byte order:
+//
+//   magic, format version, tz database version length and characters, key check,
+//   entry count
+//   per entry: key, zone name length and characters, time count, UTC epoch seconds
+
+const char snapshot_magic[4] = {'T', 'S', 'G', 'C'};
+const std::uint32_t snapshot_version = 2;
+
+const Fmi::DateTime epoch(Fmi::Date(1970, 1, 1));
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Version of the system time zone database
+ *
+ * Cached local times are invalid if the time zone rules have changed.
+ */
+// ----------------------------------------------------------------------
+
+std::string tz_database_version()
+{
+  std::ifstream in("/usr/share/zoneinfo/tzdata.zi");
+  std::string line;
+  if (in && std::getline(in, line) && line.rfind("# version ", 0) == 0)
+    return line.substr(10);
+
+  std::ifstream in2("/usr/share/zoneinfo/+VERSION");
+  if (in2 && std::getline(in2, line))
+    return line;
+
+  return "";
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Cache key of fixed options
+ *
+ * The snapshot stores only the cache keys, which are hash values of the
+ * options. The keys of a snapshot are valid only if the options and the
+ * hash functions still produce the same hash values for the same options.
+ */
+// ----------------------------------------------------------------------
+
+std::size_t key_check()
+{
+  const Fmi::DateTime t(Fmi::Date(2000, 1, 1), Fmi::Hours(12));
+  TimeSeriesGeneratorOptions options(t);
+  options.mode = TimeSeriesGeneratorOptions::DataTimes;
+  options.startTime = t;
+  options.endTime = t + Fmi::Hours(24);
+  options.startTimeUTC = false;
+  options.timeSteps = 10;
+  options.timeStep = 60;
+  options.timeList = {600, 1800};
+  options.days = {1, 15};
+  options.setDataTimes(std::make_shared<std::list<Fmi::DateTime>>(1, t));
+  options.endTimeData = true;
+
+  std::size_t hash = options.hash_value();
+  Fmi::hash_combine(hash, Fmi::hash_value(std::string("Europe/Helsinki")));
+  return hash;
+}
+
+template <typename T>
+void write_value(std::string& theBuffer, T theValue)
+{
+  theBuffer.append(reinterpret_cast<const char*>(&theValue), sizeof(theValue));
+}
+
+void write_string(std::string& theBuffer, const std::string& theValue)
+{
+  write_value(theBuffer, static_cast<std::uint32_t>(theValue.size()));
+  theBuffer.append(theValue);
+}
+
+// Bounds checked reader for the memory mapped snapshot. Reading past the end
+// gives empty values and marks the snapshot truncated.
+class SnapshotReader
+{
+ public:
+  SnapshotReader(const char* theData, std::size_t theSize)
+      : itsPos(theData), itsEnd(theData + theSize)
+  {
+  }
+
+  template <typename T>
+  T value()
+  {
+    T ret{};
+    if (const char* ptr = data(sizeof(T)))
+      std::memcpy(&ret, ptr, sizeof(T));
+    return ret;
+  }
+
+  std::string string()
+  {
+    auto n = value<std::uint32_t>();
+    const char* ptr = data(n);
+    return (ptr != nullptr ? std::string(ptr, n) : std::string());
+  }
+
+  const char* data(std::size_t theSize)
+  {
+    if (itsTruncated || static_cast<std::size_t>(itsEnd - itsPos) < theSize)
+    {
+      itsTruncated = true;
+      return nullptr;
+    }
+    const char* ret = itsPos;
+    itsPos += theSize;
+    return ret;
+  }
+
+  bool truncated() const { return itsTruncated; }
+
+ private:
+  const char* itsPos;
+  const char* itsEnd;
+  bool itsTruncated = false;
+};
+
+// RAII wrapper for a read only memory mapping
+class MappedFile
+{
+ public:
+  explicit MappedFile(const std::string& theFilename)
+  {
+    int fd = ::open(theFilename.c_str(), O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+      void* ptr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (ptr != MAP_FAILED)
+      {
+        itsData = static_cast<const char*>(ptr);
+        itsSize = st.st_size;
+      }
+    }
+    ::close(fd);
+  }
+
+  ~MappedFile()
+  {
+    if (itsData != nullptr)
+      ::munmap(const_cast<char*>(itsData), itsSize);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data() const { return itsData; }
+  std::size_t size() const { return itsSize; }
+
+ private:
+  const char* itsData = nullptr;
+  std::size_t itsSize = 0;
+};
+
+}  // namespace
+
 // ----------------------------------------------------------------------
 /*!
  * \brief Resize the cache
@@ -20,6 +205,62 @@ void TimeSeriesGeneratorCache::resize(std::size_t theSize) const
   try
   {
     itsCache.resize(theSize);
+
+    std::lock_guard<std::mutex> lock(itsMutex);
+    itsMaxIndexSize = theSize;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Extend the latest times generated for shorter data times
+ *
+ * Observation data times are typically updated by appending new times,
+ * which would always change the cache key. If the latest data times
+ * with otherwise identical options are a prefix of the new ones, the
+ * earlier times are extended instead of generating them all again.
+ * Returns an empty pointer if that is not possible.
+ */
+// ----------------------------------------------------------------------
+
+TimeSeriesGeneratorCache::TimeList TimeSeriesGeneratorCache::extend(
+    std::size_t theKey,
+    const TimeSeriesGeneratorOptions& theOptions,
+    const Fmi::TimeZonePtr& theZone) const
+{
+  try
+  {
+    DataTimesVersion latest;
+    {
+      std::lock_guard<std::mutex> lock(itsMutex);
+      auto pos = itsLatestVersions.find(theKey);
+      if (pos == itsLatestVersions.end())
+        return {};
+      latest = pos->second;
+    }
+
+    // The new data times must be longer and have a matching prefix
+
+    const auto& datatimes = *theOptions.getDataTimes();
+    if (datatimes.size() <= latest.size)
+      return {};
+
+    auto it = datatimes.begin();
+    std::size_t hash = 0;
+    for (std::size_t i = 0; i < latest.size; ++i)
+      Fmi::hash_combine(hash, Fmi::hash_value(*it++));
+
+    if (hash != latest.hash || *std::prev(it) != latest.last)
+      return {};
+
+    TimeList series(new TimeSeriesGenerator::LocalTimeList(*latest.times));
+    if (!TimeSeriesGenerator::extend(*series, theOptions, theZone, it))
+      return {};
+    return series;
   }
   catch (...)
   {
@@ -40,19 +281,85 @@ TimeSeriesGeneratorCache::TimeList TimeSeriesGeneratorCache::generate(
 {
   try
   {
-    // hash value for the query
+    // hash value for the query. The zone name is used so that the hash is the
+    // same after a restart when loading a snapshot.
     std::size_t hash = theOptions.hash_value();
-    Fmi::hash_combine(hash, Fmi::hash_value(theZone));
+    Fmi::hash_combine(hash, Fmi::hash_value(theZone->name()));
 
     // use cached result if possible
     auto cached_result = itsCache.find(hash);
     if (cached_result)
-      return *cached_result;
+    {
+      ++*cached_result->hits;
+      return cached_result->times;
+    }
+
+    // Only data times for normal data can be extended incrementally
+
+    const bool incremental =
+        (!theOptions.isClimatology && !theOptions.getDataTimes()->empty() &&
+         (theOptions.mode == TimeSeriesGeneratorOptions::DataTimes ||
+          theOptions.mode == TimeSeriesGeneratorOptions::GraphTimes));
+
+    std::size_t key = 0;
+    TimeList series;
+
+    if (incremental)
+    {
+      key = theOptions.hash_value_without_data_times();
+      Fmi::hash_combine(key, Fmi::hash_value(theZone->name()));
+      series = extend(key, theOptions, theZone);
+    }
+    const bool extended = !!series;
 
     // generate time series and cache it for future use
-    TimeList series(
-        new TimeSeriesGenerator::LocalTimeList(TimeSeriesGenerator::generate(theOptions, theZone)));
-    itsCache.insert(hash, series);
+    if (!series)
+      series.reset(new TimeSeriesGenerator::LocalTimeList(
+          TimeSeriesGenerator::generate(theOptions, theZone)));
+
+    const CacheEntry entry{series, std::make_shared<std::atomic<std::size_t>>(0)};
+    itsCache.insert(hash, entry);
+    add_usage(hash, theZone->name(), entry);
+
+    // Remember only the latest version. An extended version supersedes the
+    // earlier one, which is removed from the cache since requests will use the
+    // new data times. When the index is full, the least recently updated
+    // version is forgotten.
+
+    if (incremental)
+    {
+      const auto& datatimes = *theOptions.getDataTimes();
+      std::optional<std::size_t> superseded;
+      {
+        std::lock_guard<std::mutex> lock(itsMutex);
+        auto pos = itsLatestVersions.find(key);
+        if (pos != itsLatestVersions.end())
+        {
+          if (extended && pos->second.cachekey != hash)
+          {
+            superseded = pos->second.cachekey;
+            itsUsage.erase(*superseded);
+          }
+        }
+        else if (itsLatestVersions.size() >= itsMaxIndexSize)
+        {
+          auto oldest = std::min_element(
+              itsLatestVersions.begin(),
+              itsLatestVersions.end(),
+              [](const auto& v1, const auto& v2) { return v1.second.updated < v2.second.updated; });
+          itsLatestVersions.erase(oldest);
+        }
+        itsLatestVersions[key] = DataTimesVersion{datatimes.size(),
+                                                  data_times_hash(datatimes),
+                                                  datatimes.back(),
+                                                  series,
+                                                  hash,
+                                                  ++itsVersionCounter};
+      }
+      if (superseded)
+        itsCache.erase(*superseded);
+    }
+
     return series;
   }
   catch (...)
@@ -61,5 +368,197 @@ TimeSeriesGeneratorCache::TimeList TimeSeriesGeneratorCache::generate(
   }
 }
 
+// ----------------------------------------------------------------------
+/*!
+ * \brief Register a new cached time series
+ */
+// ----------------------------------------------------------------------
+
+void TimeSeriesGeneratorCache::add_usage(std::size_t theKey,
+                                         const std::string& theZone,
+                                         const CacheEntry& theEntry) const
+{
+  std::lock_guard<std::mutex> lock(itsMutex);
+
+  // Forget time series which have expired from the cache
+  if (itsUsage.size() >= 2 * itsMaxIndexSize)
+  {
+    for (auto it = itsUsage.begin(); it != itsUsage.end();)
+    {
+      if (it->second.times.expired())
+        it = itsUsage.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  auto& usage = itsUsage[theKey];
+  usage.zone = theZone;
+  usage.times = theEntry.times;
+  usage.hits = theEntry.hits;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Save the most used time series
+ *
+ * The snapshot is written to a temporary file which is then renamed
+ * so that a concurrent load never sees a partially written file.
+ */
+// ----------------------------------------------------------------------
+
+void TimeSeriesGeneratorCache::save(const std::string& theFilename,
+                                    std::size_t theMaxEntries) const
+{
+  try
+  {
+    struct Entry
+    {
+      std::size_t key;
+      std::size_t hits;
+      std::string zone;
+      TimeList times;
+    };
+
+    std::vector<Entry> entries;
+    {
+      std::lock_guard<std::mutex> lock(itsMutex);
+      for (const auto& item : itsUsage)
+      {
+        TimeList times = item.second.times.lock();
+        if (times)
+          entries.push_back(Entry{item.first, *item.second.hits, item.second.zone, times});
+      }
+    }
+
+    if (entries.size() > theMaxEntries)
+    {
+      std::partial_sort(entries.begin(),
+                        entries.begin() + theMaxEntries,
+                        entries.end(),
+                        [](const Entry& e1, const Entry& e2) { return e1.hits > e2.hits; });
+      entries.resize(theMaxEntries);
+    }
+
+    std::string buffer(snapshot_magic, sizeof(snapshot_magic));
+    write_value(buffer, snapshot_version);
+    write_string(buffer, tz_database_version());
+    write_value(buffer, static_cast<std::uint64_t>(key_check()));
+    write_value(buffer, static_cast<std::uint64_t>(entries.size()));
+
+    for (const auto& entry : entries)
+    {
+      write_value(buffer, static_cast<std::uint64_t>(entry.key));
+      write_string(buffer, entry.zone);
+      write_value(buffer, static_cast<std::uint64_t>(entry.times->size()));
+      for (const auto& t : *entry.times)
+        write_value(buffer, static_cast<std::int64_t>((t.utc_time() - epoch).total_seconds()));
+    }
+
+    const std::string tmpfile = theFilename + ".tmp";
+    {
+      std::ofstream out(tmpfile, std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!out)
+        throw Fmi::Exception(BCP, "Failed to open '" + tmpfile + "' for writing");
+      out.write(buffer.data(), buffer.size());
+      if (!out)
+        throw Fmi::Exception(BCP, "Failed to write '" + tmpfile + "'");
+    }
+
+    if (std::rename(tmpfile.c_str(), theFilename.c_str()) != 0)
+      throw Fmi::Exception(BCP, "Failed to rename '" + tmpfile + "' to '" + theFilename + "'");
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Load a snapshot saved earlier
+ *
+ * Returns the number of time series loaded. A missing, truncated or
+ * invalid snapshot is ignored, as is one generated with a different or
+ * unknown time zone database or with different cache keys for the same
+ * options.
+ */
+// ----------------------------------------------------------------------
+
+std::size_t TimeSeriesGeneratorCache::load(const std::string& theFilename) const
+{
+  try
+  {
+    MappedFile file(theFilename);
+    if (file.data() == nullptr)
+      return 0;
+
+    SnapshotReader reader(file.data(), file.size());
+
+    const char* magic = reader.data(sizeof(snapshot_magic));
+    if (magic == nullptr || std::memcmp(magic, snapshot_magic, sizeof(snapshot_magic)) != 0)
+      return 0;
+
+    if (reader.value<std::uint32_t>() != snapshot_version)
+      return 0;
+
+    // An unknown tz database version cannot be verified
+    const auto tzversion = tz_database_version();
+    if (tzversion.empty() || reader.string() != tzversion)
+      return 0;
+
+    if (reader.value<std::uint64_t>() != key_check())
+      return 0;
+
+    auto count = reader.value<std::uint64_t>();
+
+    // Zones are shared by the times of a series and typically by most series
+    std::map<std::string, Fmi::TimeZonePtr> zones;
+
+    // Nothing is inserted unless the whole snapshot can be read
+    struct Entry
+    {
+      std::size_t key;
+      std::string zone;
+      TimeList times;
+    };
+    std::vector<Entry> entries;
+
+    for (std::uint64_t i = 0; i < count && !reader.truncated(); i++)
+    {
+      auto key = static_cast<std::size_t>(reader.value<std::uint64_t>());
+      auto zonename = reader.string();
+      auto n = reader.value<std::uint64_t>();
+      if (reader.truncated())
+        break;
+
+      auto& zone = zones[zonename];
+      if (!zone)
+        zone = Fmi::TimeZonePtr(zonename);
+
+      TimeList times(new TimeSeriesGenerator::LocalTimeList);
+      for (std::uint64_t j = 0; j < n && !reader.truncated(); j++)
+        times->emplace_back(epoch + Fmi::Seconds(reader.value<std::int64_t>()), zone);
+
+      entries.push_back(Entry{key, zonename, times});
+    }
+
+    if (reader.truncated())
+      return 0;
+
+    for (const auto& item : entries)
+    {
+      const CacheEntry entry{item.times, std::make_shared<std::atomic<std::size_t>>(0)};
+      itsCache.insert(item.key, entry);
+      add_usage(item.key, item.zone, entry);
+    }
+    return entries.size();
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!").addParameter("Filename", theFilename);
+  }
+}
+
 }  // namespace TimeSeries
 }  // namespace SmartMet
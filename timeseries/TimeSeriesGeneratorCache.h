@@ -9,6 +9,11 @@
 #include "TimeSeriesGenerator.h"
 #include "TimeSeriesGeneratorOptions.h"
 #include <macgyver/Cache.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 
 namespace SmartMet
 {
@@ -26,8 +31,53 @@ class TimeSeriesGeneratorCache
 
   Fmi::Cache::CacheStats getCacheStats() const { return itsCache.statistics(); }
 
+  // Snapshot of the most used time series for warm restarts
+  void save(const std::string& theFilename, std::size_t theMaxEntries) const;
+  std::size_t load(const std::string& theFilename) const;
+
  private:
-  mutable Fmi::Cache::Cache<std::size_t, TimeList> itsCache;
+  // Fingerprint of the latest data times and the respective generated times for
+  // options which differ only in data times
+  struct DataTimesVersion
+  {
+    std::size_t size = 0;
+    std::size_t hash = 0;
+    Fmi::DateTime last;
+    TimeList times;
+    std::size_t cachekey = 0;  // key of the times in the cache
+    std::size_t updated = 0;   // for evicting the least recently updated version
+  };
+
+  TimeList extend(std::size_t theKey,
+                  const TimeSeriesGeneratorOptions& theOptions,
+                  const Fmi::TimeZonePtr& theZone) const;
+
+  // Hits are counted without locking the cache
+  using HitCounter = std::shared_ptr<std::atomic<std::size_t>>;
+
+  struct CacheEntry
+  {
+    TimeList times;
+    HitCounter hits;
+  };
+
+  // Usage statistics for selecting the time series to be saved
+  struct Usage
+  {
+    std::string zone;
+    std::weak_ptr<TimeSeriesGenerator::LocalTimeList> times;
+    HitCounter hits;
+  };
+
+  void add_usage(std::size_t theKey, const std::string& theZone, const CacheEntry& theEntry) const;
+
+  mutable Fmi::Cache::Cache<std::size_t, CacheEntry> itsCache;
+
+  mutable std::mutex itsMutex;
+  mutable std::size_t itsMaxIndexSize = 1000;
+  mutable std::map<std::size_t, DataTimesVersion> itsLatestVersions;
+  mutable std::size_t itsVersionCounter = 0;
+  mutable std::map<std::size_t, Usage> itsUsage;
 };
 
 }  // namespace TimeSeries
@@ -244,6 +244,28 @@ TimeSeriesGeneratorOptions::TimeSeriesGeneratorOptions(const Fmi::DateTime& now)
 // ----------------------------------------------------------------------
 
 std::size_t TimeSeriesGeneratorOptions::hash_value() const
+{
+  try
+  {
+    std::size_t hash = hash_value_without_data_times();
+    Fmi::hash_combine(hash, Fmi::hash_value(*dataTimes));
+    return hash;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Hash value for all the options except the data times
+ *
+ * Used for recognizing requests which differ only in the data times.
+ */
+// ----------------------------------------------------------------------
+
+std::size_t TimeSeriesGeneratorOptions::hash_value_without_data_times() const
 {
   try
   {
@@ -263,7 +285,6 @@ std::size_t TimeSeriesGeneratorOptions::hash_value() const
     }
     for (const auto& t : timeList)
       Fmi::hash_combine(hash, Fmi::hash_value(t));
-    Fmi::hash_combine(hash, Fmi::hash_value(*dataTimes));
     Fmi::hash_combine(hash, Fmi::hash_value(startTimeData));
     Fmi::hash_combine(hash, Fmi::hash_value(endTimeData));
     Fmi::hash_combine(hash, Fmi::hash_value(isClimatology));
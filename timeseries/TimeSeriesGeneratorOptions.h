@@ -39,6 +39,7 @@ struct TimeSeriesGeneratorOptions
   TimeSeriesGeneratorOptions(const Fmi::DateTime& now = Fmi::SecondClock::universal_time());
 
   std::size_t hash_value() const;
+  std::size_t hash_value_without_data_times() const;
 
   // All timesteps are to be used?
   bool all() const;
@@ -3,6 +3,9 @@
 #include <macgyver/StringConversion.h>
 #include <spine/LonLat.h>
 #include <spine/None.h>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
 
 using ::SmartMet::Spine::LonLat;
 using ::SmartMet::Spine::LonLatFormat;
@@ -12,6 +15,65 @@ namespace SmartMet
 {
 namespace TimeSeries
 {
+namespace
+{
+// Large enough for any double in fixed notation with max_fixed_precision decimals
+const int max_fixed_precision = 40;
+const std::size_t fixed_buffer_size = 400;
+
+// Format in fixed notation with std::to_chars, which is specified to produce the same
+// output as printf("%.*f"). Returns nullptr if the value must be formatted by the
+// ValueFormatter instead.
+char* to_chars_fixed(char* first, char* last, double value, int precision)
+{
+#if defined(__cpp_lib_to_chars)
+  if (!std::isfinite(value) || precision < 0 || precision > max_fixed_precision)
+    return nullptr;
+
+  auto result = std::to_chars(first, last, value, std::chars_format::fixed, precision);
+  if (result.ec != std::errc())
+    return nullptr;
+
+  // Let the ValueFormatter decide how to handle negative zero results
+  if (*first == '-' && std::all_of(first + 1,
+                                   result.ptr,
+                                   [](char ch) { return ch == '0' || ch == '.'; }))
+    return nullptr;
+
+  return result.ptr;
+#else
+  return nullptr;
+#endif
+}
+
+}  // namespace
+
+void append_number(std::string& output,
+                   const Fmi::ValueFormatter& valueformatter,
+                   double value,
+                   int precision,
+                   NumberFormatting formatting)
+{
+  try
+  {
+    if (formatting == NumberFormatting::ToChars)
+    {
+      char buffer[fixed_buffer_size];
+      char* end = to_chars_fixed(buffer, buffer + sizeof(buffer), value, precision);
+      if (end != nullptr)
+      {
+        output.append(buffer, end);
+        return;
+      }
+    }
+    output += valueformatter.format(value, precision);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
 std::ostream& operator<<(std::ostream& os, const Value& val)
 {
   try
@@ -122,7 +184,12 @@ std::string StringVisitor::operator()(double d) const
 {
   try
   {
-    return itsValueFormatter.format(d, itsPrecision);
+    if (itsNumberFormatting == NumberFormatting::ValueFormatter)
+      return itsValueFormatter.format(d, itsPrecision);
+
+    std::string ret;
+    append_number(ret, itsValueFormatter, d, itsPrecision, itsNumberFormatting);
+    return ret;
   }
   catch (...)
   {
@@ -146,12 +213,20 @@ std::string StringVisitor::operator()(const LonLat& lonlat) const
 {
   try
   {
-    if (itsLonLatFormat == LonLatFormat::LONLAT)
-      return itsValueFormatter.format(lonlat.lon, itsPrecision) + ", " +
-             itsValueFormatter.format(lonlat.lat, itsPrecision);
-
-    return itsValueFormatter.format(lonlat.lat, itsPrecision) + ", " +
-           itsValueFormatter.format(lonlat.lon, itsPrecision);
+    const bool lonfirst = (itsLonLatFormat == LonLatFormat::LONLAT);
+    std::string ret;
+    append_number(ret,
+                  itsValueFormatter,
+                  lonfirst ? lonlat.lon : lonlat.lat,
+                  itsPrecision,
+                  itsNumberFormatting);
+    ret += ", ";
+    append_number(ret,
+                  itsValueFormatter,
+                  lonfirst ? lonlat.lat : lonlat.lon,
+                  itsPrecision,
+                  itsNumberFormatting);
+    return ret;
   }
   catch (...)
   {
@@ -200,6 +275,16 @@ void OStreamVisitor::operator()(double d) const
 {
   try
   {
+    if (itsNumberFormatting == NumberFormatting::ToChars)
+    {
+      char buffer[fixed_buffer_size];
+      char* end = to_chars_fixed(buffer, buffer + sizeof(buffer), d, itsPrecision);
+      if (end != nullptr)
+      {
+        itsOutstream.write(buffer, end - buffer);
+        return;
+      }
+    }
     itsOutstream << itsValueFormatter.format(d, itsPrecision);
   }
   catch (...)
@@ -224,8 +309,9 @@ void OStreamVisitor::operator()(const LonLat& lonlat) const
 {
   try
   {
-    itsOutstream << itsValueFormatter.format(lonlat.lon, itsPrecision) << ", "
-                 << itsValueFormatter.format(lonlat.lat, itsPrecision);
+    (*this)(lonlat.lon);
+    itsOutstream << ", ";
+    (*this)(lonlat.lat);
   }
   catch (...)
   {
@@ -3,6 +3,8 @@
 #include "TimeSeries.h"
 #include <macgyver/ValueFormatter.h>
 #include <spine/LonLat.h>
+#include <cmath>
+#include <string>
 
 namespace SmartMet
 {
@@ -17,6 +19,46 @@ std::ostream &operator<<(std::ostream &os, const TimeSeriesGroup &tsg);
 // write content of TimeSeriesVector to ostream (not formatted)
 std::ostream &operator<<(std::ostream &os, const TimeSeriesVector &tsv);
 
+// Backend for formatting floating point values
+enum class NumberFormatting
+{
+  ValueFormatter,  // Fmi::ValueFormatter::format
+  ToChars          // std::to_chars, for value formatters using the default fixed notation
+};
+
+// Append a floating point value formatted with the given backend. The ToChars backend
+// produces the same output as the default ValueFormatter and falls back to the
+// ValueFormatter for missing, infinite and negative zero values.
+void append_number(std::string &output,
+                   const Fmi::ValueFormatter &valueformatter,
+                   double value,
+                   int precision,
+                   NumberFormatting formatting);
+
+// True if the value repeats the previous one so that its formatted output can be reused.
+// Only numbers and coordinates qualify, -0.0 does not repeat 0.0 and NaN repeats nothing.
+inline bool is_repeated_value(const Value &previous, const Value &value)
+{
+  if (const auto *d = std::get_if<double>(&value))
+  {
+    const auto *p = std::get_if<double>(&previous);
+    return p != nullptr && *p == *d && std::signbit(*p) == std::signbit(*d);
+  }
+  if (const auto *i = std::get_if<int>(&value))
+  {
+    const auto *p = std::get_if<int>(&previous);
+    return p != nullptr && *p == *i;
+  }
+  if (const auto *ll = std::get_if<Spine::LonLat>(&value))
+  {
+    const auto *p = std::get_if<Spine::LonLat>(&previous);
+    return p != nullptr && p->lon == ll->lon && p->lat == ll->lat &&
+           std::signbit(p->lon) == std::signbit(ll->lon) &&
+           std::signbit(p->lat) == std::signbit(ll->lat);
+  }
+  return false;
+}
+
 // format Value and write to output stream
 // usage: boost::apply_visitor(ostream_visitor, Value);
 class OStreamVisitor
@@ -26,6 +68,7 @@ class OStreamVisitor
   const Fmi::ValueFormatter &itsValueFormatter;
   int itsPrecision;
   Spine::LonLatFormat itsLonLatFormat = Spine::LonLatFormat::LONLAT;
+  NumberFormatting itsNumberFormatting = NumberFormatting::ValueFormatter;
 
  public:
   OStreamVisitor(std::ostream &outs, const Fmi::ValueFormatter &valueformatter, int precision)
@@ -42,6 +85,8 @@ class OStreamVisitor
 
   // Set LonLat - value formatting
   OStreamVisitor &operator<<(Spine::LonLatFormat newformat);
+
+  void setNumberFormatting(NumberFormatting newFormatting) { itsNumberFormatting = newFormatting; }
 };
 
 // format Value into string
@@ -52,6 +97,7 @@ class StringVisitor
   const Fmi::ValueFormatter &itsValueFormatter;
   int itsPrecision;
   Spine::LonLatFormat itsLonLatFormat = Spine::LonLatFormat::LONLAT;
+  NumberFormatting itsNumberFormatting = NumberFormatting::ValueFormatter;
 
  public:
   StringVisitor(const Fmi::ValueFormatter &valueformatter, int precision)
@@ -61,6 +107,7 @@ class StringVisitor
 
   void setLonLatFormat(Spine::LonLatFormat newFormat) { itsLonLatFormat = newFormat; }
   void setPrecision(int newPrecision) { itsPrecision = newPrecision; }
+  void setNumberFormatting(NumberFormatting newFormatting) { itsNumberFormatting = newFormatting; }
   std::string operator()(const Spine::None &none) const;
   std::string operator()(const std::string &str) const;
   std::string operator()(double d) const;
@@ -1,6 +1,11 @@
 #include "TimeSeriesUtility.h"
 #include "TimeSeriesOutput.h"
 #include <macgyver/StringConversion.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
 
 namespace SmartMet
 {
@@ -22,6 +27,14 @@ std::ostream& operator<<(std::ostream& os, const TimeSeriesData& tsdata)
       os << **ptr;
     else if (const auto* ptr = std::get_if<TimeSeriesGroupPtr>(&tsdata))
       os << **ptr;
+    else if (const auto* ptr = std::get_if<RunLengthTimeSeriesPtr>(&tsdata))
+      os << (*ptr)->expand();
+    else if (const auto* ptr = std::get_if<TimeSeriesSnapshot>(&tsdata))
+      os << **ptr;
+    else if (const auto* ptr = std::get_if<TimeSeriesVectorSnapshot>(&tsdata))
+      os << **ptr;
+    else if (const auto* ptr = std::get_if<TimeSeriesGroupSnapshot>(&tsdata))
+      os << **ptr;
 
     return os;
   }
@@ -53,6 +66,133 @@ std::ostream& operator<<(std::ostream& os, const OutputData& odata)
 
 namespace
 {
+// ----------------------------------------------------------------------
+/*!
+ * \brief Run tasks 0...n-1 with the executor, or in this thread without one
+ *
+ * The first exception thrown by any task is rethrown once the executor
+ * returns, the remaining tasks are skipped.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Function>
+void run_tasks(std::size_t n, Function&& function, const TaskExecutor& executor)
+{
+  if (!executor || n <= 1)
+  {
+    for (std::size_t i = 0; i < n; i++)
+      function(i);
+    return;
+  }
+
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  executor(n,
+           [&](std::size_t i)
+           {
+             if (failed)
+               return;
+             try
+             {
+               function(i);
+             }
+             catch (...)
+             {
+               std::lock_guard<std::mutex> lock(error_mutex);
+               if (!error)
+                 error = std::current_exception();
+               failed = true;
+             }
+           });
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Find the indexes of the timesteps to keep
+ *
+ * We assume both TimeSeries and LocalTimeList are in sorted order.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Iterator, typename TimeOf>
+std::vector<std::size_t> timesteps_to_keep(Iterator begin,
+                                           Iterator end,
+                                           std::size_t size,
+                                           TimeOf&& time_of,
+                                           const TimeSeriesGenerator::LocalTimeList& timesteps)
+{
+  std::vector<std::size_t> keep;
+  keep.reserve(std::min(size, timesteps.size()));
+
+  auto next_valid_time = timesteps.cbegin();
+  const auto& last_valid_time = timesteps.cend();
+  std::size_t i = 0;
+  for (auto it = begin; it != end; ++it, ++i)
+  {
+    const Fmi::LocalDateTime& data_time = time_of(*it);
+
+    // Skip valid times until data_time is greater than or equal to it
+    while (next_valid_time != last_valid_time && data_time > *next_valid_time)
+      ++next_valid_time;
+
+    // Now the time is either valid (==) or not needed
+    if (next_valid_time != last_valid_time && *next_valid_time == data_time)
+    {
+      keep.push_back(i);
+      ++next_valid_time;
+    }
+  }
+  return keep;
+}
+
+std::vector<std::size_t> timesteps_to_keep(const TimeSeries& ts,
+                                           const TimeSeriesGenerator::LocalTimeList& timesteps)
+{
+  return timesteps_to_keep(
+      ts.begin(),
+      ts.end(),
+      ts.size(),
+      [](const TimedValue& tv) -> const Fmi::LocalDateTime& { return tv.time; },
+      timesteps);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Compact the time series in place to the given indexes
+ */
+// ----------------------------------------------------------------------
+
+void keep_timesteps(TimeSeries& ts, const std::vector<std::size_t>& keep)
+{
+  // Quick exit if nothing needs to be erased
+  if (keep.size() == ts.size())
+    return;
+
+  std::size_t pos = 0;
+  for (auto i : keep)
+  {
+    if (i != pos)
+      ts[pos] = std::move(ts[i]);
+    ++pos;
+  }
+  ts.erase(ts.begin() + pos, ts.end());
+}
+
+bool same_times(const TimeSeries& ts1, const TimeSeries& ts2)
+{
+  return (ts1.size() == ts2.size() &&
+          std::equal(ts1.begin(),
+                     ts1.end(),
+                     ts2.begin(),
+                     [](const TimedValue& tv1, const TimedValue& tv2)
+                     { return tv1.time == tv2.time; }));
+}
+
 // ----------------------------------------------------------------------
 /*!
  * \brief Remove redundant timesteps used for aggregation only from the time series
@@ -67,53 +207,134 @@ void erase_redundant_timesteps(TimeSeries& ts, const TimeSeriesGenerator::LocalT
     if (ts.empty())
       return;
 
-    // First check if all the timesteps are relevant. We assume both TimeSeries and LocalTimeList
-    // are in sorted order.
+    keep_timesteps(ts, timesteps_to_keep(ts, timesteps));
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
 
-    const auto n = ts.size();
-    std::size_t valid_count = 0;
-    std::vector<bool> keep_timestep(n, true);
+// ----------------------------------------------------------------------
+/*!
+ * \brief Remove redundant timesteps from several time series
+ *
+ * The members usually share the same timeline, in which case the
+ * timesteps to keep are resolved only once.
+ */
+// ----------------------------------------------------------------------
 
-    auto next_valid_time = timesteps.cbegin();
-    const auto& last_valid_time = timesteps.cend();
-    for (std::size_t i = 0; i < n; i++)
-    {
-      const auto& data = ts[i];
+template <typename Getter>
+void erase_redundant_timesteps(std::size_t n,
+                               Getter&& get,
+                               const TimeSeriesGenerator::LocalTimeList& timesteps,
+                               const TaskExecutor& executor)
+{
+  try
+  {
+    std::size_t reference = 0;
+    while (reference < n && get(reference).empty())
+      ++reference;
+    if (reference == n)
+      return;
 
-      // Skip valid times until data_time is greater than or equal to it
-      while (next_valid_time != last_valid_time && data.time > *next_valid_time)
-        ++next_valid_time;
+    const TimeSeries& reference_ts = get(reference);
+    const auto keep = timesteps_to_keep(reference_ts, timesteps);
 
-      // Now the time is either valid (==) or not needed
-      if (next_valid_time == last_valid_time || *next_valid_time != data.time)
-        keep_timestep[i] = false;
-      else
-      {
-        ++valid_count;
-        ++next_valid_time;
-      }
-    }
+    // The timelines must be compared before any of them is modified
+    std::vector<char> shared(n, false);
+    run_tasks(
+        n,
+        [&](std::size_t i) { shared[i] = (i == reference || same_times(get(i), reference_ts)); },
+        executor);
 
-    // Quick exit if nothing needs to be erased
-    if (valid_count == n)
-      return;
+    run_tasks(
+        n,
+        [&](std::size_t i)
+        {
+          auto& ts = get(i);
+          if (shared[i])
+            keep_timesteps(ts, keep);
+          else
+            erase_redundant_timesteps(ts, timesteps);
+        },
+        executor);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
 
-    // Create reduced timeseries and swap it with the input
-    TimeSeries output;
-    output.reserve(valid_count);
+// ----------------------------------------------------------------------
+/*!
+ * \brief Copy the given timesteps of a time series
+ */
+// ----------------------------------------------------------------------
 
-    for (std::size_t i = 0; i < n; i++)
+TimeSeries copy_timesteps(const TimeSeries& ts, const std::vector<std::size_t>& keep)
+{
+  TimeSeries result;
+  result.reserve(keep.size());
+  for (auto i : keep)
+    result.push_back(ts[i]);
+  return result;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief The timesteps to keep in each of several time series
+ *
+ * Members with the timeline of the first nonempty member share its mask,
+ * the other members get masks of their own.
+ */
+// ----------------------------------------------------------------------
+
+struct MemberMasks
+{
+  std::vector<std::vector<std::size_t>> masks;
+  std::vector<std::size_t> index;  // the mask of each member
+
+  // True if nothing needs to be erased
+  bool empty() const { return index.empty(); }
+  const std::vector<std::size_t>& operator[](std::size_t i) const { return masks[index[i]]; }
+};
+
+template <typename Getter>
+MemberMasks members_to_keep(std::size_t n,
+                            Getter&& get,
+                            const TimeSeriesGenerator::LocalTimeList& timesteps)
+{
+  MemberMasks keep;
+  keep.index.resize(n);
+  const TimeSeries* reference = nullptr;
+  std::size_t reference_mask = 0;
+  bool changed = false;
+
+  for (std::size_t i = 0; i < n; i++)
+  {
+    const TimeSeries& ts = get(i);
+    if (reference != nullptr && same_times(ts, *reference))
+      keep.index[i] = reference_mask;
+    else
     {
-      if (keep_timestep[i])
-        output.push_back(ts[i]);
+      keep.index[i] = keep.masks.size();
+      keep.masks.push_back(timesteps_to_keep(ts, timesteps));
+      if (reference == nullptr && !ts.empty())
+      {
+        reference = &ts;
+        reference_mask = keep.index[i];
+      }
     }
-
-    std::swap(ts, output);
+    changed = (changed || keep[i].size() != ts.size());
   }
-  catch (...)
+
+  if (!changed)
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    keep.masks.clear();
+    keep.index.clear();
   }
+  return keep;
 }
 
 }  // namespace
@@ -146,12 +367,21 @@ TimeSeriesPtr erase_redundant_timesteps(TimeSeriesPtr ts,
 
 TimeSeriesVectorPtr erase_redundant_timesteps(TimeSeriesVectorPtr tsv,
                                               const TimeSeriesGenerator::LocalTimeList& timesteps)
+{
+  return erase_redundant_timesteps(std::move(tsv), timesteps, nullptr);
+}
+
+TimeSeriesVectorPtr erase_redundant_timesteps(TimeSeriesVectorPtr tsv,
+                                              const TimeSeriesGenerator::LocalTimeList& timesteps,
+                                              const TaskExecutor& executor)
 {
   try
   {
-    for (auto& tv : *tsv)
-      erase_redundant_timesteps(tv, timesteps);
-
+    erase_redundant_timesteps(
+        tsv->size(),
+        [&tsv](std::size_t i) -> TimeSeries& { return (*tsv)[i]; },
+        timesteps,
+        executor);
     return tsv;
   }
   catch (...)
@@ -168,11 +398,21 @@ TimeSeriesVectorPtr erase_redundant_timesteps(TimeSeriesVectorPtr tsv,
 
 TimeSeriesGroupPtr erase_redundant_timesteps(TimeSeriesGroupPtr tsg,
                                              const TimeSeriesGenerator::LocalTimeList& timesteps)
+{
+  return erase_redundant_timesteps(std::move(tsg), timesteps, nullptr);
+}
+
+TimeSeriesGroupPtr erase_redundant_timesteps(TimeSeriesGroupPtr tsg,
+                                             const TimeSeriesGenerator::LocalTimeList& timesteps,
+                                             const TaskExecutor& executor)
 {
   try
   {
-    for (auto& ts : *tsg)
-      erase_redundant_timesteps(ts.timeseries, timesteps);
+    erase_redundant_timesteps(
+        tsg->size(),
+        [&tsg](std::size_t i) -> TimeSeries& { return (*tsg)[i].timeseries; },
+        timesteps,
+        executor);
     return tsg;
   }
   catch (...)
@@ -181,6 +421,131 @@ TimeSeriesGroupPtr erase_redundant_timesteps(TimeSeriesGroupPtr tsg,
   }
 }
 
+// ----------------------------------------------------------------------
+/*!
+ * \brief Erase timesteps used for aggregation only
+ *
+ * The runs are cut to the kept timesteps. A constant series stays constant.
+ */
+// ----------------------------------------------------------------------
+
+RunLengthTimeSeriesPtr erase_redundant_timesteps(
+    RunLengthTimeSeriesPtr rts, const TimeSeriesGenerator::LocalTimeList& timesteps)
+{
+  try
+  {
+    if (rts->empty())
+      return rts;
+
+    const auto& times = rts->times();
+    const auto keep = timesteps_to_keep(
+        times.begin(),
+        times.end(),
+        rts->size(),
+        [](const Fmi::LocalDateTime& t) -> const Fmi::LocalDateTime& { return t; },
+        timesteps);
+
+    // Quick exit if nothing needs to be erased
+    if (keep.size() == rts->size())
+      return rts;
+
+    auto new_times = std::make_shared<LocalTimeList>();
+    auto time = times.begin();
+    std::size_t pos = 0;
+    for (auto i : keep)
+    {
+      std::advance(time, i - pos);
+      pos = i;
+      new_times->push_back(*time);
+    }
+
+    RunLengthTimeSeries result(new_times);
+    const auto& runs = rts->runs();
+    std::size_t run = 0;
+    for (auto i : keep)
+    {
+      while (runs[run].end <= i)
+        ++run;
+      result.append(runs[run].value);
+    }
+
+    *rts = std::move(result);
+    return rts;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Snapshot without the timesteps used for aggregation only
+ */
+// ----------------------------------------------------------------------
+
+TimeSeriesSnapshot erase_redundant_timesteps(const TimeSeriesSnapshot& ts,
+                                             const TimeSeriesGenerator::LocalTimeList& timesteps)
+{
+  try
+  {
+    const auto keep = timesteps_to_keep(*ts, timesteps);
+    if (keep.size() == ts->size())
+      return ts;
+    return std::make_shared<TimeSeries>(copy_timesteps(*ts, keep));
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+TimeSeriesVectorSnapshot erase_redundant_timesteps(
+    const TimeSeriesVectorSnapshot& tsv, const TimeSeriesGenerator::LocalTimeList& timesteps)
+{
+  try
+  {
+    const auto keep = members_to_keep(
+        tsv->size(), [&tsv](std::size_t i) -> const TimeSeries& { return (*tsv)[i]; }, timesteps);
+    if (keep.empty())
+      return tsv;
+
+    auto result = std::make_shared<TimeSeriesVector>();
+    result->reserve(tsv->size());
+    for (std::size_t i = 0; i < tsv->size(); i++)
+      result->push_back(copy_timesteps((*tsv)[i], keep[i]));
+    return result;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+TimeSeriesGroupSnapshot erase_redundant_timesteps(
+    const TimeSeriesGroupSnapshot& tsg, const TimeSeriesGenerator::LocalTimeList& timesteps)
+{
+  try
+  {
+    const auto keep = members_to_keep(
+        tsg->size(),
+        [&tsg](std::size_t i) -> const TimeSeries& { return (*tsg)[i].timeseries; },
+        timesteps);
+    if (keep.empty())
+      return tsg;
+
+    auto result = std::make_shared<TimeSeriesGroup>();
+    result->reserve(tsg->size());
+    for (std::size_t i = 0; i < tsg->size(); i++)
+      result->emplace_back((*tsg)[i].lonlat, copy_timesteps((*tsg)[i].timeseries, keep[i]));
+    return result;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
 size_t number_of_elements(const OutputData& outputData)
 {
   try
@@ -213,6 +578,28 @@ size_t number_of_elements(const OutputData& outputData)
             for (const LonLatTimeSeries& llts : *tsg)
               ret += llts.timeseries.size();
         }
+        else if (const auto* ptr = std::get_if<RunLengthTimeSeriesPtr>(&tsdata))
+        {
+          if (*ptr)
+            ret += (*ptr)->size();
+        }
+        else if (const auto* ptr = std::get_if<TimeSeriesSnapshot>(&tsdata))
+        {
+          if (*ptr)
+            ret += (*ptr)->size();
+        }
+        else if (const auto* ptr = std::get_if<TimeSeriesVectorSnapshot>(&tsdata))
+        {
+          if (*ptr)
+            for (const TimeSeries& ts : **ptr)
+              ret += ts.size();
+        }
+        else if (const auto* ptr = std::get_if<TimeSeriesGroupSnapshot>(&tsdata))
+        {
+          if (*ptr)
+            for (const LonLatTimeSeries& llts : **ptr)
+              ret += llts.timeseries.size();
+        }
       }
     }
     return ret;
@@ -264,36 +651,72 @@ int get_fmisid_value(const Value& value)
   }
 }
 
-void add_missing_timesteps(TimeSeries& ts, const TimeSeriesGeneratorCache::TimeList& tlist)
+// ----------------------------------------------------------------------
+/*!
+ * \brief Compare fmisid values of consecutive rows
+ *
+ * The typical int and double cases are handled without the generic
+ * variant comparison.
+ */
+// ----------------------------------------------------------------------
+
+bool same_fmisid(const Value& value1, const Value& value2)
+{
+  if (const int* i1 = std::get_if<int>(&value1))
+  {
+    const int* i2 = std::get_if<int>(&value2);
+    return (i2 != nullptr && *i1 == *i2);
+  }
+  if (const double* d1 = std::get_if<double>(&value1))
+  {
+    const double* d2 = std::get_if<double>(&value2);
+    return (d2 != nullptr && *d1 == *d2);
+  }
+  return value1 == value2;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Copy a station slice while adding the missing timesteps
+ *
+ * Equivalent to copying the slice and then merging the requested
+ * timesteps into it, but done in a single pass into reserved space.
+ */
+// ----------------------------------------------------------------------
+
+void copy_with_missing_timesteps(TimeSeries& output,
+                                 TimeSeries::const_iterator begin,
+                                 TimeSeries::const_iterator end,
+                                 const TimeSeriesGeneratorCache::TimeList& tlist)
 {
   if (!tlist || tlist->empty())
+  {
+    output.assign(begin, end);
     return;
+  }
 
-  TimeSeries ts2;
+  output.reserve((end - begin) + tlist->size());
 
   auto it = tlist->begin();
 
-  for (const auto& value : ts)
+  for (; begin != end; ++begin)
   {
+    const auto& value = *begin;
     // Add missing timesteps
     while (it != tlist->end() && *it < value.time)
     {
-      ts2.emplace_back(TimedValue(*it, None()));
+      output.emplace_back(*it, None());
       ++it;
     }
-    ts2.emplace_back(value);
+    output.emplace_back(value);
     // If list has been iterated to the end and
     // iteration time is same as observed timestep, go to next step
     if (it != tlist->end() && *it == value.time)
       ++it;
   }
   // If there are requested timesteps after last value, add them
-  while (it != tlist->end())
-  {
-    ts2.emplace_back(TimedValue(*it, None()));
-    ++it;
-  }
-  ts = ts2;
+  for (; it != tlist->end(); ++it)
+    output.emplace_back(*it, None());
 }
 
 }  // namespace
@@ -317,6 +740,15 @@ TimeSeriesByLocation get_timeseries_by_fmisid(const std::string& producer,
                                               const TimeSeriesVectorPtr& observation_result,
                                               const TimeSeriesGeneratorCache::TimeList& tlist,
                                               int fmisid_index)
+{
+  return get_timeseries_by_fmisid(producer, observation_result, tlist, fmisid_index, nullptr);
+}
+
+TimeSeriesByLocation get_timeseries_by_fmisid(const std::string& producer,
+                                              const TimeSeriesVectorPtr& observation_result,
+                                              const TimeSeriesGeneratorCache::TimeList& tlist,
+                                              int fmisid_index,
+                                              const TaskExecutor& executor)
 {
   try
   {
@@ -344,48 +776,48 @@ if (UtilityFunctions::is_flash_or_mobile_producer(producer))
     }
     const TimeSeries& fmisid_ts = (*observation_result)[fmisid_index];
 
+    if (fmisid_ts.empty())
+      return ret;
+
     // find indexes for locations
-    std::vector<std::pair<unsigned int, unsigned int>> location_indexes;
+    std::vector<std::pair<std::size_t, std::size_t>> location_indexes;
 
-    unsigned int start_index = 0;
-    unsigned int end_index = 0;
-    for (unsigned int i = 1; i < fmisid_ts.size(); i++)
+    std::size_t start_index = 0;
+    for (std::size_t i = 1; i < fmisid_ts.size(); i++)
     {
-      if (fmisid_ts[i].value == fmisid_ts[i - 1].value)
+      if (same_fmisid(fmisid_ts[i].value, fmisid_ts[i - 1].value))
         continue;
 
-      end_index = i;
-      location_indexes.emplace_back(start_index, end_index);
+      location_indexes.emplace_back(start_index, i);
       start_index = i;
     }
-    end_index = fmisid_ts.size();
-    location_indexes.emplace_back(start_index, end_index);
+    location_indexes.emplace_back(start_index, fmisid_ts.size());
+
+    // Preallocate the outputs so that locations can be processed independently
 
-    // Iterate through locations
+    ret.reserve(location_indexes.size());
     for (const auto& location_index : location_indexes)
     {
-      TimeSeriesVectorPtr tsv(new TimeSeriesVector());
-      start_index = location_index.first;
-      end_index = location_index.second;
-      for (const TimeSeries& ts_k : *observation_result)
+      int fmisid = get_fmisid_value(fmisid_ts[location_index.first].value);
+      ret.emplace_back(fmisid, std::make_shared<TimeSeriesVector>(observation_result->size()));
+    }
+
+    auto split_location = [&](std::size_t i)
+    {
+      const auto& location_index = location_indexes[i];
+      auto& tsv = *ret[i].second;
+      for (std::size_t k = 0; k < observation_result->size(); k++)
       {
-        if (ts_k.empty())
-          tsv->push_back(ts_k);
-        else
-        {
-          TimeSeries ts_ik;
-          ts_ik.insert(ts_ik.begin(), ts_k.begin() + start_index, ts_k.begin() + end_index);
-          // Add missing timesteps
-          add_missing_timesteps(ts_ik, tlist);
-          tsv->emplace_back(ts_ik);
-        }
+        const TimeSeries& ts_k = (*observation_result)[k];
+        if (!ts_k.empty())
+          copy_with_missing_timesteps(tsv[k],
+                                      ts_k.begin() + location_index.first,
+                                      ts_k.begin() + location_index.second,
+                                      tlist);
       }
+    };
 
-      if (fmisid_ts.empty())
-        continue;
-      int fmisid = get_fmisid_value(fmisid_ts[start_index].value);
-      ret.emplace_back(make_pair(fmisid, tsv));
-    }
+    run_tasks(location_indexes.size(), split_location, executor);
 
     return ret;
   }
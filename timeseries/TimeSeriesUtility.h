@@ -4,20 +4,45 @@
 #include "TimeSeriesAggregator.h"
 #include "TimeSeriesGeneratorCache.h"
 #include <macgyver/Exception.h>
+#include <cstddef>
+#include <functional>
 
 namespace SmartMet
 {
 namespace TimeSeries
 {
 /*** typedefs ***/
-using TimeSeriesData = std::variant<TimeSeriesPtr, TimeSeriesVectorPtr, TimeSeriesGroupPtr>;
+// Snapshots are shared results, for example from a cache, which are output without copying them
+using TimeSeriesData = std::variant<TimeSeriesPtr,
+                                    TimeSeriesVectorPtr,
+                                    TimeSeriesGroupPtr,
+                                    RunLengthTimeSeriesPtr,
+                                    TimeSeriesSnapshot,
+                                    TimeSeriesVectorSnapshot,
+                                    TimeSeriesGroupSnapshot>;
 
 using OutputData = std::vector<std::pair<std::string, std::vector<TimeSeriesData> > >;
+
+// Output data allocated from a memory resource such as a RequestArena. RowFeeder and the
+// serializers accept it like OutputData.
+namespace pmr
+{
+using TimeSeriesData =
+    std::variant<TimeSeriesPtr, TimeSeriesVectorPtr, TimeSeriesGroupPtr, RunLengthTimeSeriesPtr>;
+using OutputData = std::vector<std::pair<std::string, std::vector<TimeSeriesData> > >;
+}  // namespace pmr
+
 using PressureLevelParameterPair = std::pair<int, std::string>;
 using ParameterTimeSeriesMap = std::map<PressureLevelParameterPair, TimeSeriesPtr>;
 using ParameterTimeSeriesGroupMap = std::map<PressureLevelParameterPair, TimeSeriesGroupPtr>;
 using FmisidTSVectorPair = std::pair<int, TimeSeriesVectorPtr>;
 using TimeSeriesByLocation = std::vector<FmisidTSVectorPair>;
+
+// Runs the tasks 0...n-1, possibly concurrently, for example in the thread pool of
+// the server. The library does not start threads of its own, hence the functions
+// below process everything in the calling thread unless an executor is given.
+using TaskExecutor =
+    std::function<void(std::size_t n, const std::function<void(std::size_t)>& task)>;
 /*** functions ***/
 TimeSeriesPtr erase_redundant_timesteps(TimeSeriesPtr ts,
                                         const TimeSeriesGenerator::LocalTimeList& timesteps);
@@ -25,11 +50,33 @@ TimeSeriesVectorPtr erase_redundant_timesteps(TimeSeriesVectorPtr tsv,
                                               const TimeSeriesGenerator::LocalTimeList& timesteps);
 TimeSeriesGroupPtr erase_redundant_timesteps(TimeSeriesGroupPtr tsg,
                                              const TimeSeriesGenerator::LocalTimeList& timesteps);
+RunLengthTimeSeriesPtr erase_redundant_timesteps(
+    RunLengthTimeSeriesPtr rts, const TimeSeriesGenerator::LocalTimeList& timesteps);
+// The members are processed by the tasks of the executor
+TimeSeriesVectorPtr erase_redundant_timesteps(TimeSeriesVectorPtr tsv,
+                                              const TimeSeriesGenerator::LocalTimeList& timesteps,
+                                              const TaskExecutor& executor);
+TimeSeriesGroupPtr erase_redundant_timesteps(TimeSeriesGroupPtr tsg,
+                                             const TimeSeriesGenerator::LocalTimeList& timesteps,
+                                             const TaskExecutor& executor);
+// Snapshots are not modified, the input is returned as is if nothing needs to be erased
+TimeSeriesSnapshot erase_redundant_timesteps(const TimeSeriesSnapshot& ts,
+                                             const TimeSeriesGenerator::LocalTimeList& timesteps);
+TimeSeriesVectorSnapshot erase_redundant_timesteps(
+    const TimeSeriesVectorSnapshot& tsv, const TimeSeriesGenerator::LocalTimeList& timesteps);
+TimeSeriesGroupSnapshot erase_redundant_timesteps(
+    const TimeSeriesGroupSnapshot& tsg, const TimeSeriesGenerator::LocalTimeList& timesteps);
 size_t number_of_elements(const OutputData& outputData);
 TimeSeriesByLocation get_timeseries_by_fmisid(const std::string& producer,
                                               const TimeSeriesVectorPtr& observation_result,
                                               const TimeSeriesGeneratorCache::TimeList& tlist,
                                               int fmisid_index);
+// The stations are split by the tasks of the executor
+TimeSeriesByLocation get_timeseries_by_fmisid(const std::string& producer,
+                                              const TimeSeriesVectorPtr& observation_result,
+                                              const TimeSeriesGeneratorCache::TimeList& tlist,
+                                              int fmisid_index,
+                                              const TaskExecutor& executor);
 int get_fmisid_value(const TimeSeries& ts);
 
 std::ostream& operator<<(std::ostream& os, const TimeSeriesData& tsdata);
@@ -102,7 +102,7 @@ bool Value::operator==(const Value& other) const
   return this->apply_visitor(visitor);
 }
 
-int Value::as_int() const
+int Value::convert_to_int() const
 try
 {
   return apply_visitor(GetIntVisitor());
@@ -114,15 +114,13 @@ catch (...)
   throw error;
 }
 
-double Value::as_double() const
+double Value::convert_to_double() const
 try
 {
   return apply_visitor(GetDoubleVisitor());
 }
 catch (...)
 {
-  Fmi::ValueFormatterParam vfp;
-  Fmi::ValueFormatter vf(vfp);
   auto error = Fmi::Exception::Trace(BCP, "Operation failed");
   error.addParameter("Value", as_string(*this));
   throw error;